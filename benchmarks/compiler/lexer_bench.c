@@ -0,0 +1,81 @@
+// Lexer throughput benchmark: tokenizes a large generated .vx source.
+// Build and run from the repository root with: make bench-lexer
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../include/lexer.h"
+#include "../../include/arena.h"
+
+#define FUNCTION_COUNT 200000
+#define PASSES 5
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// A representative module: indentation, comments, keywords, identifiers,
+// numbers, string literals and operators.
+static char *generate_source(size_t *out_size) {
+    size_t capacity = 1 << 20, size = 0;
+    char *source = malloc(capacity);
+    for (int i = 0; i < FUNCTION_COUNT; i++) {
+        char chunk[1024];
+        int n = snprintf(chunk, sizeof(chunk),
+            "// Accumulates the running total for bucket %d\n"
+            "func compute_bucket_%d(i32 count, f64 scale) -> i64 {\n"
+            "    var i64 accumulated_total = 0;\n"
+            "    /* walk every element\n"
+            "       and fold it in */\n"
+            "    for (var i32 index = 0; index < count; index = index + 1) {\n"
+            "        if (index %% 3 == 0 && scale >= 1.5) {\n"
+            "            accumulated_total = accumulated_total + index * %d;\n"
+            "        } else {\n"
+            "            io.print(\"bucket %d skipped element\\n\");\n"
+            "        }\n"
+            "    }\n"
+            "    return accumulated_total;\n"
+            "}\n\n", i, i, i % 97, i);
+        if (size + n + 1 > capacity) {
+            capacity *= 2;
+            source = realloc(source, capacity);
+        }
+        memcpy(source + size, chunk, n);
+        size += n;
+    }
+    source[size] = '\0';
+    *out_size = size;
+    return source;
+}
+
+int main(void) {
+    size_t size;
+    char *source = generate_source(&size);
+
+    double best = 0;
+    size_t tokens = 0;
+    for (int pass = 0; pass < PASSES; pass++) {
+        Arena *arena = arena_create();
+        arena_set_current(arena);
+
+        double start = now_seconds();
+        Lexer *lexer = lexer_init(source, "<bench>");
+        Token *token_array = lexer_tokenize(lexer, &tokens);
+        lexer_free(lexer);
+        double elapsed = now_seconds() - start;
+
+        free(token_array);
+        arena_free(arena);
+        if (best == 0 || elapsed < best) best = elapsed;
+    }
+
+    printf("Lexer: %.1f MB, %zu tokens\n", size / 1e6, tokens);
+    printf("  best of %d: %.3f ms (%.1f MB/s, %.1f Mtokens/s)\n",
+           PASSES, best * 1e3, size / 1e6 / best, tokens / 1e6 / best);
+
+    free(source);
+    return 0;
+}
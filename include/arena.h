@@ -0,0 +1,35 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator for front-end nodes (AST, Type, Token).
+// Everything allocated from an arena is released at once by arena_free.
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock *blocks;     // Most recent block first
+    size_t bytes_used;      // Bytes handed out to callers
+    size_t bytes_reserved;  // Bytes obtained from malloc
+    size_t block_count;
+} Arena;
+
+Arena *arena_create(void);
+void arena_free(Arena *arena);
+void *arena_alloc(Arena *arena, size_t size);
+char *arena_strdup(Arena *arena, const char *str);
+
+// Current arena: ast.c, type.c and token.c allocate from it when set and
+// fall back to malloc otherwise. While an arena is current, per-node
+// frees are no-ops and the owning arena reclaims the memory. The current
+// arena is per thread.
+void arena_set_current(Arena *arena);
+Arena *arena_current(void);
+
+void *arena_node_alloc(size_t size);
+void *arena_node_calloc(size_t size);
+char *arena_node_strdup(const char *str);
+void *arena_node_adopt(void *ptr, size_t size);  // Move a malloc'd buffer into the current arena
+void arena_node_free(void *ptr);
+
+#endif // ARENA_H
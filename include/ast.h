@@ -238,7 +238,7 @@ typedef struct {
 
 // Function declaration
 typedef struct {
-    char *name;
+    const char *name;        // Interned
     char **type_params;      // Generic type parameters (e.g., "T", "U")
     size_t type_param_count;
     ASTParam *params;
@@ -259,7 +259,7 @@ typedef struct {
 
 // Struct declaration
 typedef struct {
-    char *name;
+    const char *name;        // Interned
     char **type_params;
     size_t type_param_count;
     ASTField *fields;
@@ -275,7 +275,7 @@ typedef struct {
 
 // Enum declaration
 typedef struct {
-    char *name;
+    const char *name;        // Interned
     char **type_params;
     size_t type_param_count;
     ASTEnumVariant *variants;
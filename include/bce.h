@@ -0,0 +1,23 @@
+#ifndef BCE_H
+#define BCE_H
+
+#include <stdbool.h>
+#include "ir.h"
+
+// Bounds-check elimination.
+//
+// irgen guards every slice index with virex_slice_bounds_check(index, len)
+// and every subslice with virex_slice_range_check(start, end, cap). This
+// pass removes the calls whose condition provably holds. Facts come from
+// the branch conditions that dominate a check, such as a loop guard
+// "i < s.len" or "a.len != b.len" having been false, and stay valid while
+// nothing on the way to the check writes the compared values. A local
+// counter is non-negative when it is only ever set to non-negative
+// constants or stepped up by a positive constant, and one such set
+// dominates the check.
+//
+// Runs on IR out of SSA form. With report set, prints the checks each
+// function keeps to stdout.
+void bce_run(IRFunction *func, bool report);
+
+#endif // BCE_H
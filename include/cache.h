@@ -0,0 +1,32 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// On-disk build cache. Artifacts live in BUILD_CACHE_DIR and are named by
+// a 64-bit key, so an artifact is reused exactly when everything that went
+// into its key (sources, imports, compiler, flags) is unchanged.
+#define BUILD_CACHE_DIR ".virex-cache"
+
+// FNV-1a over a byte range, chained through seed
+uint64_t cache_hash_bytes(const void *data, size_t length, uint64_t seed);
+uint64_t cache_hash_string(const char *str, uint64_t seed);
+uint64_t cache_hash_u64(uint64_t value, uint64_t seed);
+bool cache_hash_file(const char *path, uint64_t *hash);  // Chains the contents into *hash
+
+// Hash of the running compiler binary, so rebuilding virexc invalidates
+// everything it generated
+uint64_t cache_compiler_hash(void);
+
+bool cache_prepare(void);  // Creates BUILD_CACHE_DIR if needed
+void cache_artifact_path(char *buffer, size_t size, uint64_t key, const char *extension);
+bool cache_has(uint64_t key, const char *extension);
+
+// A manifest (<key>.link) lists the cached objects that make up one program.
+// Reading returns NULL unless it exists and every object is still present.
+char **cache_read_manifest(uint64_t key, size_t *count);
+bool cache_write_manifest(uint64_t key, char **objects, size_t count);
+
+#endif // CACHE_H
@@ -0,0 +1,72 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ir.h"
+
+// Control flow graph over an IRFunction's instruction array.
+//
+// The instruction array stays the canonical, emitted order; the CFG
+// partitions it into basic blocks and resolves every label to a block
+// index once, so passes can walk edges, dominators and loops without
+// searching for labels by name. Any pass that reorders, inserts or
+// deletes instructions invalidates the CFG and must rebuild it.
+
+#define CFG_NONE ((size_t)-1)
+
+typedef struct {
+    size_t start;           // Index of the first instruction
+    size_t end;             // One past the last instruction
+    size_t *succs;          // Branch or switch targets first, then fall-through
+    size_t succ_count;
+    size_t *preds;
+    size_t pred_count;
+    size_t idom;            // Immediate dominator (entry: itself, unreachable: CFG_NONE)
+    size_t rpo_index;       // Position in cfg->rpo (CFG_NONE if unreachable)
+    size_t dom_pre;         // Dominator tree DFS entry/exit numbers, so
+    size_t dom_post;        // dominance checks are O(1)
+    size_t loop;            // Innermost enclosing loop (CFG_NONE outside loops)
+} BasicBlock;
+
+// Natural loop: a header plus every block that reaches one of its
+// back edges without passing through the header
+typedef struct {
+    size_t header;
+    size_t *blocks;         // Member blocks, ascending, header included
+    size_t block_count;
+    size_t *latches;        // Sources of the back edges to the header
+    size_t latch_count;
+    size_t parent;          // Enclosing loop (CFG_NONE at top level)
+    size_t depth;           // 1 for outermost loops
+} CFGLoop;
+
+typedef struct LabelSlot LabelSlot;
+
+typedef struct {
+    IRFunction *func;
+    BasicBlock *blocks;     // In instruction order; block 0 is the entry
+    size_t block_count;
+    size_t *block_of;       // Instruction index -> block index
+    size_t *rpo;            // Reachable blocks in reverse post-order
+    size_t rpo_count;
+    CFGLoop *loops;         // Outer loops before the loops they contain
+    size_t loop_count;
+    LabelSlot *labels;      // Label name -> block index
+    size_t label_capacity;
+} CFG;
+
+CFG *cfg_build(IRFunction *func);
+void cfg_free(CFG *cfg);
+
+// Block whose leading IR_LABEL is name, or CFG_NONE
+size_t cfg_label_block(const CFG *cfg, const char *name);
+
+bool cfg_reachable(const CFG *cfg, size_t block);
+bool cfg_dominates(const CFG *cfg, size_t a, size_t b);
+bool cfg_loop_contains(const CFG *cfg, size_t loop, size_t block);
+
+// Loop headed by block, or CFG_NONE
+size_t cfg_loop_of_header(const CFG *cfg, size_t block);
+
+#endif // CFG_H
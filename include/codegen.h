@@ -13,7 +13,18 @@ typedef struct CodeGenerator CodeGenerator;
 CodeGenerator *codegen_create(void);
 void codegen_free(CodeGenerator *gen);
 
-// Generate C code from IR
-void codegen_generate_c(CodeGenerator *gen, Project *project, FILE *output);
+// Where the C backend writes its units, and the shared header among them
+#define CODEGEN_UNIT_DIR "virex_out.d"
+#define CODEGEN_HEADER_NAME "virex_out.h"
+
+// Generate C code from IR as separate translation units in dir: a shared
+// header with every type, global and prototype, one unit per module and a
+// support unit with the generated runtime helpers. Returns the malloc'd .c
+// paths (module units in module order, support unit last), or NULL if a
+// file could not be written.
+char **codegen_generate_units(CodeGenerator *gen, Project *project, const char *dir, size_t *unit_count);
+
+// Number of modules lowered to IR so far (one per module per generate call)
+size_t codegen_lowered_modules(CodeGenerator *gen);
 
 #endif // CODEGEN_H
@@ -3,15 +3,20 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "ast.h"
 #include "symtable.h"
+#include "arena.h"
 
 // Represents a single Virex source file/module
 typedef struct {
-    char *path;
-    char *name;             // Module name (from filename or module decl)
+    const char *path;       // Resolved path (interned)
+    const char *name;       // Module name from filename or module decl (interned)
     ASTProgram *ast;
     SymbolTable *symtable;  // This module's symbol table
+    Arena *arena;           // Owns the module's AST, types and tokens
+    uint64_t source_hash;   // Hash of the file contents
+    uint64_t hash;          // source_hash chained with the hashes of its imports
     bool is_analyzed;
     bool is_loading;        // Used for circular dependency detection
 } Module;
@@ -22,6 +27,12 @@ typedef struct {
     size_t module_count;
     Module *main_module;
     bool strict_unsafe_mode;
+    size_t jobs;            // Front-end worker threads; 1 keeps everything on the calling thread
+    size_t inline_threshold; // Largest callee the IR inliner copies into callers; 0 disables it
+    bool report_bce;        // Print the slice bounds checks left after optimization
+    int opt_level;          // -O level picking the IR pass pipeline
+    const char *passes;     // --passes list replacing that pipeline, or NULL
+    const char *print_after; // Pass to print the IR after, or NULL
 } Project;
 
 Project *project_create(void);
@@ -30,6 +41,7 @@ void project_free(Project *project);
 // High-level compilation steps
 Module *project_load_module(Project *project, const char *path, const char *relative_to);
 bool project_analyze(Project *project);
+size_t project_arena_bytes(Project *project);
 void project_generate_code(Project *project, const char *output_file);
 
 #endif // COMPILER_H
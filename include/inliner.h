@@ -0,0 +1,25 @@
+#ifndef INLINER_H
+#define INLINER_H
+
+#include <stddef.h>
+#include "ir.h"
+
+// IR inliner across all modules of a program.
+//
+// Builds the call graph over every lowered function and visits it
+// bottom-up (callees before callers, one strongly connected component at
+// a time), so a callee's own calls are already inlined when its body is
+// copied. Recursive functions are never inlined. A call site is inlined
+// when the callee's cost, its instruction count minus a bonus for every
+// constant argument, is at most threshold; 0 turns inlining off.
+//
+// Inlined bodies get renamed temps, locals and labels in the caller, the
+// parameters become caller locals assigned from the arguments, and each
+// return becomes a copy into the call's destination and a jump past the
+// body. Runs before the scalar passes, which clean up the copies.
+
+#define INLINER_DEFAULT_THRESHOLD 40
+
+void inliner_run(IRModule **modules, size_t module_count, size_t threshold);
+
+#endif // INLINER_H
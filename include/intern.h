@@ -0,0 +1,20 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+
+// Process-wide string interner. Each distinct string is stored once and
+// the returned pointer is stable for the life of the process, so two
+// interned strings are equal exactly when their pointers are equal.
+// All functions are safe to call from several threads at once.
+const char *intern(const char *str);
+const char *intern_n(const char *str, size_t len);
+
+// Returns the canonical pointer for str, or NULL if it was never interned.
+// Lookups use this so that queries never grow the table.
+const char *intern_find(const char *str);
+
+size_t intern_count(void);
+size_t intern_bytes(void);
+
+#endif // INTERN_H
@@ -35,6 +35,7 @@ typedef enum {
     IR_LABEL,       // Label for jumps
     IR_JUMP,        // Unconditional jump
     IR_BRANCH,      // Conditional branch (if src1 then src2 else dest)
+    IR_SWITCH,      // Multiway branch on src1: args hold (case constant, label) pairs, src2 is the default label
     IR_FAIL,
     
     // Function calls
@@ -47,9 +48,37 @@ typedef enum {
     IR_ADDR,        // Address of (&)
     IR_DEREF,       // Dereference (*)
     IR_CAST,        // Explicit cast
+    IR_PHI,         // SSA merge: args hold (predecessor label, value) pairs
     IR_NOP          // No Operation
 } IROpcode;
 
+// C type of an IR value. Types are interned, one record per distinct C
+// spelling for the life of the process, so handles compare by pointer
+// and the classification below is worked out once.
+typedef enum {
+    IR_TYPE_INT,        // Signed integers, including bool ("int") and enums
+    IR_TYPE_UINT,
+    IR_TYPE_FLOAT,
+    IR_TYPE_POINTER,
+    IR_TYPE_SLICE,      // "struct Slice_<elem>"
+    IR_TYPE_STRUCT,     // Other structs, results among them
+    IR_TYPE_ARRAY,      // "T[N]"
+    IR_TYPE_VOID,
+    IR_TYPE_OTHER
+} IRTypeKind;
+
+typedef struct {
+    const char *c_name;     // C spelling, "const int32_t"
+    IRTypeKind kind;
+    unsigned size;          // Bytes of a scalar, 0 for anything else
+    bool is_const;          // const-qualified itself (not "const char*")
+} IRType;
+
+// Interned type for a C spelling; NULL for NULL
+const IRType *ir_type(const char *c_name);
+// The type of values irgen knows nothing about: "long"
+const IRType *ir_type_long(void);
+
 // IR Operand types
 typedef enum {
     IR_OP_TEMP,      // Temporary variable (t0, t1, ...)
@@ -67,9 +96,9 @@ typedef struct {
         int temp_id;
         long const_value;
         double float_value;
-        char *var_name;
-        char *label_name;
-        char *string_value;
+        const char *var_name;       // Names and strings are interned
+        const char *label_name;
+        const char *string_value;
     } data;
 } IROperand;
 
@@ -87,16 +116,16 @@ typedef struct {
 typedef struct {
     char *name;
     char **params;      // Parameter names
-    char **param_types; // Parameter types (C string representation)
+    const IRType **param_types; // Parameter types
     size_t param_count;
-    char *return_type;  // Return type (C string representation)
+    const IRType *return_type;
     char **local_vars;  // Local variable names
-    char **local_var_types; // Local variable types (C string representation)
+    const IRType **local_var_types;
     size_t local_var_count;
     IRInstruction **instructions;
     size_t instruction_count;
     size_t instruction_capacity;
-    char **temp_types;  // Type of each temporary
+    const IRType **temp_types;  // Type of each temporary, NULL when unknown
     size_t temp_count;  // Number of temporaries used
     size_t label_count; // Number of labels used
 } IRFunction;
@@ -108,6 +137,14 @@ typedef struct {
     long init_value; // For now only simple integer initialization supported
 } IRGlobal;
 
+// By-value struct a result<T, E> lowers to; the C backend defines one
+// per distinct c_type
+typedef struct {
+    char *c_type;       // "struct Result_int32_t__int32_t"
+    char *ok_type;      // Payload C types, "void" when the side has none
+    char *err_type;
+} IRResultType;
+
 // IR Module
 typedef struct {
     IRFunction **functions;
@@ -116,6 +153,8 @@ typedef struct {
     IRGlobal **globals;
     size_t global_count;
     size_t global_capacity;
+    IRResultType *result_types; // Payload types before the results holding them
+    size_t result_type_count;
 } IRModule;
 
 // IR Operand creation
@@ -131,17 +170,45 @@ IROperand *ir_operand_clone(IROperand *op);
 // IR Instruction creation
 IRInstruction *ir_instruction_create(IROpcode opcode, IROperand *dest, IROperand *src1, IROperand *src2);
 IRInstruction *ir_instruction_create_call(IROperand *dest, IROperand *func, IROperand **args, size_t arg_count);
+// args alternate case constants and their labels, arg_count counts both
+IRInstruction *ir_instruction_create_switch(IROperand *value, IROperand *default_label, IROperand **args, size_t arg_count);
 void ir_instruction_free(IRInstruction *instr);
 
+// Operand slots an instruction reads, by index until NULL: the sources,
+// call arguments and phi incoming values. The assigned lvalue of IR_STORE
+// and the operand of IR_ADDR are not reads.
+IROperand **ir_instruction_use(IRInstruction *instr, size_t index);
+
+// Label operands of a transfer of control: the target of IR_JUMP and
+// IR_BRANCH, the default then every case label of IR_SWITCH
+IROperand **ir_instruction_target(IRInstruction *instr, size_t index);
+
+// Calls visit for each variable an IR_OP_VAR expression such as
+// "(*p_v1).data[t5]" names, skipping member names
+typedef void (*IRIdentVisitor)(const char *ident, size_t len, void *ctx);
+void ir_scan_identifiers(const char *expr, IRIdentVisitor visit, void *ctx);
+
+// Temp id an identifier of the form "t<digits>" names, or -1
+int ir_temp_identifier(const char *ident, size_t len);
+
+// Copy of a VAR expression with some of its variables renamed: rename
+// writes the new name into out (at most out_size bytes) and returns true,
+// or returns false to keep the identifier
+typedef bool (*IRIdentRenamer)(const char *ident, size_t len, char *out, size_t out_size, void *ctx);
+char *ir_rename_identifiers(const char *expr, IRIdentRenamer rename, void *ctx);
+
 // IR Function creation
 IRFunction *ir_function_create(const char *name);
 void ir_function_add_instruction(IRFunction *func, IRInstruction *instr);
 void ir_function_free(IRFunction *func);
+int ir_function_new_temp(IRFunction *func, const IRType *type);
+char *ir_function_new_label(IRFunction *func, const char *prefix);
 
 // IR Module creation
 IRModule *ir_module_create(void);
 void ir_module_add_function(IRModule *module, IRFunction *func);
 void ir_module_add_global(IRModule *module, const char *name, const char *c_type, long init_value);
+void ir_module_add_result_type(IRModule *module, const char *c_type, const char *ok_type, const char *err_type);
 void ir_module_free(IRModule *module);
 
 // IR Printing
@@ -1,6 +1,7 @@
 #ifndef IROPT_H
 #define IROPT_H
 
+#include <stdbool.h>
 #include "ir.h"
 
 // IR Optimizer
@@ -10,16 +11,16 @@ typedef struct IROptimizer IROptimizer;
 IROptimizer *iropt_create(void);
 void iropt_free(IROptimizer *opt);
 
+// Passes over SSA form (see ssa.h), one function at a time
+void iropt_sccp(IRFunction *func);
+void iropt_copy_propagation(IRFunction *func);
+void iropt_global_value_numbering(IRFunction *func);
+void iropt_dead_value_elimination(IRFunction *func);
+void iropt_induction_variables(IRFunction *func);
+
 // Optimization passes
-void iropt_constant_folding(IRModule *module);
 void iropt_dead_code_elimination(IRModule *module);
-void iropt_copy_propagation(IRModule *module);
 void iropt_loop_invariant_code_motion(IRModule *module);
-
-// Run all optimizations
-void iropt_optimize(IRModule *module);
+void iropt_strength_reduction(IRModule *module);
 
 #endif // IROPT_H
-void iropt_common_subexpression_elimination(IRModule *module);
-void iropt_strength_reduction(IRModule *module);
-void iropt_dead_store_elimination_loops(IRModule *module);
@@ -8,16 +8,19 @@
 // Lexer state
 typedef struct {
     const char *source;     // Source code
+    size_t length;          // Length of source in bytes
     const char *filename;   // Filename for error reporting
     size_t pos;            // Current position in source
     size_t line;           // Current line (1-indexed)
     size_t column;         // Current column (1-indexed)
     char current;          // Current character
+    Token scratch;         // Token being built by the scanner
 } Lexer;
 
 // Lexer functions
 Lexer *lexer_init(const char *source, const char *filename);
 void lexer_free(Lexer *lexer);
 Token *lexer_next_token(Lexer *lexer);
+Token *lexer_tokenize(Lexer *lexer, size_t *count);  // Whole input, ending with TOKEN_EOF
 
 #endif // LEXER_H
@@ -26,6 +26,7 @@
 #define LOOP_TRANSFORM_H
 
 #include "../include/ir.h"
+#include "../include/cfg.h"
 #include <stdbool.h>
 
 typedef struct {
@@ -42,8 +43,9 @@ typedef struct {
     IROpcode comparison_op;     // Comparison operator (<, <=, >, >=)
 } LoopInfo;
 
-// Detect if a sequence of instructions forms a simple counting loop
-LoopInfo detect_simple_loop(IRFunction *func, size_t start_idx);
+// Detect if the loop headed by the label at start_idx is a simple
+// counting loop; cfg must be built over func
+LoopInfo detect_simple_loop(IRFunction *func, const CFG *cfg, size_t start_idx);
 
 // Check if instruction sequence matches loop pattern
 bool is_loop_pattern(IRFunction *func, size_t idx);
@@ -8,10 +8,17 @@
 // Parser state
 typedef struct {
     Lexer *lexer;
+    Token *tokens;          // Whole module, lexed up front; ends with TOKEN_EOF
+    size_t token_count;
+    size_t next;            // Index of the token after current
     Token *current;
     Token *previous;
     bool had_error;
     bool panic_mode;
+    const char **type_names;    // Interned struct, enum, alias and generic parameter names
+    size_t type_name_count;
+    const char **module_names;  // Interned import aliases
+    size_t module_name_count;
 } Parser;
 
 // Parser functions
@@ -0,0 +1,40 @@
+#ifndef PASSES_H
+#define PASSES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "ir.h"
+
+// IR pass manager.
+//
+// A pipeline is a comma-separated list of pass names, "inline,sccp,dce".
+// Passes in brackets, "[sccp,gvn,dve]", repeat as a group until a round
+// leaves the IR unchanged, at most PASS_MAX_ROUNDS times. Each pass runs
+// over every module of the program before the next one starts. Passes
+// that work on SSA form get it built first and the others get it taken
+// down first, so any order is valid; the pipeline ends out of SSA form.
+
+#define PASS_DEFAULT_LEVEL 2
+#define PASS_MAX_LEVEL 3
+#define PASS_MAX_ROUNDS 4
+
+typedef struct {
+    size_t inline_threshold;
+    bool report_bce;            // bce prints the checks it keeps
+    const char *print_after;    // Print the IR after every run of this pass, or NULL
+} PassOptions;
+
+typedef struct PassPipeline PassPipeline;
+
+// Pipeline spec for -O<level>, 0 to PASS_MAX_LEVEL
+const char *pass_pipeline_for_level(int level);
+
+// Reports what is wrong with spec and returns NULL when it does not parse
+PassPipeline *pass_pipeline_parse(const char *spec);
+void pass_pipeline_free(PassPipeline *pipeline);
+
+void pass_pipeline_run(const PassPipeline *pipeline, IRModule **modules, size_t module_count, const PassOptions *options);
+
+bool pass_exists(const char *name);
+
+#endif // PASSES_H
@@ -7,10 +7,10 @@
 
 // Generic type instantiation tracking
 typedef struct {
-    char *base_name;           // e.g., "Pair"
+    const char *base_name;     // e.g., "Pair" (interned)
     Type **type_args;          // e.g., [i32, i64]
     size_t type_arg_count;
-    char *mangled_name;        // e.g., "Pair_i32_i64"
+    const char *mangled_name;  // e.g., "Pair_i32_i64" (interned)
     Symbol *original_symbol;   // Points to generic struct/enum symbol
     Symbol *monomorphized_symbol; // The specialized symbol
 } GenericInstantiation;
@@ -0,0 +1,47 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ir.h"
+#include "cfg.h"
+
+// SSA form for IR functions.
+//
+// ssa_construct promotes scalar locals, parameters and reassigned temps
+// to SSA temps (mem2reg): afterwards every temp that is not pinned has
+// exactly one definition, that definition dominates all its uses, and
+// values merge through IR_PHI instructions at the top of blocks. A local
+// or parameter is promoted when it has a scalar C type and only ever
+// appears as a whole IR_OP_VAR operand; a parameter is copied into a
+// temp once on entry. Locals named inside a larger VAR expression ("s.data[t3]",
+// "(*p_v1)") or whose address is taken stay in memory, and temps named
+// inside such expressions are pinned and left alone.
+//
+// ssa_destruct turns every phi into copies on its incoming edges,
+// splitting critical edges, so the function can be emitted as C again.
+void ssa_construct(IRFunction *func);
+void ssa_destruct(IRFunction *func);
+
+// Per-temp facts for passes that work on SSA form
+typedef struct {
+    size_t temp_limit;      // Temps with ids below this are described
+    size_t *def;            // Defining instruction of SSA temps, CFG_NONE otherwise
+    bool *pinned;           // Named inside an IR_OP_VAR expression
+} SSAInfo;
+
+SSAInfo *ssa_info_build(IRFunction *func, const CFG *cfg);
+void ssa_info_free(SSAInfo *info);
+
+// A constant, or a temp with a single definition that dominates its uses
+bool ssa_is_value(const SSAInfo *info, const IROperand *op);
+
+// Type of a temp ("long" when irgen recorded none)
+const IRType *ssa_temp_type(const IRFunction *func, int temp);
+
+// Whether a constant may replace a value of the given type: signed
+// integer types only, since unsigned operands change how C compares and
+// divides, and only when the constant is in range
+bool ssa_const_fits(const IRType *type, long value);
+
+#endif // SSA_H
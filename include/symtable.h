@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <pthread.h>
 #include "type.h"
 
 // Symbol kinds
@@ -24,7 +25,7 @@ typedef struct {
 
 // Symbol structure
 typedef struct Symbol {
-    char *name;
+    const char *name;           // Interned; compare by pointer
     SymbolKind kind;
     Type *type;
     bool is_const;
@@ -60,18 +61,26 @@ typedef struct Symbol {
 } Symbol;
 
 // Scope structure
+// symbols keeps insertion order (diagnostics and codegen iterate it);
+// index is an open-addressing table over the same symbols keyed by the
+// interned name pointer, built once the scope outgrows a linear scan.
 typedef struct Scope {
     struct Scope *parent;
     Symbol **symbols;
     size_t symbol_count;
     size_t symbol_capacity;
+    Symbol **index;
+    size_t index_capacity;      // Power of two, 0 while unindexed
 } Scope;
 
 // Symbol table
+// Other modules only see the global scope (symtable_lookup_global), so
+// global_lock guards it while modules are analyzed concurrently.
 typedef struct SymbolTable {
     char *name;                 // Name of the table (e.g., module name)
     Scope *current_scope;
     Scope *global_scope;
+    pthread_rwlock_t global_lock;
 } SymbolTable;
 
 // Symbol table functions
@@ -84,6 +93,7 @@ void symtable_exit_scope(SymbolTable *table);
 bool symtable_insert(SymbolTable *table, Symbol *symbol);
 Symbol *symtable_lookup(SymbolTable *table, const char *name);
 Symbol *symtable_lookup_current(SymbolTable *table, const char *name);
+Symbol *symtable_lookup_global(SymbolTable *table, const char *name);  // For cross-module lookups
 
 // Symbol functions
 Symbol *symbol_create(const char *name, SymbolKind kind, Type *type, size_t line, size_t column);
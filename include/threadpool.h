@@ -0,0 +1,20 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stddef.h>
+
+// Work-stealing thread pool. Each worker owns a deque: tasks submitted
+// from a worker go to the bottom of its own deque and are popped LIFO,
+// idle workers steal from the top of the others. Tasks may submit more
+// tasks; threadpool_wait returns once every task has finished.
+typedef struct ThreadPool ThreadPool;
+typedef void (*ThreadPoolTask)(void *arg);
+
+ThreadPool *threadpool_create(size_t thread_count);
+void threadpool_submit(ThreadPool *pool, ThreadPoolTask task, void *arg);
+void threadpool_wait(ThreadPool *pool);
+void threadpool_free(ThreadPool *pool);
+
+size_t threadpool_cpu_count(void);
+
+#endif // THREADPOOL_H
@@ -100,9 +100,15 @@ typedef enum {
 } TokenType;
 
 // Token structure
+// Lexed tokens are (offset, length) views into the source buffer; the
+// lexeme is only materialized when token_lexeme is called. Synthesized
+// tokens (token_create) and escaped string literals own their lexeme.
 typedef struct {
     TokenType type;
-    char *lexeme;       // The actual text
+    const char *source; // Source buffer the view points into (NULL if owned)
+    size_t offset;      // Byte offset of the view in source
+    size_t length;      // Byte length of the view
+    const char *lexeme; // The actual text, NULL until materialized
     size_t line;        // Line number (1-indexed)
     size_t column;      // Column number (1-indexed)
     
@@ -116,7 +122,11 @@ typedef struct {
 } Token;
 
 // Token functions
+void token_init(Token *token, TokenType type, const char *lexeme, size_t line, size_t column);
+void token_init_view(Token *token, TokenType type, const char *source, size_t offset, size_t length, size_t line, size_t column);
 Token *token_create(TokenType type, const char *lexeme, size_t line, size_t column);
+Token *token_create_view(TokenType type, const char *source, size_t offset, size_t length, size_t line, size_t column);
+const char *token_lexeme(Token *token);
 void token_free(Token *token);
 const char *token_type_name(TokenType type);
 void token_print(const Token *token);
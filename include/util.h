@@ -1,10 +1,34 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include "type.h"
 
+// Read-only view of a source file. The contents are followed by at least
+// one NUL byte, so the lexer can treat them as a C string.
+typedef struct {
+    const char *data;
+    size_t size;
+    size_t mapped_size;     // Length of the mapping, including the zero tail
+} SourceBuffer;
+
+bool source_buffer_open(SourceBuffer *buffer, const char *path);
+void source_buffer_close(SourceBuffer *buffer);
+
+// Runs shell commands with at most jobs of them at once. Waits for every
+// started command; false if any failed (no new ones start after a failure).
+bool run_commands(char **commands, size_t count, size_t jobs);
+
 char *resolve_module_path(const char *current_file, const char *import_path);
-char *util_mangle_name(const char *prefix, const char *name);
-char *util_mangle_instantiation(const char *base_name, Type **type_args, size_t type_arg_count);
+// Mangled names are interned and must not be freed
+const char *util_mangle_name(const char *prefix, const char *name);
+const char *util_mangle_instantiation(const char *base_name, Type **type_args, size_t type_arg_count);
+// C struct result<T, E> lowers to, from the payload C types ("void" for
+// none): "struct Result_int32_t__uint8_tp" for result<i32, u8*>
+char *util_result_c_type(const char *ok_c_type, const char *err_c_type);
+// C spelling of a type, "void" for none. Generic parameters were erased
+// to uint8_t, so single capital letter struct names render as that.
+char *util_type_to_c_string(const Type *type);
 
 #endif
@@ -0,0 +1,126 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../include/arena.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGN _Alignof(max_align_t)
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t used;
+    size_t capacity;
+    _Alignas(max_align_t) unsigned char data[];
+};
+
+// Per thread so front-end workers can each fill their own module's arena
+static _Thread_local Arena *current_arena = NULL;
+
+Arena *arena_create(void) {
+    Arena *arena = malloc(sizeof(Arena));
+    arena->blocks = NULL;
+    arena->bytes_used = 0;
+    arena->bytes_reserved = 0;
+    arena->block_count = 0;
+    return arena;
+}
+
+void arena_free(Arena *arena) {
+    if (!arena) return;
+    if (current_arena == arena) current_arena = NULL;
+    ArenaBlock *block = arena->blocks;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
+
+static ArenaBlock *arena_new_block(Arena *arena, size_t min_size) {
+    size_t capacity = min_size > ARENA_BLOCK_SIZE ? min_size : ARENA_BLOCK_SIZE;
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + capacity);
+    if (!block) {
+        fprintf(stderr, "Error: Failed to allocate arena block\n");
+        exit(1);
+    }
+    block->used = 0;
+    block->capacity = capacity;
+    arena->bytes_reserved += capacity;
+    arena->block_count++;
+    return block;
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (size == 0) size = ARENA_ALIGN;
+
+    ArenaBlock *block = arena->blocks;
+    if (!block || block->capacity - block->used < size) {
+        ArenaBlock *fresh = arena_new_block(arena, size);
+        if (block && size > ARENA_BLOCK_SIZE) {
+            // Oversized request: keep bumping in the current block afterwards
+            fresh->next = block->next;
+            block->next = fresh;
+        } else {
+            fresh->next = block;
+            arena->blocks = fresh;
+        }
+        block = fresh;
+    }
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    arena->bytes_used += size;
+    return ptr;
+}
+
+char *arena_strdup(Arena *arena, const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = arena_alloc(arena, len);
+    memcpy(copy, str, len);
+    return copy;
+}
+
+void arena_set_current(Arena *arena) {
+    current_arena = arena;
+}
+
+Arena *arena_current(void) {
+    return current_arena;
+}
+
+void *arena_node_alloc(size_t size) {
+    if (current_arena) return arena_alloc(current_arena, size);
+    return malloc(size);
+}
+
+void *arena_node_calloc(size_t size) {
+    if (current_arena) {
+        void *ptr = arena_alloc(current_arena, size);
+        memset(ptr, 0, size);
+        return ptr;
+    }
+    return calloc(1, size);
+}
+
+char *arena_node_strdup(const char *str) {
+    if (!str) return NULL;
+    if (current_arena) return arena_strdup(current_arena, str);
+    return strdup(str);
+}
+
+void *arena_node_adopt(void *ptr, size_t size) {
+    if (!ptr || !current_arena) return ptr;
+    void *copy = arena_alloc(current_arena, size);
+    memcpy(copy, ptr, size);
+    free(ptr);
+    return copy;
+}
+
+void arena_node_free(void *ptr) {
+    if (current_arena) return;
+    free(ptr);
+}
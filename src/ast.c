@@ -3,11 +3,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../include/ast.h"
+#include "../include/arena.h"
+#include "../include/intern.h"
 
 // Expression creation functions
 
 ASTExpr *ast_create_literal(Token *token) {
-    ASTExpr *expr = malloc(sizeof(ASTExpr));
+    ASTExpr *expr = arena_node_alloc(sizeof(ASTExpr));
     expr->type = AST_LITERAL_EXPR;
     expr->line = token->line;
     expr->column = token->column;
@@ -22,7 +24,7 @@ ASTExpr *ast_create_literal(Token *token) {
             expr->data.literal.value.float_value = token->value.float_value;
             break;
         case TOKEN_STRING:
-            expr->data.literal.value.string_value = strdup(token->lexeme);
+            expr->data.literal.value.string_value = arena_node_strdup(token_lexeme(token));
             break;
         case TOKEN_TRUE:
         case TOKEN_FALSE:
@@ -38,17 +40,17 @@ ASTExpr *ast_create_literal(Token *token) {
 }
 
 ASTExpr *ast_create_variable(const char *name, size_t line, size_t column) {
-    ASTExpr *expr = malloc(sizeof(ASTExpr));
+    ASTExpr *expr = arena_node_alloc(sizeof(ASTExpr));
     expr->type = AST_VARIABLE_EXPR;
     expr->line = line;
     expr->column = column;
     expr->expr_type = NULL;
-    expr->data.variable.name = strdup(name);
+    expr->data.variable.name = arena_node_strdup(name);
     return expr;
 }
 
 ASTExpr *ast_create_binary(TokenType op, ASTExpr *left, ASTExpr *right, size_t line, size_t column) {
-    ASTExpr *expr = malloc(sizeof(ASTExpr));
+    ASTExpr *expr = arena_node_alloc(sizeof(ASTExpr));
     expr->type = AST_BINARY_EXPR;
     expr->line = line;
     expr->column = column;
@@ -60,7 +62,7 @@ ASTExpr *ast_create_binary(TokenType op, ASTExpr *left, ASTExpr *right, size_t l
 }
 
 ASTExpr *ast_create_unary(TokenType op, ASTExpr *operand, size_t line, size_t column) {
-    ASTExpr *expr = malloc(sizeof(ASTExpr));
+    ASTExpr *expr = arena_node_alloc(sizeof(ASTExpr));
     expr->type = AST_UNARY_EXPR;
     expr->line = line;
     expr->column = column;
@@ -71,7 +73,7 @@ ASTExpr *ast_create_unary(TokenType op, ASTExpr *operand, size_t line, size_t co
 }
 
 ASTExpr *ast_create_call(ASTExpr *callee, ASTExpr **args, size_t arg_count, Type **generic_args, size_t generic_count, size_t line, size_t column) {
-    ASTExpr *expr = malloc(sizeof(ASTExpr));
+    ASTExpr *expr = arena_node_alloc(sizeof(ASTExpr));
     expr->type = AST_CALL_EXPR;
     expr->line = line;
     expr->column = column;
@@ -85,7 +87,7 @@ ASTExpr *ast_create_call(ASTExpr *callee, ASTExpr **args, size_t arg_count, Type
 }
 
 ASTExpr *ast_create_index(ASTExpr *array, ASTExpr *index, size_t line, size_t column) {
-    ASTExpr *expr = malloc(sizeof(ASTExpr));
+    ASTExpr *expr = arena_node_alloc(sizeof(ASTExpr));
     expr->type = AST_INDEX_EXPR;
     expr->line = line;
     expr->column = column;
@@ -96,7 +98,7 @@ ASTExpr *ast_create_index(ASTExpr *array, ASTExpr *index, size_t line, size_t co
 }
 
 ASTExpr *ast_create_slice_expr(ASTExpr *array, ASTExpr *start, ASTExpr *end, size_t line, size_t column) {
-    ASTExpr *expr = malloc(sizeof(ASTExpr));
+    ASTExpr *expr = arena_node_alloc(sizeof(ASTExpr));
     expr->type = AST_SLICE_EXPR;
     expr->line = line;
     expr->column = column;
@@ -108,13 +110,13 @@ ASTExpr *ast_create_slice_expr(ASTExpr *array, ASTExpr *start, ASTExpr *end, siz
 }
 
 ASTExpr *ast_create_member(ASTExpr *object, const char *member, bool is_arrow, size_t line, size_t column) {
-    ASTExpr *expr = malloc(sizeof(ASTExpr));
+    ASTExpr *expr = arena_node_alloc(sizeof(ASTExpr));
     expr->type = AST_MEMBER_EXPR;
     expr->line = line;
     expr->column = column;
     expr->expr_type = NULL;
     expr->data.member.object = object;
-    expr->data.member.member = strdup(member);
+    expr->data.member.member = arena_node_strdup(member);
     expr->data.member.is_arrow = is_arrow;
     return expr;
 }
@@ -122,7 +124,7 @@ ASTExpr *ast_create_member(ASTExpr *object, const char *member, bool is_arrow, s
 // Statement creation functions
 
 ASTStmt *ast_create_expr_stmt(ASTExpr *expr, size_t line, size_t column) {
-    ASTStmt *stmt = malloc(sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_alloc(sizeof(ASTStmt));
     stmt->type = AST_EXPR_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -131,19 +133,19 @@ ASTStmt *ast_create_expr_stmt(ASTExpr *expr, size_t line, size_t column) {
 }
 
 ASTStmt *ast_create_var_decl(bool is_const, Type *type, const char *name, ASTExpr *init, size_t line, size_t column) {
-    ASTStmt *stmt = malloc(sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_alloc(sizeof(ASTStmt));
     stmt->type = AST_VAR_DECL_STMT;
     stmt->line = line;
     stmt->column = column;
     stmt->data.var_decl.is_const = is_const;
     stmt->data.var_decl.var_type = type;
-    stmt->data.var_decl.name = strdup(name);
+    stmt->data.var_decl.name = arena_node_strdup(name);
     stmt->data.var_decl.initializer = init;
     return stmt;
 }
 
 ASTStmt *ast_create_if(ASTExpr *cond, ASTStmt *then_branch, ASTStmt *else_branch, size_t line, size_t column) {
-    ASTStmt *stmt = malloc(sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_alloc(sizeof(ASTStmt));
     stmt->type = AST_IF_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -154,7 +156,7 @@ ASTStmt *ast_create_if(ASTExpr *cond, ASTStmt *then_branch, ASTStmt *else_branch
 }
 
 ASTStmt *ast_create_while(ASTExpr *cond, ASTStmt *body, size_t line, size_t column) {
-    ASTStmt *stmt = malloc(sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_alloc(sizeof(ASTStmt));
     stmt->type = AST_WHILE_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -164,7 +166,7 @@ ASTStmt *ast_create_while(ASTExpr *cond, ASTStmt *body, size_t line, size_t colu
 }
 
 ASTStmt *ast_create_for(ASTStmt *init, ASTExpr *cond, ASTExpr *inc, ASTStmt *body, size_t line, size_t column) {
-    ASTStmt *stmt = malloc(sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_alloc(sizeof(ASTStmt));
     stmt->type = AST_FOR_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -176,7 +178,7 @@ ASTStmt *ast_create_for(ASTStmt *init, ASTExpr *cond, ASTExpr *inc, ASTStmt *bod
 }
 
 ASTStmt *ast_create_return(ASTExpr *value, size_t line, size_t column) {
-    ASTStmt *stmt = malloc(sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_alloc(sizeof(ASTStmt));
     stmt->type = AST_RETURN_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -185,7 +187,7 @@ ASTStmt *ast_create_return(ASTExpr *value, size_t line, size_t column) {
 }
 
 ASTStmt *ast_create_block(ASTStmt **stmts, size_t count, size_t line, size_t column) {
-    ASTStmt *stmt = malloc(sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_alloc(sizeof(ASTStmt));
     stmt->type = AST_BLOCK_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -195,7 +197,7 @@ ASTStmt *ast_create_block(ASTStmt **stmts, size_t count, size_t line, size_t col
 }
 
 ASTStmt *ast_create_match(ASTExpr *expr, ASTMatchCase *cases, size_t case_count, size_t line, size_t column) {
-    ASTStmt *stmt = malloc(sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_alloc(sizeof(ASTStmt));
     stmt->type = AST_MATCH_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -206,7 +208,7 @@ ASTStmt *ast_create_match(ASTExpr *expr, ASTMatchCase *cases, size_t case_count,
 }
 
 ASTStmt *ast_create_fail(ASTExpr *message, size_t line, size_t column) {
-    ASTStmt *stmt = malloc(sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_alloc(sizeof(ASTStmt));
     stmt->type = AST_FAIL_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -215,7 +217,7 @@ ASTStmt *ast_create_fail(ASTExpr *message, size_t line, size_t column) {
 }
 
 ASTStmt *ast_create_unsafe(ASTStmt *body, size_t line, size_t column) {
-    ASTStmt *stmt = calloc(1, sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_calloc(sizeof(ASTStmt));
     stmt->type = AST_UNSAFE_STMT;
     stmt->data.unsafe_stmt.body = body;
     stmt->line = line;
@@ -224,7 +226,7 @@ ASTStmt *ast_create_unsafe(ASTStmt *body, size_t line, size_t column) {
 }
 
 ASTStmt *ast_create_break(size_t line, size_t column) {
-    ASTStmt *stmt = calloc(1, sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_calloc(sizeof(ASTStmt));
     stmt->type = AST_BREAK_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -232,7 +234,7 @@ ASTStmt *ast_create_break(size_t line, size_t column) {
 }
 
 ASTStmt *ast_create_continue(size_t line, size_t column) {
-    ASTStmt *stmt = calloc(1, sizeof(ASTStmt));
+    ASTStmt *stmt = arena_node_calloc(sizeof(ASTStmt));
     stmt->type = AST_CONTINUE_STMT;
     stmt->line = line;
     stmt->column = column;
@@ -242,11 +244,11 @@ ASTStmt *ast_create_continue(size_t line, size_t column) {
 // Declaration creation functions
 
 ASTDecl *ast_create_function(const char *name, char **type_params, size_t type_param_count, ASTParam *params, size_t param_count, Type *ret_type, ASTStmt *body, bool is_public, bool is_extern, bool is_variadic, bool is_unsafe, size_t line, size_t column) {
-    ASTDecl *decl = malloc(sizeof(ASTDecl));
+    ASTDecl *decl = arena_node_alloc(sizeof(ASTDecl));
     decl->type = AST_FUNCTION_DECL;
     decl->line = line;
     decl->column = column;
-    decl->data.function.name = strdup(name);
+    decl->data.function.name = intern(name);
     decl->data.function.type_params = type_params;
     decl->data.function.type_param_count = type_param_count;
     decl->data.function.params = params;
@@ -261,11 +263,11 @@ ASTDecl *ast_create_function(const char *name, char **type_params, size_t type_p
 }
 
 ASTDecl *ast_create_struct(const char *name, char **type_params, size_t type_param_count, ASTField *fields, size_t field_count, bool is_public, bool is_packed, size_t line, size_t column) {
-    ASTDecl *decl = malloc(sizeof(ASTDecl));
+    ASTDecl *decl = arena_node_alloc(sizeof(ASTDecl));
     decl->type = AST_STRUCT_DECL;
     decl->line = line;
     decl->column = column;
-    decl->data.struct_decl.name = strdup(name);
+    decl->data.struct_decl.name = intern(name);
     decl->data.struct_decl.type_params = type_params;
     decl->data.struct_decl.type_param_count = type_param_count;
     decl->data.struct_decl.fields = fields;
@@ -276,11 +278,11 @@ ASTDecl *ast_create_struct(const char *name, char **type_params, size_t type_par
 }
 
 ASTDecl *ast_create_enum(const char *name, char **type_params, size_t type_param_count, ASTEnumVariant *variants, size_t variant_count, bool is_public, size_t line, size_t column) {
-    ASTDecl *decl = malloc(sizeof(ASTDecl));
+    ASTDecl *decl = arena_node_alloc(sizeof(ASTDecl));
     decl->type = AST_ENUM_DECL;
     decl->line = line;
     decl->column = column;
-    decl->data.enum_decl.name = strdup(name);
+    decl->data.enum_decl.name = intern(name);
     decl->data.enum_decl.type_params = type_params;
     decl->data.enum_decl.type_param_count = type_param_count;
     decl->data.enum_decl.variants = variants;
@@ -290,30 +292,30 @@ ASTDecl *ast_create_enum(const char *name, char **type_params, size_t type_param
 }
 
 ASTDecl *ast_create_module(const char *module_name, size_t line, size_t column) {
-    ASTDecl *decl = malloc(sizeof(ASTDecl));
+    ASTDecl *decl = arena_node_alloc(sizeof(ASTDecl));
     decl->type = AST_MODULE_DECL;
     decl->line = line;
     decl->column = column;
-    decl->data.module_decl.module_name = strdup(module_name);
+    decl->data.module_decl.module_name = arena_node_strdup(module_name);
     return decl;
 }
 
 ASTDecl *ast_create_import(const char *import_path, const char *alias, size_t line, size_t column) {
-    ASTDecl *decl = malloc(sizeof(ASTDecl));
+    ASTDecl *decl = arena_node_alloc(sizeof(ASTDecl));
     decl->type = AST_IMPORT_DECL;
     decl->line = line;
     decl->column = column;
-    decl->data.import_decl.import_path = strdup(import_path);
-    decl->data.import_decl.alias = alias ? strdup(alias) : NULL;
+    decl->data.import_decl.import_path = arena_node_strdup(import_path);
+    decl->data.import_decl.alias = alias ? arena_node_strdup(alias) : NULL;
     return decl;
 }
 
 ASTDecl *ast_create_variable_decl(const char *name, Type *type, ASTExpr *initializer, bool is_const, bool is_public, size_t line, size_t column) {
-    ASTDecl *decl = malloc(sizeof(ASTDecl));
+    ASTDecl *decl = arena_node_alloc(sizeof(ASTDecl));
     decl->type = AST_VAR_DECL_STMT;
     decl->line = line;
     decl->column = column;
-    decl->data.var_decl.name = strdup(name);
+    decl->data.var_decl.name = arena_node_strdup(name);
     decl->data.var_decl.var_type = type;
     decl->data.var_decl.initializer = initializer;
     decl->data.var_decl.is_const = is_const;
@@ -322,19 +324,19 @@ ASTDecl *ast_create_variable_decl(const char *name, Type *type, ASTExpr *initial
 }
 
 ASTDecl *ast_create_type_alias(const char *name, Type *target_type, bool is_public, size_t line, size_t column) {
-    ASTDecl *decl = malloc(sizeof(ASTDecl));
+    ASTDecl *decl = arena_node_alloc(sizeof(ASTDecl));
     decl->type = AST_TYPE_ALIAS_DECL;
     decl->line = line;
     decl->column = column;
-    decl->data.type_alias.name = strdup(name);
+    decl->data.type_alias.name = arena_node_strdup(name);
     decl->data.type_alias.target_type = target_type;
     decl->data.type_alias.is_public = is_public;
     return decl;
 }
 
 ASTProgram *ast_create_program(const char *module_name, ASTImportDecl **imports, size_t import_count, ASTDecl **decls, size_t count) {
-    ASTProgram *program = malloc(sizeof(ASTProgram));
-    program->module_name = module_name ? strdup(module_name) : NULL;
+    ASTProgram *program = arena_node_alloc(sizeof(ASTProgram));
+    program->module_name = module_name ? arena_node_strdup(module_name) : NULL;
     program->imports = imports;
     program->import_count = import_count;
     program->declarations = decls;
@@ -345,7 +347,7 @@ ASTProgram *ast_create_program(const char *module_name, ASTImportDecl **imports,
 // Destruction functions
 
 void ast_free_expr(ASTExpr *expr) {
-    if (!expr) return;
+    if (!expr || arena_current()) return; // Owned by the module arena
     
     switch (expr->type) {
         case AST_LITERAL_EXPR:
@@ -406,7 +408,7 @@ void ast_free_expr(ASTExpr *expr) {
 }
 
 void ast_free_stmt(ASTStmt *stmt) {
-    if (!stmt) return;
+    if (!stmt || arena_current()) return; // Owned by the module arena
     
     switch (stmt->type) {
         case AST_EXPR_STMT:
@@ -472,11 +474,10 @@ void ast_free_stmt(ASTStmt *stmt) {
 }
 
 void ast_free_decl(ASTDecl *decl) {
-    if (!decl) return;
+    if (!decl || arena_current()) return; // Owned by the module arena
     
     switch (decl->type) {
         case AST_FUNCTION_DECL:
-            free(decl->data.function.name);
             if (decl->data.function.type_params) {
                 for (size_t i = 0; i < decl->data.function.type_param_count; i++) {
                     free(decl->data.function.type_params[i]);
@@ -492,7 +493,6 @@ void ast_free_decl(ASTDecl *decl) {
             ast_free_stmt(decl->data.function.body);
             break;
         case AST_STRUCT_DECL:
-            free(decl->data.struct_decl.name);
             if (decl->data.struct_decl.type_params) {
                 for (size_t i = 0; i < decl->data.struct_decl.type_param_count; i++) {
                     free(decl->data.struct_decl.type_params[i]);
@@ -506,7 +506,6 @@ void ast_free_decl(ASTDecl *decl) {
             free(decl->data.struct_decl.fields);
             break;
         case AST_ENUM_DECL:
-            free(decl->data.enum_decl.name);
             if (decl->data.enum_decl.type_params) {
                 for (size_t i = 0; i < decl->data.enum_decl.type_param_count; i++) {
                     free(decl->data.enum_decl.type_params[i]);
@@ -539,7 +538,7 @@ void ast_free_decl(ASTDecl *decl) {
 }
 
 void ast_free_program(ASTProgram *program) {
-    if (!program) return;
+    if (!program || arena_current()) return; // Owned by the module arena
     
     if (program->module_name) {
         free(program->module_name);
@@ -578,7 +577,7 @@ void ast_print_expr(const ASTExpr *expr, int indent) {
     
     switch (expr->type) {
         case AST_LITERAL_EXPR:
-            printf("Literal: %s\n", expr->data.literal.token->lexeme);
+            printf("Literal: %s\n", token_lexeme(expr->data.literal.token));
             break;
         case AST_VARIABLE_EXPR:
             printf("Variable: %s\n", expr->data.variable.name);
@@ -0,0 +1,489 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include "../include/bce.h"
+#include "../include/cfg.h"
+#include "../include/ssa.h"
+
+#define BOUNDS_CHECK "virex_slice_bounds_check"
+#define RANGE_CHECK "virex_slice_range_check"
+
+// left < right (IR_LT) or left <= right (IR_LE), holding at a check
+typedef struct {
+    IROpcode relation;
+    IROperand *left;        // Borrowed from the compare instruction
+    IROperand *right;
+} Fact;
+
+typedef struct {
+    const char *name;
+    size_t len;
+} Ident;
+
+typedef struct {
+    IRFunction *func;
+    CFG *cfg;
+    Ident *escaped;         // Variables whose address is taken
+    size_t escaped_count;
+    const char **lengths;   // Slice length expressions the checks compare against
+    size_t length_count;
+    Fact *facts;
+    size_t fact_count;
+    size_t fact_capacity;
+    size_t *stack;          // Region walk scratch, one slot per block
+    unsigned char *seen;
+} BCEState;
+
+static const char *check_name(IRInstruction *instr) {
+    if (instr->opcode != IR_CALL || !instr->src1 || instr->src1->kind != IR_OP_VAR) return NULL;
+    const char *name = instr->src1->data.var_name;
+    if (strcmp(name, BOUNDS_CHECK) == 0 && instr->arg_count == 2) return name;
+    if (strcmp(name, RANGE_CHECK) == 0 && instr->arg_count == 3) return name;
+    return NULL;
+}
+
+static void record_first(const char *ident, size_t len, void *ctx) {
+    Ident *first = ctx;
+    if (!first->name) {
+        first->name = ident;
+        first->len = len;
+    }
+}
+
+// Variable a VAR expression is rooted at: "s" for "s.data[t3]"
+static Ident root_of(const char *expr) {
+    Ident root = {NULL, 0};
+    ir_scan_identifiers(expr, record_first, &root);
+    return root;
+}
+
+static bool ident_is(Ident ident, const char *name) {
+    return ident.name && strncmp(ident.name, name, ident.len) == 0 &&
+           (name[ident.len] == '\0' || name[ident.len] == '[');
+}
+
+static bool same_ident(Ident a, Ident b) {
+    return a.name && b.name && a.len == b.len && strncmp(a.name, b.name, a.len) == 0;
+}
+
+static bool same_operand(const IROperand *a, const IROperand *b) {
+    if (a->kind != b->kind) return false;
+    switch (a->kind) {
+        case IR_OP_TEMP: return a->data.temp_id == b->data.temp_id;
+        case IR_OP_CONST: return a->data.const_value == b->data.const_value;
+        case IR_OP_VAR: return strcmp(a->data.var_name, b->data.var_name) == 0;
+        default: return false;
+    }
+}
+
+// Named variable an instruction assigns, whole or in part
+static const IROperand *written_var(IRInstruction *instr) {
+    if (instr->opcode == IR_STORE) return instr->src1;
+    if (instr->dest && instr->dest->kind == IR_OP_VAR) return instr->dest;
+    return NULL;
+}
+
+// Whether instr may change the value of op
+static bool writes(IRInstruction *instr, const IROperand *op) {
+    if (op->kind == IR_OP_TEMP) {
+        return instr->dest && instr->dest->kind == IR_OP_TEMP && instr->dest->data.temp_id == op->data.temp_id;
+    }
+    if (op->kind != IR_OP_VAR) return false;
+    const IROperand *target = written_var(instr);
+    if (!target || target->kind != IR_OP_VAR) return false;
+    return same_ident(root_of(target->data.var_name), root_of(op->data.var_name));
+}
+
+static bool is_escaped(BCEState *state, Ident ident) {
+    for (size_t i = 0; i < state->escaped_count; i++) {
+        if (same_ident(state->escaped[i], ident)) return true;
+    }
+    return false;
+}
+
+static void mark_escaped(const char *ident, size_t len, void *ctx) {
+    BCEState *state = ctx;
+    Ident name = {ident, len};
+    if (is_escaped(state, name)) return;
+    state->escaped = realloc(state->escaped, sizeof(Ident) * (state->escaped_count + 1));
+    state->escaped[state->escaped_count++] = name;
+}
+
+// Declared type of a local or parameter, or NULL for anything else
+static const IRType *variable_type(IRFunction *func, Ident ident) {
+    for (size_t i = 0; i < func->local_var_count; i++) {
+        if (ident_is(ident, func->local_vars[i])) {
+            return func->local_var_types ? func->local_var_types[i] : NULL;
+        }
+    }
+    for (size_t i = 0; i < func->param_count; i++) {
+        if (ident_is(ident, func->params[i])) {
+            return func->param_types ? func->param_types[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+static bool is_local(IRFunction *func, Ident ident) {
+    for (size_t i = 0; i < func->local_var_count; i++) {
+        if (ident_is(ident, func->local_vars[i])) return true;
+    }
+    return false;
+}
+
+// A variable or field path such as "i" or "a.bytes.len"
+static bool is_plain_path(const char *expr) {
+    if (!isalpha((unsigned char)expr[0]) && expr[0] != '_') return false;
+    for (const char *p = expr; *p; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '_' && *p != '.') return false;
+    }
+    return true;
+}
+
+// Operands facts may talk about: constants, signed integer temps, and
+// signed locals, parameters or slice lengths nothing can write behind
+// the function's back
+static bool is_trackable(BCEState *state, const IROperand *op) {
+    switch (op->kind) {
+        case IR_OP_CONST:
+            return true;
+        case IR_OP_TEMP:
+            return ssa_const_fits(ssa_temp_type(state->func, op->data.temp_id), 0);
+        case IR_OP_VAR: {
+            const char *expr = op->data.var_name;
+            if (!is_plain_path(expr)) return false;
+            Ident root = root_of(expr);
+            const IRType *type = variable_type(state->func, root);
+            if (!type || is_escaped(state, root)) return false;
+            if (!strchr(expr, '.')) return ssa_const_fits(type, 0);
+            for (size_t i = 0; i < state->length_count; i++) {
+                if (strcmp(state->lengths[i], expr) == 0) return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+static void add_fact(BCEState *state, IROpcode relation, IROperand *left, IROperand *right) {
+    if (state->fact_count == state->fact_capacity) {
+        state->fact_capacity = state->fact_capacity ? state->fact_capacity * 2 : 8;
+        state->facts = realloc(state->facts, sizeof(Fact) * state->fact_capacity);
+    }
+    state->facts[state->fact_count++] = (Fact){relation, left, right};
+}
+
+// Compare whose outcome decides every entry into block: the block has a
+// single predecessor, which branches on a compare either straight to the
+// block (truth true) or through the jump that follows the branch (truth
+// false). *branch_block receives the block holding the branch.
+static IRInstruction *entry_condition(BCEState *state, size_t block, bool *truth, size_t *branch_block) {
+    CFG *cfg = state->cfg;
+    IRFunction *func = state->func;
+    BasicBlock *b = &cfg->blocks[block];
+    if (b->pred_count != 1) return NULL;
+    size_t pred = b->preds[0];
+    BasicBlock *p = &cfg->blocks[pred];
+    IRInstruction *last = func->instructions[p->end - 1];
+
+    size_t decider = pred;
+    if (last->opcode == IR_BRANCH) {
+        if (p->succ_count != 2 || p->succs[0] != block || p->succs[1] == block) return NULL;
+        *truth = true;
+    } else if (last->opcode == IR_JUMP && p->end - p->start == 1 && p->pred_count == 1) {
+        decider = p->preds[0];
+        BasicBlock *d = &cfg->blocks[decider];
+        last = func->instructions[d->end - 1];
+        if (last->opcode != IR_BRANCH || d->succ_count != 2 || d->succs[1] != pred || d->succs[0] == block) return NULL;
+        *truth = false;
+    } else {
+        return NULL;
+    }
+    if (!last->src1 || last->src1->kind != IR_OP_TEMP) return NULL;
+
+    // The compare must sit in the same block, with its operands unchanged
+    // up to the branch
+    BasicBlock *d = &cfg->blocks[decider];
+    for (size_t i = d->end - 1; i-- > d->start;) {
+        IRInstruction *instr = func->instructions[i];
+        if (!writes(instr, last->src1)) continue;
+        if (instr->opcode < IR_EQ || instr->opcode > IR_GE || !instr->src1 || !instr->src2) return NULL;
+        for (size_t j = i + 1; j < d->end; j++) {
+            if (writes(func->instructions[j], instr->src1) || writes(func->instructions[j], instr->src2)) return NULL;
+        }
+        *branch_block = decider;
+        return instr;
+    }
+    return NULL;
+}
+
+static bool range_writes(BCEState *state, size_t start, size_t end, const IROperand *a, const IROperand *b) {
+    for (size_t i = start; i < end; i++) {
+        IRInstruction *instr = state->func->instructions[i];
+        if (writes(instr, a) || writes(instr, b)) return true;
+    }
+    return false;
+}
+
+// Whether a and b keep their values on every path from the entry of
+// block from to instruction index of block to, which from dominates
+static bool unchanged_between(BCEState *state, size_t from, size_t to, size_t index,
+                              const IROperand *a, const IROperand *b) {
+    CFG *cfg = state->cfg;
+    if (range_writes(state, cfg->blocks[to].start, index, a, b)) return false;
+    if (from == to) return true;
+
+    // Walk backwards from the check up to from. Reaching the check's block
+    // again means a loop runs through it, so its tail counts too.
+    memset(state->seen, 0, cfg->block_count);
+    size_t top = 0;
+    state->seen[to] = 1;
+    state->stack[top++] = to;
+    bool ok = true;
+    while (ok && top > 0) {
+        BasicBlock *block = &cfg->blocks[state->stack[--top]];
+        for (size_t p = 0; ok && p < block->pred_count; p++) {
+            size_t pred = block->preds[p];
+            if (pred == to && state->seen[to] == 1) {
+                state->seen[to] = 2;
+                ok = !range_writes(state, index, cfg->blocks[to].end, a, b);
+                continue;
+            }
+            if (state->seen[pred]) continue;
+            state->seen[pred] = 1;
+            ok = !range_writes(state, cfg->blocks[pred].start, cfg->blocks[pred].end, a, b);
+            if (pred != from) state->stack[top++] = pred;
+        }
+    }
+    return ok;
+}
+
+// Facts from the branch conditions that dominate instruction index of block
+static void collect_facts(BCEState *state, size_t block, size_t index) {
+    CFG *cfg = state->cfg;
+    state->fact_count = 0;
+    for (size_t b = block;; b = cfg->blocks[b].idom) {
+        bool truth = false;
+        size_t branch_block = CFG_NONE;
+        IRInstruction *cmp = entry_condition(state, b, &truth, &branch_block);
+        if (cmp && is_trackable(state, cmp->src1) && is_trackable(state, cmp->src2) &&
+            unchanged_between(state, b, block, index, cmp->src1, cmp->src2)) {
+            IROperand *l = cmp->src1;
+            IROperand *r = cmp->src2;
+            switch (cmp->opcode) {
+                case IR_LT: truth ? add_fact(state, IR_LT, l, r) : add_fact(state, IR_LE, r, l); break;
+                case IR_LE: truth ? add_fact(state, IR_LE, l, r) : add_fact(state, IR_LT, r, l); break;
+                case IR_GT: truth ? add_fact(state, IR_LT, r, l) : add_fact(state, IR_LE, l, r); break;
+                case IR_GE: truth ? add_fact(state, IR_LE, r, l) : add_fact(state, IR_LT, l, r); break;
+                case IR_EQ:
+                case IR_NE:
+                    if (truth == (cmp->opcode == IR_EQ)) {
+                        add_fact(state, IR_LE, l, r);
+                        add_fact(state, IR_LE, r, l);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (cfg->blocks[b].idom == b || cfg->blocks[b].idom == CFG_NONE) break;
+    }
+}
+
+// a <= b (or a < b) with nothing to prove: the same operand, or constants
+static bool known_order(const IROperand *a, const IROperand *b, bool strict) {
+    if (a->kind == IR_OP_CONST && b->kind == IR_OP_CONST) {
+        return strict ? a->data.const_value < b->data.const_value : a->data.const_value <= b->data.const_value;
+    }
+    return !strict && same_operand(a, b);
+}
+
+// a < b (strict) or a <= b from the collected facts, chaining at most two
+static bool proves_order(BCEState *state, const IROperand *a, const IROperand *b, bool strict) {
+    if (known_order(a, b, strict)) return true;
+    for (size_t i = 0; i < state->fact_count; i++) {
+        Fact *f = &state->facts[i];
+        if (!known_order(a, f->left, false)) continue;
+        bool need = strict && f->relation != IR_LT;
+        if (known_order(f->right, b, need)) return true;
+        for (size_t j = 0; j < state->fact_count; j++) {
+            Fact *g = &state->facts[j];
+            if (same_operand(g->left, f->right) && known_order(g->right, b, need && g->relation != IR_LT)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// A local only ever set to non-negative constants or to itself plus a
+// positive constant, with one constant set dominating instruction index
+// of block. A 64-bit counter can only wrap after 2^63 increments; the
+// loops this matters for are bounded by a slice length long before that.
+// A narrower one wraps within reach of a slice length, so each step must
+// sit under a branch that keeps it from passing the type's maximum.
+// Replaces the collected facts.
+static bool is_counter(BCEState *state, const IROperand *op, size_t block, size_t index) {
+    IRFunction *func = state->func;
+    if (op->kind != IR_OP_VAR || !is_plain_path(op->data.var_name) || strchr(op->data.var_name, '.')) return false;
+    Ident name = root_of(op->data.var_name);
+    if (!is_local(func, name) || is_escaped(state, name)) return false;
+    const IRType *type = variable_type(func, name);
+    if (!ssa_const_fits(type, 0)) return false;
+    long max = type->size >= 8 ? 0 : (1L << (type->size * 8 - 1)) - 1;
+
+    bool initialized = false;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        if (!writes(instr, op)) continue;
+        if (instr->opcode != IR_STORE && instr->opcode != IR_MOVE) return false;
+        if (!same_operand(written_var(instr), op)) return false;
+        IROperand *value = instr->opcode == IR_STORE ? instr->src2 : instr->src1;
+        if (!value) return false;
+        size_t at = state->cfg->block_of[i];
+
+        if (value->kind == IR_OP_CONST) {
+            if (value->data.const_value < 0) return false;
+            if (cfg_reachable(state->cfg, at) && cfg_dominates(state->cfg, at, block) && (at != block || i < index)) {
+                initialized = true;
+            }
+            continue;
+        }
+        if (value->kind != IR_OP_TEMP) return false;
+
+        // The step is computed in the same block, reading the value the
+        // store replaces
+        bool stepped = false;
+        for (size_t j = i; j-- > state->cfg->blocks[at].start;) {
+            IRInstruction *def = func->instructions[j];
+            if (writes(def, op)) break;
+            if (!writes(def, value)) continue;
+            if (def->opcode == IR_ADD && def->src1 && def->src2) {
+                IROperand *var = def->src1->kind == IR_OP_CONST ? def->src2 : def->src1;
+                IROperand *step = def->src1->kind == IR_OP_CONST ? def->src1 : def->src2;
+                stepped = same_operand(var, op) && step->kind == IR_OP_CONST && step->data.const_value > 0;
+                if (stepped && max > 0) {
+                    // op <= max - step where the step reads it
+                    IROperand limit = {.kind = IR_OP_CONST, .data.const_value = max - step->data.const_value};
+                    collect_facts(state, at, j);
+                    stepped = proves_order(state, op, &limit, false);
+                }
+            }
+            break;
+        }
+        if (!stepped) return false;
+    }
+    return initialized;
+}
+
+static bool is_non_negative(BCEState *state, IROperand *op, size_t block, size_t index) {
+    IROperand zero = {.kind = IR_OP_CONST, .data.const_value = 0};
+    return proves_order(state, &zero, op, false) || is_counter(state, op, block, index);
+}
+
+// Whether the check at instruction index can never fail
+static bool check_holds(BCEState *state, size_t index) {
+    IRInstruction *instr = state->func->instructions[index];
+    size_t block = state->cfg->block_of[index];
+    collect_facts(state, block, index);
+    IROperand **args = instr->args;
+    // is_non_negative goes last: proving a counter replaces the facts
+    if (strcmp(instr->src1->data.var_name, BOUNDS_CHECK) == 0) {
+        return proves_order(state, args[0], args[1], true) && is_non_negative(state, args[0], block, index);
+    }
+    return proves_order(state, args[0], args[1], false) &&
+           proves_order(state, args[1], args[2], false) &&
+           is_non_negative(state, args[0], block, index);
+}
+
+static void operand_text(const IROperand *op, char *buf, size_t size) {
+    switch (op->kind) {
+        case IR_OP_TEMP: snprintf(buf, size, "t%d", op->data.temp_id); break;
+        case IR_OP_CONST: snprintf(buf, size, "%ld", op->data.const_value); break;
+        case IR_OP_VAR: snprintf(buf, size, "%s", op->data.var_name); break;
+        default: snprintf(buf, size, "?"); break;
+    }
+}
+
+static void report_check(IRInstruction *instr) {
+    printf("  %s(", instr->src1->data.var_name);
+    for (size_t a = 0; a < instr->arg_count; a++) {
+        char text[256];
+        operand_text(instr->args[a], text, sizeof(text));
+        printf("%s%s", a ? ", " : "", text);
+    }
+    printf(")\n");
+}
+
+void bce_run(IRFunction *func, bool report) {
+    if (!func || func->instruction_count == 0) return;
+
+    BCEState state = {0};
+    state.func = func;
+    size_t check_count = 0;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        if (check_name(instr)) {
+            IROperand *len = instr->args[instr->arg_count - 1];
+            if (len->kind == IR_OP_VAR) {
+                state.lengths = realloc(state.lengths, sizeof(char*) * (state.length_count + 1));
+                state.lengths[state.length_count++] = len->data.var_name;
+            }
+            check_count++;
+        }
+        if (instr->opcode == IR_ADDR && instr->src1 && instr->src1->kind == IR_OP_VAR) {
+            ir_scan_identifiers(instr->src1->data.var_name, mark_escaped, &state);
+        }
+        IROperand **slot;
+        for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+            if ((*slot)->kind == IR_OP_VAR && strchr((*slot)->data.var_name, '&')) {
+                ir_scan_identifiers((*slot)->data.var_name, mark_escaped, &state);
+            }
+        }
+    }
+    if (check_count == 0) {
+        free(state.lengths);
+        free(state.escaped);
+        return;
+    }
+
+    state.cfg = cfg_build(func);
+    state.stack = malloc(sizeof(size_t) * state.cfg->block_count);
+    state.seen = malloc(state.cfg->block_count);
+
+    // Decide every check before removing any, since facts borrow operands
+    bool *removable = calloc(func->instruction_count, sizeof(bool));
+    size_t removed = 0;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        if (!check_name(func->instructions[i])) continue;
+        if (!cfg_reachable(state.cfg, state.cfg->block_of[i])) continue;
+        if (check_holds(&state, i)) {
+            removable[i] = true;
+            removed++;
+        }
+    }
+
+    if (report) {
+        printf("bce: %s: %zu of %zu checks removed\n", func->name, removed, check_count);
+        for (size_t i = 0; i < func->instruction_count; i++) {
+            if (check_name(func->instructions[i]) && !removable[i]) report_check(func->instructions[i]);
+        }
+    }
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        if (!removable[i]) continue;
+        ir_instruction_free(func->instructions[i]);
+        func->instructions[i] = ir_instruction_create(IR_NOP, NULL, NULL, NULL);
+    }
+
+    free(removable);
+    free(state.facts);
+    free(state.stack);
+    free(state.seen);
+    free(state.lengths);
+    free(state.escaped);
+    cfg_free(state.cfg);
+}
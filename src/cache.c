@@ -0,0 +1,120 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../include/cache.h"
+#include "../include/virex.h"
+
+#define FNV64_OFFSET 14695981039346656037ull
+#define FNV64_PRIME 1099511628211ull
+
+uint64_t cache_hash_bytes(const void *data, size_t length, uint64_t seed) {
+    const unsigned char *bytes = data;
+    uint64_t hash = seed ? seed : FNV64_OFFSET;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV64_PRIME;
+    }
+    return hash;
+}
+
+uint64_t cache_hash_string(const char *str, uint64_t seed) {
+    // Include the terminator so ("ab", "c") and ("a", "bc") differ
+    return cache_hash_bytes(str, strlen(str) + 1, seed);
+}
+
+uint64_t cache_hash_u64(uint64_t value, uint64_t seed) {
+    return cache_hash_bytes(&value, sizeof(value), seed);
+}
+
+bool cache_hash_file(const char *path, uint64_t *hash) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+
+    char buffer[64 * 1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        *hash = cache_hash_bytes(buffer, n, *hash);
+    }
+    fclose(file);
+    return true;
+}
+
+uint64_t cache_compiler_hash(void) {
+    static uint64_t compiler_hash = 0;
+    if (compiler_hash) return compiler_hash;
+
+    compiler_hash = cache_hash_string(VIREX_VERSION, 0);
+    cache_hash_file("/proc/self/exe", &compiler_hash);
+    return compiler_hash;
+}
+
+bool cache_prepare(void) {
+    if (mkdir(BUILD_CACHE_DIR, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Warning: Could not create cache directory '%s': %s\n", BUILD_CACHE_DIR, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void cache_artifact_path(char *buffer, size_t size, uint64_t key, const char *extension) {
+    snprintf(buffer, size, "%s/%016" PRIx64 "%s", BUILD_CACHE_DIR, key, extension);
+}
+
+bool cache_has(uint64_t key, const char *extension) {
+    char path[512];
+    cache_artifact_path(path, sizeof(path), key, extension);
+    return access(path, R_OK) == 0;
+}
+
+char **cache_read_manifest(uint64_t key, size_t *count) {
+    char path[512];
+    cache_artifact_path(path, sizeof(path), key, ".link");
+    FILE *file = fopen(path, "r");
+    if (!file) return NULL;
+
+    char **objects = NULL;
+    size_t object_count = 0;
+    bool complete = true;
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (!line[0]) continue;
+        // An evicted object invalidates the whole manifest
+        if (access(line, R_OK) != 0) {
+            complete = false;
+            break;
+        }
+        objects = realloc(objects, sizeof(char*) * (object_count + 1));
+        objects[object_count++] = strdup(line);
+    }
+    fclose(file);
+
+    if (!complete || object_count == 0) {
+        for (size_t i = 0; i < object_count; i++) free(objects[i]);
+        free(objects);
+        return NULL;
+    }
+    *count = object_count;
+    return objects;
+}
+
+bool cache_write_manifest(uint64_t key, char **objects, size_t count) {
+    char path[512];
+    char temp_path[600];
+    cache_artifact_path(path, sizeof(path), key, ".link");
+    snprintf(temp_path, sizeof(temp_path), "%s.%ld.tmp", path, (long)getpid());
+
+    FILE *file = fopen(temp_path, "w");
+    if (!file) return false;
+    for (size_t i = 0; i < count; i++) {
+        fprintf(file, "%s\n", objects[i]);
+    }
+    bool ok = fclose(file) == 0 && rename(temp_path, path) == 0;
+    if (!ok) remove(temp_path);
+    return ok;
+}
@@ -0,0 +1,437 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../include/cfg.h"
+
+struct LabelSlot {
+    const char *name;       // Borrowed from the IR_LABEL operand
+    size_t block;
+};
+
+static uint64_t label_hash(const char *name) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static const char *label_name(IRInstruction *instr) {
+    if (instr->opcode != IR_LABEL) return NULL;
+    if (!instr->src1 || instr->src1->kind != IR_OP_LABEL) return NULL;
+    return instr->src1->data.label_name;
+}
+
+// index-th label an instruction transfers control to, if any
+static const char *jump_target(IRInstruction *instr, size_t index) {
+    IROperand **op = ir_instruction_target(instr, index);
+    if (!op || !*op || (*op)->kind != IR_OP_LABEL) return NULL;
+    return (*op)->data.label_name;
+}
+
+static bool ends_block(IROpcode opcode) {
+    return opcode == IR_JUMP || opcode == IR_BRANCH || opcode == IR_SWITCH ||
+           opcode == IR_RETURN || opcode == IR_FAIL;
+}
+
+static void label_insert(CFG *cfg, const char *name, size_t block) {
+    size_t mask = cfg->label_capacity - 1;
+    size_t slot = label_hash(name) & mask;
+    while (cfg->labels[slot].name) {
+        if (strcmp(cfg->labels[slot].name, name) == 0) return;  // First definition wins
+        slot = (slot + 1) & mask;
+    }
+    cfg->labels[slot].name = name;
+    cfg->labels[slot].block = block;
+}
+
+size_t cfg_label_block(const CFG *cfg, const char *name) {
+    if (!cfg || !name || cfg->label_capacity == 0) return CFG_NONE;
+    size_t mask = cfg->label_capacity - 1;
+    size_t slot = label_hash(name) & mask;
+    while (cfg->labels[slot].name) {
+        if (strcmp(cfg->labels[slot].name, name) == 0) return cfg->labels[slot].block;
+        slot = (slot + 1) & mask;
+    }
+    return CFG_NONE;
+}
+
+// Split the instruction array into blocks. A block starts at the entry,
+// at every label and after every terminator.
+static void find_blocks(CFG *cfg) {
+    IRFunction *func = cfg->func;
+    size_t n = func->instruction_count;
+    size_t label_count = 0;
+
+    cfg->block_count = 0;
+    for (size_t i = 0; i < n; i++) {
+        IRInstruction *instr = func->instructions[i];
+        bool leader = (i == 0) || instr->opcode == IR_LABEL ||
+                      ends_block(func->instructions[i - 1]->opcode);
+        if (leader) cfg->block_count++;
+        if (label_name(instr)) label_count++;
+    }
+    // Empty functions still get an (empty) entry block
+    if (cfg->block_count == 0) cfg->block_count = 1;
+
+    cfg->blocks = calloc(cfg->block_count, sizeof(BasicBlock));
+    cfg->block_of = malloc((n ? n : 1) * sizeof(size_t));
+
+    cfg->label_capacity = 16;
+    while (cfg->label_capacity < label_count * 2) cfg->label_capacity *= 2;
+    cfg->labels = calloc(cfg->label_capacity, sizeof(LabelSlot));
+
+    size_t b = 0;
+    for (size_t i = 0; i < n; i++) {
+        IRInstruction *instr = func->instructions[i];
+        bool leader = (i == 0) || instr->opcode == IR_LABEL ||
+                      ends_block(func->instructions[i - 1]->opcode);
+        if (leader && i > 0) {
+            cfg->blocks[b].end = i;
+            b++;
+            cfg->blocks[b].start = i;
+        }
+        cfg->block_of[i] = b;
+        const char *name = label_name(instr);
+        if (name) label_insert(cfg, name, b);
+    }
+    cfg->blocks[b].end = n;
+}
+
+static void add_succ(BasicBlock *block, size_t succ) {
+    if (succ == CFG_NONE) return;
+    for (size_t i = 0; i < block->succ_count; i++) {
+        if (block->succs[i] == succ) return;
+    }
+    block->succs[block->succ_count++] = succ;
+}
+
+static void link_blocks(CFG *cfg) {
+    IRFunction *func = cfg->func;
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        BasicBlock *block = &cfg->blocks[b];
+        size_t next = (b + 1 < cfg->block_count) ? b + 1 : CFG_NONE;
+        IRInstruction *last = block->end > block->start ? func->instructions[block->end - 1] : NULL;
+        size_t capacity = 2;
+        if (last && last->opcode == IR_SWITCH) capacity = last->arg_count / 2 + 1;
+        block->succs = malloc(capacity * sizeof(size_t));
+        if (!last) {
+            add_succ(block, next);
+            continue;
+        }
+        switch (last->opcode) {
+            case IR_JUMP:
+                add_succ(block, cfg_label_block(cfg, jump_target(last, 0)));
+                break;
+            case IR_BRANCH:
+                add_succ(block, cfg_label_block(cfg, jump_target(last, 0)));
+                add_succ(block, next);
+                break;
+            case IR_SWITCH:
+                for (size_t t = 0; ir_instruction_target(last, t); t++) {
+                    add_succ(block, cfg_label_block(cfg, jump_target(last, t)));
+                }
+                break;
+            case IR_RETURN:
+            case IR_FAIL:
+                break;
+            default:
+                add_succ(block, next);
+                break;
+        }
+    }
+
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        for (size_t s = 0; s < cfg->blocks[b].succ_count; s++) {
+            cfg->blocks[cfg->blocks[b].succs[s]].pred_count++;
+        }
+    }
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        BasicBlock *block = &cfg->blocks[b];
+        block->preds = malloc((block->pred_count ? block->pred_count : 1) * sizeof(size_t));
+        block->pred_count = 0;
+    }
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        for (size_t s = 0; s < cfg->blocks[b].succ_count; s++) {
+            BasicBlock *succ = &cfg->blocks[cfg->blocks[b].succs[s]];
+            succ->preds[succ->pred_count++] = b;
+        }
+    }
+}
+
+// Iterative DFS from the entry; post-order reversed gives the RPO
+static void compute_rpo(CFG *cfg) {
+    size_t count = cfg->block_count;
+    size_t *stack = malloc(count * sizeof(size_t));
+    size_t *next_succ = calloc(count, sizeof(size_t));
+    bool *visited = calloc(count, sizeof(bool));
+    size_t *post = malloc(count * sizeof(size_t));
+    size_t post_count = 0;
+    size_t depth = 0;
+
+    for (size_t b = 0; b < count; b++) {
+        cfg->blocks[b].rpo_index = CFG_NONE;
+        cfg->blocks[b].idom = CFG_NONE;
+        cfg->blocks[b].loop = CFG_NONE;
+    }
+
+    stack[depth++] = 0;
+    visited[0] = true;
+    while (depth > 0) {
+        size_t b = stack[depth - 1];
+        BasicBlock *block = &cfg->blocks[b];
+        if (next_succ[b] < block->succ_count) {
+            size_t succ = block->succs[next_succ[b]++];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack[depth++] = succ;
+            }
+        } else {
+            post[post_count++] = b;
+            depth--;
+        }
+    }
+
+    cfg->rpo = malloc(post_count * sizeof(size_t));
+    cfg->rpo_count = post_count;
+    for (size_t i = 0; i < post_count; i++) {
+        size_t b = post[post_count - 1 - i];
+        cfg->rpo[i] = b;
+        cfg->blocks[b].rpo_index = i;
+    }
+
+    free(stack);
+    free(next_succ);
+    free(visited);
+    free(post);
+}
+
+static size_t intersect(CFG *cfg, size_t a, size_t b) {
+    while (a != b) {
+        while (cfg->blocks[a].rpo_index > cfg->blocks[b].rpo_index) a = cfg->blocks[a].idom;
+        while (cfg->blocks[b].rpo_index > cfg->blocks[a].rpo_index) b = cfg->blocks[b].idom;
+    }
+    return a;
+}
+
+// Cooper, Harvey & Kennedy, "A Simple, Fast Dominance Algorithm"
+static void compute_dominators(CFG *cfg) {
+    cfg->blocks[0].idom = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < cfg->rpo_count; i++) {
+            size_t b = cfg->rpo[i];
+            BasicBlock *block = &cfg->blocks[b];
+            size_t new_idom = CFG_NONE;
+            for (size_t p = 0; p < block->pred_count; p++) {
+                size_t pred = block->preds[p];
+                if (cfg->blocks[pred].idom == CFG_NONE) continue;
+                new_idom = (new_idom == CFG_NONE) ? pred : intersect(cfg, pred, new_idom);
+            }
+            if (new_idom != block->idom) {
+                block->idom = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    // Number the dominator tree so cfg_dominates is two comparisons
+    size_t count = cfg->block_count;
+    size_t *child_start = calloc(count + 1, sizeof(size_t));
+    size_t *children = malloc(count * sizeof(size_t));
+    for (size_t i = 1; i < cfg->rpo_count; i++) {
+        child_start[cfg->blocks[cfg->rpo[i]].idom + 1]++;
+    }
+    for (size_t b = 0; b < count; b++) child_start[b + 1] += child_start[b];
+    size_t *fill = malloc(count * sizeof(size_t));
+    memcpy(fill, child_start, count * sizeof(size_t));
+    for (size_t i = 1; i < cfg->rpo_count; i++) {
+        size_t b = cfg->rpo[i];
+        children[fill[cfg->blocks[b].idom]++] = b;
+    }
+
+    size_t *stack = malloc(count * sizeof(size_t));
+    size_t *next_child = calloc(count, sizeof(size_t));
+    size_t depth = 0;
+    size_t clock = 0;
+    stack[depth++] = 0;
+    cfg->blocks[0].dom_pre = clock++;
+    while (depth > 0) {
+        size_t b = stack[depth - 1];
+        size_t c = child_start[b] + next_child[b];
+        if (c < child_start[b + 1]) {
+            next_child[b]++;
+            size_t child = children[c];
+            cfg->blocks[child].dom_pre = clock++;
+            stack[depth++] = child;
+        } else {
+            cfg->blocks[b].dom_post = clock++;
+            depth--;
+        }
+    }
+
+    free(child_start);
+    free(children);
+    free(fill);
+    free(stack);
+    free(next_child);
+}
+
+bool cfg_reachable(const CFG *cfg, size_t block) {
+    return block < cfg->block_count && cfg->blocks[block].rpo_index != CFG_NONE;
+}
+
+bool cfg_dominates(const CFG *cfg, size_t a, size_t b) {
+    if (!cfg_reachable(cfg, a) || !cfg_reachable(cfg, b)) return false;
+    return cfg->blocks[a].dom_pre <= cfg->blocks[b].dom_pre &&
+           cfg->blocks[b].dom_post <= cfg->blocks[a].dom_post;
+}
+
+bool cfg_loop_contains(const CFG *cfg, size_t loop, size_t block) {
+    if (loop >= cfg->loop_count) return false;
+    const CFGLoop *l = &cfg->loops[loop];
+    size_t lo = 0, hi = l->block_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (l->blocks[mid] == block) return true;
+        if (l->blocks[mid] < block) lo = mid + 1;
+        else hi = mid;
+    }
+    return false;
+}
+
+size_t cfg_loop_of_header(const CFG *cfg, size_t block) {
+    for (size_t l = 0; l < cfg->loop_count; l++) {
+        if (cfg->loops[l].header == block) return l;
+    }
+    return CFG_NONE;
+}
+
+static int compare_size(const void *a, const void *b) {
+    size_t x = *(const size_t *)a, y = *(const size_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_loops(const void *a, const void *b) {
+    const CFGLoop *x = a, *y = b;
+    if (x->block_count != y->block_count) return x->block_count < y->block_count ? 1 : -1;
+    return (x->header > y->header) - (x->header < y->header);
+}
+
+// One natural loop per header that is the target of a back edge (an
+// edge whose target dominates its source)
+static void find_loops(CFG *cfg) {
+    size_t count = cfg->block_count;
+    size_t capacity = 4;
+    cfg->loops = malloc(capacity * sizeof(CFGLoop));
+    cfg->loop_count = 0;
+
+    bool *in_loop = calloc(count, sizeof(bool));
+    size_t *worklist = malloc(count * sizeof(size_t));
+
+    for (size_t i = 0; i < cfg->rpo_count; i++) {
+        size_t header = cfg->rpo[i];
+        BasicBlock *hb = &cfg->blocks[header];
+
+        size_t latch_count = 0;
+        for (size_t p = 0; p < hb->pred_count; p++) {
+            if (cfg_dominates(cfg, header, hb->preds[p])) latch_count++;
+        }
+        if (latch_count == 0) continue;
+
+        CFGLoop loop = {0};
+        loop.header = header;
+        loop.parent = CFG_NONE;
+        loop.latches = malloc(latch_count * sizeof(size_t));
+
+        memset(in_loop, 0, count * sizeof(bool));
+        in_loop[header] = true;
+        size_t member_count = 1;
+        size_t top = 0;
+        for (size_t p = 0; p < hb->pred_count; p++) {
+            size_t pred = hb->preds[p];
+            if (!cfg_dominates(cfg, header, pred)) continue;
+            loop.latches[loop.latch_count++] = pred;
+            if (!in_loop[pred]) {
+                in_loop[pred] = true;
+                member_count++;
+                worklist[top++] = pred;
+            }
+        }
+        while (top > 0) {
+            BasicBlock *block = &cfg->blocks[worklist[--top]];
+            for (size_t p = 0; p < block->pred_count; p++) {
+                size_t pred = block->preds[p];
+                if (in_loop[pred] || !cfg_reachable(cfg, pred)) continue;
+                in_loop[pred] = true;
+                member_count++;
+                worklist[top++] = pred;
+            }
+        }
+
+        loop.blocks = malloc(member_count * sizeof(size_t));
+        for (size_t b = 0; b < count; b++) {
+            if (in_loop[b]) loop.blocks[loop.block_count++] = b;
+        }
+        qsort(loop.latches, loop.latch_count, sizeof(size_t), compare_size);
+
+        if (cfg->loop_count == capacity) {
+            capacity *= 2;
+            cfg->loops = realloc(cfg->loops, capacity * sizeof(CFGLoop));
+        }
+        cfg->loops[cfg->loop_count++] = loop;
+    }
+
+    free(in_loop);
+    free(worklist);
+
+    // Loops with distinct headers are nested or disjoint, so ordering by
+    // size puts every loop after all the loops that enclose it
+    qsort(cfg->loops, cfg->loop_count, sizeof(CFGLoop), compare_loops);
+    for (size_t l = 0; l < cfg->loop_count; l++) {
+        CFGLoop *loop = &cfg->loops[l];
+        for (size_t outer = l; outer-- > 0;) {
+            if (cfg_loop_contains(cfg, outer, loop->header)) {
+                loop->parent = outer;
+                break;
+            }
+        }
+        loop->depth = (loop->parent == CFG_NONE) ? 1 : cfg->loops[loop->parent].depth + 1;
+        for (size_t b = 0; b < loop->block_count; b++) {
+            cfg->blocks[loop->blocks[b]].loop = l;
+        }
+    }
+}
+
+CFG *cfg_build(IRFunction *func) {
+    if (!func) return NULL;
+    CFG *cfg = calloc(1, sizeof(CFG));
+    cfg->func = func;
+    find_blocks(cfg);
+    link_blocks(cfg);
+    compute_rpo(cfg);
+    compute_dominators(cfg);
+    find_loops(cfg);
+    return cfg;
+}
+
+void cfg_free(CFG *cfg) {
+    if (!cfg) return;
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        free(cfg->blocks[b].succs);
+        free(cfg->blocks[b].preds);
+    }
+    for (size_t l = 0; l < cfg->loop_count; l++) {
+        free(cfg->loops[l].blocks);
+        free(cfg->loops[l].latches);
+    }
+    free(cfg->blocks);
+    free(cfg->block_of);
+    free(cfg->rpo);
+    free(cfg->loops);
+    free(cfg->labels);
+    free(cfg);
+}
@@ -2,19 +2,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <dirent.h>
 #include "../include/codegen.h"
 #include "../include/irgen.h"
 #include "../include/compiler.h"
 #include "../include/loop_transform.h"
+#include "../include/passes.h"
+#include "../include/util.h"
+#include "../include/intern.h"
 
 struct CodeGenerator {
     FILE *output;
     int indent_level;
     Project *project;
+    size_t lowered_modules;     // irgen_generate calls made by codegen_generate_c
+    const CFG *cfg;             // CFG of the function being emitted
 };
 
 // Forward declarations
-static char *type_to_c_string(Type *type);
 static void gen_instruction(CodeGenerator *gen, IRFunction *func, IRInstruction *instr);
 static void collect_slice_types(Type *type, Type ***slice_types, size_t *count, size_t *capacity);
 static void emit_slice_struct(FILE *output, Type *slice_type);
@@ -25,6 +31,8 @@ CodeGenerator *codegen_create(void) {
     gen->output = NULL;
     gen->indent_level = 0;
     gen->project = NULL;
+    gen->lowered_modules = 0;
+    gen->cfg = NULL;
     return gen;
 }
 
@@ -32,6 +40,10 @@ void codegen_free(CodeGenerator *gen) {
     free(gen);
 }
 
+size_t codegen_lowered_modules(CodeGenerator *gen) {
+    return gen->lowered_modules;
+}
+
 // Helper: Print indentation
 // Helper: Escape special characters in strings for C output
 static void print_escaped_string(FILE *output, const char *str) {
@@ -49,6 +61,15 @@ static void print_escaped_string(FILE *output, const char *str) {
     fprintf(output, "\"");
 }
 
+// Print a double literal that reads back as the same value and stays a
+// floating point constant in C ("2.0", not "2")
+static void print_float(FILE *output, double value) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.17g", value);
+    fprintf(output, "%s", buffer);
+    if (!strpbrk(buffer, ".eEin")) fprintf(output, ".0");
+}
+
 static void print_indent(CodeGenerator *gen) {
     for (int i = 0; i < gen->indent_level; i++) {
         fprintf(gen->output, "    ");
@@ -92,13 +113,13 @@ static void gen_operand(CodeGenerator *gen, IROperand *op) {
             fprintf(gen->output, "%s", op->data.label_name);
             break;
         case IR_OP_FLOAT:
-            fprintf(gen->output, "%g", op->data.float_value);
+            print_float(gen->output, op->data.float_value);
             break;
     }
 }
 
-// Helper: Get operand type string
-static char *get_op_type(CodeGenerator *gen, IROperand *op, IRFunction *func) {
+// Helper: Get operand type
+static const IRType *get_op_type(CodeGenerator *gen, IROperand *op, IRFunction *func) {
     if (!op) return NULL;
     if (op->kind == IR_OP_TEMP) {
         if (func && (size_t)op->data.temp_id < func->temp_count && func->temp_types) {
@@ -122,23 +143,23 @@ static char *get_op_type(CodeGenerator *gen, IROperand *op, IRFunction *func) {
     return NULL;
 }
 
-// Helper: Get destination type string
-static char *get_dest_type(CodeGenerator *gen, IROperand *dest, IRFunction *func) {
-    char *type = get_op_type(gen, dest, func);
-    if (type) return strdup(type);
-    return strdup("long");
+// Helper: Get destination type
+static const IRType *get_dest_type(CodeGenerator *gen, IROperand *dest, IRFunction *func) {
+    const IRType *type = get_op_type(gen, dest, func);
+    return type ? type : ir_type_long();
 }
 
 static ASTDecl *find_function_decl(Project *project, const char *name) {
     if (!project || !name) return NULL;
     
-    // 1. Try exact match
-    for (size_t m_idx = 0; m_idx < project->module_count; m_idx++) {
+    // 1. Try exact match (declaration names are interned)
+    const char *key = intern_find(name);
+    for (size_t m_idx = 0; key && m_idx < project->module_count; m_idx++) {
         Module *m = project->modules[m_idx];
         if (!m->ast) continue;
         for (size_t i = 0; i < m->ast->decl_count; i++) {
             ASTDecl *decl = m->ast->declarations[i];
-            if (decl->type == AST_FUNCTION_DECL && strcmp(decl->data.function.name, name) == 0) {
+            if (decl->type == AST_FUNCTION_DECL && decl->data.function.name == key) {
                 return decl;
             }
         }
@@ -149,17 +170,17 @@ static ASTDecl *find_function_decl(Project *project, const char *name) {
     char *sep = strstr(dup, "__");
     if (sep) {
         *sep = '\0';
-        char *mod_name = dup;
-        char *func_name = sep + 2;
+        const char *mod_name = intern_find(dup);
+        const char *func_name = intern_find(sep + 2);
         
-        for (size_t m_idx = 0; m_idx < project->module_count; m_idx++) {
+        for (size_t m_idx = 0; mod_name && func_name && m_idx < project->module_count; m_idx++) {
             Module *m = project->modules[m_idx];
             // Check if module name matches (might need sanitization check)
-            if (m->name && strcmp(m->name, mod_name) == 0) {
+            if (m->name == mod_name) {
                 if (m->ast) {
                     for (size_t i = 0; i < m->ast->decl_count; i++) {
                         ASTDecl *decl = m->ast->declarations[i];
-                        if (decl->type == AST_FUNCTION_DECL && strcmp(decl->data.function.name, func_name) == 0) {
+                        if (decl->type == AST_FUNCTION_DECL && decl->data.function.name == func_name) {
                             free(dup);
                             return decl;
                         }
@@ -172,6 +193,75 @@ static ASTDecl *find_function_decl(Project *project, const char *name) {
     return NULL;
 }
 
+// Cases at least this many, covering a range without holes, dispatch
+// through a table of label addresses instead of a C switch
+#define SWITCH_TABLE_MIN_CASES 4
+
+static int compare_switch_cases(const void *a, const void *b) {
+    long x = (**(IROperand **const *)a)->data.const_value;
+    long y = (**(IROperand **const *)b)->data.const_value;
+    return (x > y) - (x < y);
+}
+
+// Helper: Generate IR_SWITCH, the current line already indented
+static void gen_switch(CodeGenerator *gen, IRInstruction *instr) {
+    // Case slots sorted by constant; each label follows in the next slot
+    size_t count = instr->arg_count / 2;
+    IROperand ***cases = malloc((count + 1) * sizeof(IROperand**));
+    for (size_t c = 0; c < count; c++) cases[c] = &instr->args[c * 2];
+    qsort(cases, count, sizeof(IROperand**), compare_switch_cases);
+    
+    long low = count ? (*cases[0])->data.const_value : 0;
+    bool dense = count >= SWITCH_TABLE_MIN_CASES &&
+                 (unsigned long)((*cases[count - 1])->data.const_value - low) == count - 1;
+    
+    if (dense) {
+        fprintf(gen->output, "{\n");
+        gen->indent_level++;
+        print_indent(gen);
+        fprintf(gen->output, "static void *const table[%zu] = {", count);
+        for (size_t c = 0; c < count; c++) {
+            fprintf(gen->output, "%s&&", c ? ", " : " ");
+            gen_operand(gen, cases[c][1]);
+        }
+        fprintf(gen->output, " };\n");
+        print_indent(gen);
+        fprintf(gen->output, "unsigned long long index = (unsigned long long)((long long)");
+        gen_operand(gen, instr->src1);
+        fprintf(gen->output, " - %ldLL);\n", low);
+        print_indent(gen);
+        fprintf(gen->output, "if (index < %zuULL) goto *table[index];\n", count);
+        print_indent(gen);
+        fprintf(gen->output, "goto ");
+        gen_operand(gen, instr->src2);
+        fprintf(gen->output, ";\n");
+        gen->indent_level--;
+        print_indent(gen);
+        fprintf(gen->output, "}\n");
+        free(cases);
+        return;
+    }
+    
+    fprintf(gen->output, "switch (");
+    gen_operand(gen, instr->src1);
+    fprintf(gen->output, ") {\n");
+    gen->indent_level++;
+    for (size_t a = 0; a + 1 < instr->arg_count; a += 2) {
+        print_indent(gen);
+        fprintf(gen->output, "case %ld: goto ", instr->args[a]->data.const_value);
+        gen_operand(gen, instr->args[a + 1]);
+        fprintf(gen->output, ";\n");
+    }
+    print_indent(gen);
+    fprintf(gen->output, "default: goto ");
+    gen_operand(gen, instr->src2);
+    fprintf(gen->output, ";\n");
+    gen->indent_level--;
+    print_indent(gen);
+    fprintf(gen->output, "}\n");
+    free(cases);
+}
+
 // Helper: Generate instruction
 static void gen_instruction(CodeGenerator *gen, IRFunction *func, IRInstruction *instr) {
     if (!instr) return;
@@ -190,10 +280,10 @@ static void gen_instruction(CodeGenerator *gen, IRFunction *func, IRInstruction
     
     switch (instr->opcode) {
         case IR_ADD: {
-            char *d_type = get_dest_type(gen, instr->dest, func);
+            const IRType *d_type = get_dest_type(gen, instr->dest, func);
             gen_operand(gen, instr->dest);
             // Only cast to (long) if it's actually long
-            if (strcmp(d_type, "long") == 0) {
+            if (d_type == ir_type_long()) {
                 fprintf(gen->output, " = (long)(");
             } else {
                 fprintf(gen->output, " = (");
@@ -202,7 +292,6 @@ static void gen_instruction(CodeGenerator *gen, IRFunction *func, IRInstruction
             fprintf(gen->output, " + ");
             gen_operand(gen, instr->src2);
             fprintf(gen->output, ");\n");
-            free(d_type);
             break;
         }
             
@@ -329,42 +418,39 @@ static void gen_instruction(CodeGenerator *gen, IRFunction *func, IRInstruction
             break;
             
         case IR_ADDR: {
-            char *d_type = get_dest_type(gen, instr->dest, func);
+            const IRType *d_type = get_dest_type(gen, instr->dest, func);
             gen_operand(gen, instr->dest);
-            fprintf(gen->output, " = (%s)&", d_type);
+            fprintf(gen->output, " = (%s)&", d_type->c_name);
             gen_operand(gen, instr->src1);
             fprintf(gen->output, ";\n");
-            free(d_type);
             break;
         }
             
         case IR_DEREF: {
-            char *d_type = get_dest_type(gen, instr->dest, func);
+            const IRType *d_type = get_dest_type(gen, instr->dest, func);
             gen_operand(gen, instr->dest);
-            fprintf(gen->output, " = *(%s*)", d_type);
+            fprintf(gen->output, " = *(%s*)", d_type->c_name);
             gen_operand(gen, instr->src1);
             fprintf(gen->output, ";\n");
-            free(d_type);
             break;
         }
 
         case IR_CAST: {
-            char *d_type = get_dest_type(gen, instr->dest, func);
-            char *s_type = get_op_type(gen, instr->src1, func);
-            bool src_is_slice = (instr->src1->kind == IR_OP_STRING) || (s_type && strstr(s_type, "Slice") != NULL);
-            bool dest_is_ptr = (strstr(d_type, "*") != NULL) || (strcmp(d_type, "const char*") == 0);
+            const IRType *d_type = get_dest_type(gen, instr->dest, func);
+            const IRType *s_type = get_op_type(gen, instr->src1, func);
+            bool src_is_slice = (instr->src1->kind == IR_OP_STRING) || (s_type && s_type->kind == IR_TYPE_SLICE);
+            bool dest_is_ptr = d_type->kind == IR_TYPE_POINTER;
 
             gen_operand(gen, instr->dest);
             if (src_is_slice && dest_is_ptr) {
-                fprintf(gen->output, " = (%s)(", d_type);
+                fprintf(gen->output, " = (%s)(", d_type->c_name);
                 gen_operand(gen, instr->src1);
                 fprintf(gen->output, ").data;\n");
             } else {
-                fprintf(gen->output, " = (%s)", d_type);
+                fprintf(gen->output, " = (%s)", d_type->c_name);
                 gen_operand(gen, instr->src1);
                 fprintf(gen->output, ";\n");
             }
-            free(d_type);
             break;
         }
             
@@ -407,10 +493,14 @@ static void gen_instruction(CodeGenerator *gen, IRFunction *func, IRInstruction
             fprintf(gen->output, ";\n");
             break;
             
+        case IR_SWITCH:
+            gen_switch(gen, instr);
+            break;
+            
         case IR_FAIL:
             if (instr->src1) {
-                char *type = get_op_type(gen, instr->src1, func);
-                bool is_slice = (instr->src1->kind == IR_OP_STRING) || (type && strstr(type, "Slice") != NULL);
+                const IRType *type = get_op_type(gen, instr->src1, func);
+                bool is_slice = (instr->src1->kind == IR_OP_STRING) || (type && type->kind == IR_TYPE_SLICE);
                 
                 if (is_slice) {
                     fprintf(gen->output, "fprintf(stderr, \"Error: %%s\\n\", (char*)(");
@@ -429,10 +519,9 @@ static void gen_instruction(CodeGenerator *gen, IRFunction *func, IRInstruction
             
         case IR_CALL: {
             if (instr->dest) {
-                char *d_type = get_dest_type(gen, instr->dest, func);
+                const IRType *d_type = get_dest_type(gen, instr->dest, func);
                 gen_operand(gen, instr->dest);
-                fprintf(gen->output, " = (%s)", d_type);
-                free(d_type);
+                fprintf(gen->output, " = (%s)", d_type->c_name);
             }
             
             // Try to find the function declaration to get parameter types
@@ -448,10 +537,10 @@ static void gen_instruction(CodeGenerator *gen, IRFunction *func, IRInstruction
                     if (i > 0) fprintf(gen->output, ", ");
                     
                     if (callee_decl && i < callee_decl->data.function.param_count) {
-                        char *p_type = type_to_c_string(callee_decl->data.function.params[i].param_type);
-                        char *arg_type = get_op_type(gen, instr->args[i], func);
+                        char *p_type = util_type_to_c_string(callee_decl->data.function.params[i].param_type);
+                        const IRType *arg_type = get_op_type(gen, instr->args[i], func);
                         bool is_ptr = (strstr(p_type, "*") != NULL);
-                        bool arg_is_slice = (instr->args[i]->kind == IR_OP_STRING) || (arg_type && strstr(arg_type, "Slice") != NULL);
+                        bool arg_is_slice = (instr->args[i]->kind == IR_OP_STRING) || (arg_type && arg_type->kind == IR_TYPE_SLICE);
                         
                         if (is_ptr && arg_is_slice) {
                             fprintf(gen->output, "(%s)(", p_type);
@@ -493,20 +582,20 @@ static void gen_instruction(CodeGenerator *gen, IRFunction *func, IRInstruction
 // Generate function
 static void gen_function(CodeGenerator *gen, IRFunction *func) {
     // Function signature
-    const char *ret_type = (func->return_type && func->return_type[0]) ? func->return_type : "long";
-    fprintf(gen->output, "%s %s(", ret_type, func->name);
+    const IRType *ret_type = func->return_type ? func->return_type : ir_type_long();
+    fprintf(gen->output, "%s %s(", ret_type->c_name, func->name);
     
     // Parameters (add restrict for pointer types to enable better optimization)
     for (size_t i = 0; i < func->param_count; i++) {
         if (i > 0) fprintf(gen->output, ", ");
         if (func->param_types && func->param_types[i]) {
-            const char *type = func->param_types[i];
+            const IRType *type = func->param_types[i];
             // Add restrict keyword for pointer types
-            if (strstr(type, "*") != NULL) {
+            if (type->kind == IR_TYPE_POINTER) {
                 // For pointers, it's easier to just print it
-                fprintf(gen->output, "%s restrict %s", type, func->params[i]);
+                fprintf(gen->output, "%s restrict %s", type->c_name, func->params[i]);
             } else {
-                print_decl(gen->output, type, func->params[i]);
+                print_decl(gen->output, type->c_name, func->params[i]);
             }
         } else {
             fprintf(gen->output, "long %s", func->params[i]);
@@ -520,10 +609,10 @@ static void gen_function(CodeGenerator *gen, IRFunction *func) {
     if (func->temp_count > 0) {
         for (size_t i = 0; i < func->temp_count; i++) {
             print_indent(gen);
-            const char *type = (func->temp_types && func->temp_types[i]) ? func->temp_types[i] : "long";
+            const IRType *type = (func->temp_types && func->temp_types[i]) ? func->temp_types[i] : ir_type_long();
             char name[32];
             snprintf(name, 32, "t%zu", i);
-            print_decl(gen->output, type, name);
+            print_decl(gen->output, type->c_name, name);
             fprintf(gen->output, ";\n");
         }
     }
@@ -533,7 +622,7 @@ static void gen_function(CodeGenerator *gen, IRFunction *func) {
         for (size_t i = 0; i < func->local_var_count; i++) {
              print_indent(gen);
              if (func->local_var_types && func->local_var_types[i]) {
-                 print_decl(gen->output, func->local_var_types[i], func->local_vars[i]);
+                 print_decl(gen->output, func->local_var_types[i]->c_name, func->local_vars[i]);
                  fprintf(gen->output, ";\n");
              } else {
                  fprintf(gen->output, "long %s;\n", func->local_vars[i]);
@@ -542,9 +631,11 @@ static void gen_function(CodeGenerator *gen, IRFunction *func) {
     }
     
     // Generate instructions
+    CFG *cfg = cfg_build(func);
+    gen->cfg = cfg;
     for (size_t i = 0; i < func->instruction_count; i++) {
         // Try to detect a simple loop starting here
-        LoopInfo loop_info = detect_simple_loop(func, i);
+        LoopInfo loop_info = detect_simple_loop(func, cfg, i);
         if (loop_info.is_simple_loop) {
             gen_for_loop(gen, func, &loop_info);
             i = loop_info.loop_end_idx; // Skip to end of loop
@@ -553,91 +644,13 @@ static void gen_function(CodeGenerator *gen, IRFunction *func) {
         
         gen_instruction(gen, func, func->instructions[i]);
     }
+    gen->cfg = NULL;
+    cfg_free(cfg);
     
     gen->indent_level--;
     fprintf(gen->output, "}\n\n");
 }
 
-// Convert Virex type to C type string
-static char *type_to_c_string(Type *type) {
-    if (!type) return strdup("void");
-    
-    switch (type->kind) {
-        case TYPE_PRIMITIVE:
-            switch (type->data.primitive) {
-                case TOKEN_I8: return strdup("int8_t");
-                case TOKEN_U8: return strdup("uint8_t");
-                case TOKEN_I16: return strdup("int16_t");
-                case TOKEN_U16: return strdup("uint16_t");
-                case TOKEN_I32: return strdup("int32_t");
-                case TOKEN_U32: return strdup("uint32_t");
-                case TOKEN_I64: return strdup("long long");
-                case TOKEN_U64: return strdup("uint64_t");
-                case TOKEN_F32: return strdup("float");
-                case TOKEN_F64: return strdup("double");
-                case TOKEN_BOOL: return strdup("int");
-                case TOKEN_VOID: return strdup("void");
-                default: return strdup("long");
-            }
-        case TYPE_POINTER: {
-            char *base = type_to_c_string(type->data.pointer.base);
-            char *result = malloc(strlen(base) + 2);
-            sprintf(result, "%s*", base);
-            free(base);
-            return result;
-        }
-        case TYPE_ARRAY: {
-            char *elem = type_to_c_string(type->data.array.element);
-            char buf[256];
-            snprintf(buf, 256, "%s[%zu]", elem, type->data.array.size);
-            free(elem);
-            return strdup(buf);
-        }
-        case TYPE_SLICE: {
-            // Generate slice struct name: Slice_ElementType
-            char *elem_str = type_to_c_string(type->data.slice.element);
-            // Remove spaces and special chars from element type for struct name
-            char *clean_elem = malloc(strlen(elem_str) + 1);
-            size_t j = 0;
-            for (size_t i = 0; elem_str[i]; i++) {
-                if (elem_str[i] != ' ' && elem_str[i] != '*') {
-                    clean_elem[j++] = elem_str[i];
-                }
-            }
-            clean_elem[j] = '\0';
-            
-            char buf[256];
-            snprintf(buf, 256, "struct Slice_%s", clean_elem);
-            free(elem_str);
-            free(clean_elem);
-            return strdup(buf);
-        }
-        case TYPE_STRUCT: {
-            // If it's a single uppercase letter, it's likely a type parameter
-            // and we don't have monomorphization yet, so treat as uint8_t
-            if (type->data.struct_enum.name && 
-                strlen(type->data.struct_enum.name) == 1 && 
-                type->data.struct_enum.name[0] >= 'A' && type->data.struct_enum.name[0] <= 'Z') {
-                return strdup("uint8_t");
-            }
-            char buf[256];
-            snprintf(buf, 256, "struct %s", type->data.struct_enum.name ? type->data.struct_enum.name : "unknown");
-            return strdup(buf);
-        }
-        case TYPE_ENUM: {
-            char buf[256];
-            snprintf(buf, 256, "enum %s", type->data.struct_enum.name ? type->data.struct_enum.name : "unknown");
-            return strdup(buf);
-        }
-        case TYPE_RESULT:
-            return strdup("struct Result*");
-        case TYPE_FUNCTION:
-            return strdup("void*");
-        default:
-            return strdup("long");
-    }
-}
-
 // Collect all slice types used in a type (recursive)
 static void collect_slice_types(Type *type, Type ***slice_types, size_t *count, size_t *capacity) {
     if (!type) return;
@@ -646,8 +659,8 @@ static void collect_slice_types(Type *type, Type ***slice_types, size_t *count,
         // Check if already collected (simple duplicate check)
         for (size_t i = 0; i < *count; i++) {
             // Simple comparison - just check element type kind
-            char *s1 = type_to_c_string(type->data.slice.element);
-            char *s2 = type_to_c_string((*slice_types)[i]->data.slice.element);
+            char *s1 = util_type_to_c_string(type->data.slice.element);
+            char *s2 = util_type_to_c_string((*slice_types)[i]->data.slice.element);
             int cmp = strcmp(s1, s2);
             free(s1);
             free(s2);
@@ -672,8 +685,8 @@ static void collect_slice_types(Type *type, Type ***slice_types, size_t *count,
 
 // Emit slice struct definition
 static void emit_slice_struct(FILE *output, Type *slice_type) {
-    char *elem_c_type = type_to_c_string(slice_type->data.slice.element);
-    char *slice_c_type = type_to_c_string(slice_type);
+    char *elem_c_type = util_type_to_c_string(slice_type->data.slice.element);
+    char *slice_c_type = util_type_to_c_string(slice_type);
     
     // Check if struct name slice_c_type starts with "struct "
     char *struct_name = slice_c_type;
@@ -704,11 +717,11 @@ static void gen_struct_decl(CodeGenerator *gen, ASTDecl *decl) {
         
         if (field_type->kind == TYPE_ARRAY) {
             // Handle array field: Type name[Size];
-            char *elem_type_str = type_to_c_string(field_type->data.array.element);
+            char *elem_type_str = util_type_to_c_string(field_type->data.array.element);
             fprintf(gen->output, "%s %s[%zu];\n", elem_type_str, decl->data.struct_decl.fields[i].name, field_type->data.array.size);
             free(elem_type_str);
         } else {
-            char *type_str = type_to_c_string(field_type);
+            char *type_str = util_type_to_c_string(field_type);
             fprintf(gen->output, "%s %s;\n", type_str, decl->data.struct_decl.fields[i].name);
             free(type_str);
         }
@@ -775,31 +788,67 @@ static void collect_slice_types_from_stmt(ASTStmt *stmt, Type ***types, size_t *
     }
 }
 
-// Main code generation function
-void codegen_generate_c(CodeGenerator *gen, Project *project, FILE *output) {
-    if (!gen || !project || !output) return;
-    
+// Shared header: every type, runtime declaration, global and prototype,
+// so each module's unit can be compiled on its own
+// Tagged structs for every result<T, E> instantiation irgen recorded, in
+// the order it recorded them so payload results are defined first. Void
+// sides get no union member.
+static void emit_result_structs(FILE *output, IRModule **ir_modules, size_t module_count) {
+    for (size_t m_idx = 0; m_idx < module_count; m_idx++) {
+        IRModule *module = ir_modules[m_idx];
+        if (!module) continue;
+        for (size_t i = 0; i < module->result_type_count; i++) {
+            IRResultType *result = &module->result_types[i];
+            
+            bool seen = false;
+            for (size_t prev = 0; prev <= m_idx && !seen; prev++) {
+                IRModule *other = ir_modules[prev];
+                if (!other) continue;
+                size_t limit = prev == m_idx ? i : other->result_type_count;
+                for (size_t j = 0; j < limit; j++) {
+                    if (strcmp(other->result_types[j].c_type, result->c_type) == 0) {
+                        seen = true;
+                        break;
+                    }
+                }
+            }
+            if (seen) continue;
+            
+            bool has_ok = strcmp(result->ok_type, "void") != 0;
+            bool has_err = strcmp(result->err_type, "void") != 0;
+            fprintf(output, "%s {\n", result->c_type);
+            fprintf(output, "    int is_ok;\n");
+            if (has_ok || has_err) {
+                fprintf(output, "    union {\n");
+                if (has_ok) {
+                    fprintf(output, "        ");
+                    print_decl(output, result->ok_type, "ok");
+                    fprintf(output, ";\n");
+                }
+                if (has_err) {
+                    fprintf(output, "        ");
+                    print_decl(output, result->err_type, "err");
+                    fprintf(output, ";\n");
+                }
+                fprintf(output, "    } as;\n");
+            }
+            fprintf(output, "};\n\n");
+        }
+    }
+}
+
+static void emit_header(CodeGenerator *gen, Project *project, IRModule **ir_modules, FILE *output) {
     gen->output = output;
-    gen->indent_level = 0;
-    gen->project = project;
     
     // Header
     fprintf(output, "/* Generated by Virex Compiler */\n");
+    fprintf(output, "#ifndef VIREX_OUT_H\n");
+    fprintf(output, "#define VIREX_OUT_H\n\n");
     fprintf(gen->output, "#include <stdio.h>\n");
     fprintf(gen->output, "#include <stdlib.h>\n");
     fprintf(gen->output, "#include <string.h>\n");
     fprintf(gen->output, "#include <stdint.h>\n\n");
     
-    // Result type definition
-    fprintf(output, "// Result type\n");
-    fprintf(output, "struct Result {\n");
-    fprintf(output, "    long is_ok;\n"); // 1 for ok, 0 for err
-    fprintf(output, "    union {\n");
-    fprintf(output, "        long ok_val;\n"); // Simplified: all values treated as long
-    fprintf(output, "        long err_val;\n");
-    fprintf(output, "    } data;\n");
-    fprintf(output, "};\n\n");
-    
     // Collect and emit slice struct definitions
     Type **slice_types = NULL;
     size_t slice_count = 0;
@@ -873,11 +922,6 @@ void codegen_generate_c(CodeGenerator *gen, Project *project, FILE *output) {
                         continue;
                     }
                     
-                    // 3. Skip built-in types that are handled manually
-                    if (strcmp(sym->name, "Result") == 0) {
-                        continue;
-                    }
-
                     if (sym->type->kind == TYPE_STRUCT) {
                         // Emit struct
                         if (sym->is_packed) {
@@ -888,7 +932,7 @@ void codegen_generate_c(CodeGenerator *gen, Project *project, FILE *output) {
                         gen->indent_level++;
                         for (size_t j = 0; j < sym->field_count; j++) {
                             print_indent(gen);
-                            char *type_str = type_to_c_string(sym->fields[j].type);
+                            char *type_str = util_type_to_c_string(sym->fields[j].type);
                             print_decl(output, type_str, sym->fields[j].name);
                             fprintf(output, ";\n");
                             free(type_str);
@@ -915,6 +959,7 @@ void codegen_generate_c(CodeGenerator *gen, Project *project, FILE *output) {
             }
         }
     }
+    emit_result_structs(output, ir_modules, project->module_count);
     fprintf(output, "\n");
     
     // Runtime library declarations
@@ -931,8 +976,6 @@ void codegen_generate_c(CodeGenerator *gen, Project *project, FILE *output) {
     fprintf(output, "void virex_print_f64(double value);\n");
     fprintf(output, "void virex_exit(int code);\n");
     fprintf(output, "void virex_init_args(int argc, char** argv);\n");
-    fprintf(output, "void virex_slice_bounds_check(long long index, long long len);\n");
-    fprintf(output, "void virex_slice_range_check(long long start, long long end, long long cap);\n");
     // Math helpers
     fprintf(output, "double virex_math_sqrt(double x);\n");
     fprintf(output, "double virex_math_pow(double x, double y);\n");
@@ -944,48 +987,27 @@ void codegen_generate_c(CodeGenerator *gen, Project *project, FILE *output) {
     fprintf(output, "double virex_math_fabs(double x);\n");
     fprintf(output, "double virex_math_floor(double x);\n");
     fprintf(output, "double virex_math_ceil(double x);\n");
-    // Result helpers
-    fprintf(output, "long virex_result_ok(long val) {\n");
-    fprintf(output, "    struct Result* res = malloc(sizeof(struct Result));\n");
-    fprintf(output, "    res->is_ok = 1;\n");
-    fprintf(output, "    res->data.ok_val = val;\n");
-    fprintf(output, "    return (long)res;\n");
-    fprintf(output, "}\n");
-    fprintf(output, "long virex_result_err(long val) {\n");
-    fprintf(output, "    struct Result* res = malloc(sizeof(struct Result));\n");
-    fprintf(output, "    res->is_ok = 0;\n");
-    fprintf(output, "    res->data.err_val = val;\n");
-    fprintf(output, "    return (long)res;\n");
-    fprintf(output, "}\n\n");
-    fprintf(output, "void virex_init_args(int argc, char** argv);\n");
-    
-    fprintf(output, "void virex_slice_bounds_check(long long index, long long len) {\n");
-    fprintf(output, "    if (index < 0 || index >= len) {\n");
-    fprintf(output, "        fprintf(stderr, \"panic: index out of bounds: index %%lld, len %%lld\\n\", index, len);\n");
-    fprintf(output, "        exit(134);\n");
+    // Helpers defined in the support unit
+    fprintf(output, "void* alloc(long long count);\n");
+    fprintf(output, "void copy(void* dst, const void* src, long long count);\n\n");
+
+    // Slice checks inline to a compare and an untaken branch. The failure
+    // path is one cold, noreturn function per unit, so hot loops carry no
+    // call and no panic code.
+    fprintf(output, "__attribute__((cold, noreturn, noinline, unused))\n");
+    fprintf(output, "static void virex_slice_panic(int range, long long a, long long b, long long c) {\n");
+    fprintf(output, "    if (range) {\n");
+    fprintf(output, "        fprintf(stderr, \"panic: slice bounds out of range: [%%lld:%%lld] capacity %%lld\\n\", a, b, c);\n");
+    fprintf(output, "    } else {\n");
+    fprintf(output, "        fprintf(stderr, \"panic: index out of bounds: index %%lld, len %%lld\\n\", a, b);\n");
     fprintf(output, "    }\n");
+    fprintf(output, "    exit(134);\n");
     fprintf(output, "}\n");
-    
-    fprintf(output, "void virex_slice_range_check(long long start, long long end, long long cap) {\n");
-    fprintf(output, "    if (start < 0 || end < start || end > cap) {\n");
-    fprintf(output, "        fprintf(stderr, \"panic: slice bounds out of range: [%%lld:%%lld] capacity %%lld\\n\", start, end, cap);\n");
-    fprintf(output, "        exit(134);\n");
-    fprintf(output, "    }\n");
-    fprintf(output, "}\n\n");
-    
-    fprintf(output, "void virex_print_slice_uint8_t(struct Slice_uint8_t s) {\n");
-    fprintf(output, "    if (s.data) {\n");
-    fprintf(output, "        fwrite(s.data, 1, s.len, stdout);\n");
-    fprintf(output, "    }\n");
-    fprintf(output, "}\n\n");
-    
-    // std::mem runtime implementations
-    fprintf(output, "void* alloc(long long count) {\n");
-    fprintf(output, "    return calloc(count, 1);\n");
-    fprintf(output, "}\n\n");
-    
-    fprintf(output, "void copy(void* dst, const void* src, long long count) {\n");
-    fprintf(output, "    memcpy(dst, src, count);\n");
+    fprintf(output, "static inline __attribute__((always_inline)) void virex_slice_bounds_check(long long index, long long len) {\n");
+    fprintf(output, "    if (__builtin_expect(index < 0 || index >= len, 0)) virex_slice_panic(0, index, len, 0);\n");
+    fprintf(output, "}\n");
+    fprintf(output, "static inline __attribute__((always_inline)) void virex_slice_range_check(long long start, long long end, long long cap) {\n");
+    fprintf(output, "    if (__builtin_expect(start < 0 || end < start || end > cap, 0)) virex_slice_panic(1, start, end, cap);\n");
     fprintf(output, "}\n\n");
     
     // Extern function declarations (collected from all modules)
@@ -1010,14 +1032,14 @@ void codegen_generate_c(CodeGenerator *gen, Project *project, FILE *output) {
                     
                     // For extern functions, we don't mangle names and use proper C types
                     // Generate return type
-                    char *ret_type_str = type_to_c_string(decl->data.function.return_type);
+                    char *ret_type_str = util_type_to_c_string(decl->data.function.return_type);
                     fprintf(output, "%s %s(", ret_type_str, decl->data.function.name);
                     free(ret_type_str);
                     
                     // Generate parameters
                     for (size_t j = 0; j < decl->data.function.param_count; j++) {
                         if (j > 0) fprintf(output, ", ");
-                        char *param_type_str = type_to_c_string(decl->data.function.params[j].param_type);
+                        char *param_type_str = util_type_to_c_string(decl->data.function.params[j].param_type);
                         fprintf(output, "%s", param_type_str);
                         free(param_type_str);
                     }
@@ -1035,60 +1057,205 @@ void codegen_generate_c(CodeGenerator *gen, Project *project, FILE *output) {
     }
     fprintf(output, "\n");
     
-    // Forward declarations (collected from all modules, mangled names)
-    // Global variables and Forward declarations
+    // Global variables and forward declarations (collected from all modules, mangled names)
     fprintf(output, "// Global variables and Forward declarations\n");
-    IRGenerator *irgen_decl = irgen_create();
     for (size_t m_idx = 0; m_idx < project->module_count; m_idx++) {
-        Module *m = project->modules[m_idx];
-        IRModule *ir_module = irgen_generate(irgen_decl, m->ast, m->name, m->symtable, m == project->main_module);
-        
+        IRModule *ir_module = ir_modules[m_idx];
         if (!ir_module) continue;
 
-        // Emit globals
+        // Globals are defined in their module's unit
         for (size_t i = 0; i < ir_module->global_count; i++) {
             IRGlobal *g = ir_module->globals[i];
-            // Use print_decl for globals to handle array types correctly
+            fprintf(output, "extern ");
             print_decl(output, g->c_type, g->name);
-            if (strchr(g->c_type, '[') == NULL) {
-                fprintf(output, " = %ld;\n", g->init_value);
-            } else {
-                fprintf(output, ";\n"); // Arrays can't be initialized with a single long value
-            }
+            fprintf(output, ";\n");
         }
         
         for (size_t i = 0; i < ir_module->function_count; i++) {
             IRFunction *f = ir_module->functions[i];
-            const char *ret_type = (f->return_type && f->return_type[0]) ? f->return_type : "long";
-            fprintf(output, "%s %s(", ret_type, f->name);
+            const IRType *ret_type = f->return_type ? f->return_type : ir_type_long();
+            fprintf(output, "%s %s(", ret_type->c_name, f->name);
             for (size_t j = 0; j < f->param_count; j++) {
                 if (j > 0) fprintf(output, ", ");
                 if (f->param_types && f->param_types[j]) {
-                    fprintf(output, "%s", f->param_types[j]);
+                    fprintf(output, "%s", f->param_types[j]->c_name);
                 } else {
                     fprintf(output, "long");
                 }
             }
             fprintf(output, ");\n");
         }
-        ir_module_free(ir_module);
     }
-    irgen_free(irgen_decl);
-    fprintf(output, "\n");
+    fprintf(output, "\n#endif // VIREX_OUT_H\n");
+}
+
+// Support unit: runtime helpers the generated program defines itself
+static void emit_support_unit(FILE *output) {
+    fprintf(output, "/* Generated by Virex Compiler */\n");
+    fprintf(output, "#include \"%s\"\n\n", CODEGEN_HEADER_NAME);
+    
+    fprintf(output, "void virex_print_slice_uint8_t(struct Slice_uint8_t s) {\n");
+    fprintf(output, "    if (s.data) {\n");
+    fprintf(output, "        fwrite(s.data, 1, s.len, stdout);\n");
+    fprintf(output, "    }\n");
+    fprintf(output, "}\n\n");
+    
+    // std::mem runtime implementations
+    fprintf(output, "void* alloc(long long count) {\n");
+    fprintf(output, "    return calloc(count, 1);\n");
+    fprintf(output, "}\n\n");
+    
+    fprintf(output, "void copy(void* dst, const void* src, long long count) {\n");
+    fprintf(output, "    memcpy(dst, src, count);\n");
+    fprintf(output, "}\n\n");
+}
+
+// Module unit: the module's globals and function bodies
+static void emit_module_unit(CodeGenerator *gen, Module *m, IRModule *ir_module, FILE *output) {
+    gen->output = output;
+    fprintf(output, "/* Generated by Virex Compiler */\n");
+    fprintf(output, "#include \"%s\"\n\n", CODEGEN_HEADER_NAME);
+    
+    for (size_t i = 0; i < ir_module->global_count; i++) {
+        IRGlobal *g = ir_module->globals[i];
+        // Use print_decl for globals to handle array types correctly
+        print_decl(output, g->c_type, g->name);
+        if (strchr(g->c_type, '[') == NULL) {
+            fprintf(output, " = %ld;\n", g->init_value);
+        } else {
+            fprintf(output, ";\n"); // Arrays can't be initialized with a single long value
+        }
+    }
+    if (ir_module->global_count > 0) fprintf(output, "\n");
     
-    // Generate actual functions
-    IRGenerator *irgen_body = irgen_create();
+    fprintf(output, "/* Module: %s */\n", m->name);
+    for (size_t i = 0; i < ir_module->function_count; i++) {
+        gen_function(gen, ir_module->functions[i]);
+    }
+}
+
+static char *unit_path(const char *dir, const char *file) {
+    size_t size = strlen(dir) + strlen(file) + 2;
+    char *path = malloc(size);
+    snprintf(path, size, "%s/%s", dir, file);
+    return path;
+}
+
+static FILE *open_unit(const char *path) {
+    FILE *output = fopen(path, "w");
+    if (!output) fprintf(stderr, "Error: Could not open output file '%s'\n", path);
+    return output;
+}
+
+// Removes the module units (<idx>_<module>.c) and their objects left in
+// dir by an earlier build, so a module that is gone or has moved to another
+// index does not leave a stale unit behind
+static void remove_stale_units(const char *dir) {
+    DIR *handle = opendir(dir);
+    if (!handle) return;
+    struct dirent *entry;
+    while ((entry = readdir(handle)) != NULL) {
+        const char *name = entry->d_name;
+        size_t digits = strspn(name, "0123456789");
+        size_t len = strlen(name);
+        if (digits == 0 || name[digits] != '_' || len < digits + 3) continue;
+        if (strcmp(name + len - 2, ".c") != 0 && strcmp(name + len - 2, ".o") != 0) continue;
+        char *path = unit_path(dir, name);
+        remove(path);
+        free(path);
+    }
+    closedir(handle);
+}
+
+char **codegen_generate_units(CodeGenerator *gen, Project *project, const char *dir, size_t *unit_count) {
+    if (!gen || !project || !dir) return NULL;
+    gen->indent_level = 0;
+    gen->project = project;
+
+    // Lower every module once; the same IR feeds the header prototypes and
+    // the module units
+    IRGenerator *irgen = irgen_create();
+    IRModule **ir_modules = malloc(sizeof(IRModule*) * (project->module_count ? project->module_count : 1));
     for (size_t m_idx = 0; m_idx < project->module_count; m_idx++) {
         Module *m = project->modules[m_idx];
-        fprintf(output, "/* Module: %s */\n", m->name);
-        
-        IRModule *ir_module = irgen_generate(irgen_body, m->ast, m->name, m->symtable, m == project->main_module);
-        for (size_t i = 0; i < ir_module->function_count; i++) {
-            gen_function(gen, ir_module->functions[i]);
+        ir_modules[m_idx] = irgen_generate(irgen, m->ast, m->name, m->symtable, m == project->main_module);
+        gen->lowered_modules++;
+    }
+    irgen_free(irgen);
+
+    // The driver already rejected a --passes list that does not parse
+    const char *spec = project->passes ? project->passes : pass_pipeline_for_level(project->opt_level);
+    PassPipeline *pipeline = pass_pipeline_parse(spec);
+    if (pipeline) {
+        PassOptions options = {project->inline_threshold, project->report_bce, project->print_after};
+        pass_pipeline_run(pipeline, ir_modules, project->module_count, &options);
+        pass_pipeline_free(pipeline);
+    }
+
+    // Module units in module order, support unit last
+    char **units = malloc(sizeof(char*) * (project->module_count + 1));
+    size_t count = 0;
+    bool ok = true;
+    remove_stale_units(dir);
+
+    char *header_path = unit_path(dir, CODEGEN_HEADER_NAME);
+    FILE *output = open_unit(header_path);
+    free(header_path);
+    if (output) {
+        emit_header(gen, project, ir_modules, output);
+        fclose(output);
+    } else {
+        ok = false;
+    }
+
+    for (size_t m_idx = 0; ok && m_idx < project->module_count; m_idx++) {
+        Module *m = project->modules[m_idx];
+        if (!ir_modules[m_idx]) continue;
+
+        // The index keeps units apart when two modules share a name;
+        // qualified names like std::io become std__io
+        char file[512];
+        int len = snprintf(file, sizeof(file) - 2, "%zu_%s", m_idx, m->name);
+        if (len < 0 || (size_t)len > sizeof(file) - 3) len = (int)sizeof(file) - 3;
+        for (int i = 0; i < len; i++) {
+            if (!isalnum((unsigned char)file[i]) && file[i] != '_') file[i] = '_';
+        }
+        memcpy(file + len, ".c", 3);
+        units[count] = unit_path(dir, file);
+        output = open_unit(units[count]);
+        count++;
+        if (!output) {
+            ok = false;
+            break;
+        }
+        emit_module_unit(gen, m, ir_modules[m_idx], output);
+        fclose(output);
+    }
+
+    if (ok) {
+        units[count] = unit_path(dir, "virex_support.c");
+        output = open_unit(units[count]);
+        count++;
+        if (output) {
+            emit_support_unit(output);
+            fclose(output);
+        } else {
+            ok = false;
         }
-        ir_module_free(ir_module);
     }
-    irgen_free(irgen_body);
+
+    for (size_t m_idx = 0; m_idx < project->module_count; m_idx++) {
+        ir_module_free(ir_modules[m_idx]);
+    }
+    free(ir_modules);
+
+    if (!ok) {
+        for (size_t i = 0; i < count; i++) free(units[i]);
+        free(units);
+        return NULL;
+    }
+    *unit_count = count;
+    return units;
 }
 
 // Helper: Generate a for loop
@@ -1147,7 +1314,7 @@ static void gen_for_loop(CodeGenerator *gen, IRFunction *func, LoopInfo *info) {
     IROpcode cmp_op = cmp->opcode;
     
     // Loop variable name
-    char *var_name = NULL;
+    const char *var_name = NULL;
     if (loop_var_op->kind == IR_OP_VAR) {
         var_name = loop_var_op->data.var_name;
     } else if (loop_var_op->kind == IR_OP_TEMP) {
@@ -1230,22 +1397,16 @@ static void gen_for_loop(CodeGenerator *gen, IRFunction *func, LoopInfo *info) {
     // We need to find where that label is defined.
     
     const char *body_label_name = branch->src2->data.label_name;
-    size_t body_start = 0;
-    for (size_t k = info->loop_start_idx; k < info->loop_end_idx; k++) {
-        IRInstruction *instr = func->instructions[k];
-        if (instr->opcode == IR_LABEL && instr->dest && strcmp(instr->dest->data.label_name, body_label_name) == 0) {
-            body_start = k;
-            break;
-        }
+    size_t body_block = cfg_label_block(gen->cfg, body_label_name);
+    size_t body_start = info->loop_start_idx + 4; // Label right after the exit jump
+    if (body_block != CFG_NONE && gen->cfg->blocks[body_block].start < info->loop_end_idx) {
+        body_start = gen->cfg->blocks[body_block].start;
     }
     
-    // If we didn't find body label, something is wrong.
-    if (body_start == 0) body_start = info->loop_start_idx + 4; // Fallback guess?
-    
     // Skip the label itself
     for (size_t k = body_start + 1; k < body_end; k++) {
         // Try to detect a nested loop
-        LoopInfo nested_info = detect_simple_loop(func, k);
+        LoopInfo nested_info = detect_simple_loop(func, gen->cfg, k);
         if (nested_info.is_simple_loop) {
             // Check if strict nesting (nested loop ends inside this body)
             // It should, otherwise detection might be crossing boundaries (unlikely with structured code)
@@ -3,11 +3,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <libgen.h>
+#include <pthread.h>
 #include "../include/compiler.h"
+#include "../include/inliner.h"
+#include "../include/passes.h"
 #include "../include/util.h"
 #include "../include/lexer.h"
 #include "../include/parser.h"
 #include "../include/semantic.h"
+#include "../include/intern.h"
+#include "../include/threadpool.h"
+#include "../include/cache.h"
 
 Project *project_create(void) {
     Project *project = malloc(sizeof(Project));
@@ -15,91 +21,274 @@ Project *project_create(void) {
     project->module_count = 0;
     project->main_module = NULL;
     project->strict_unsafe_mode = false;
+    project->jobs = 1;
+    project->inline_threshold = INLINER_DEFAULT_THRESHOLD;
+    project->report_bce = false;
+    project->opt_level = PASS_DEFAULT_LEVEL;
+    project->passes = NULL;
+    project->print_after = NULL;
     return project;
 }
 
-static char *read_file(const char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) return NULL;
-    
-    fseek(file, 0, SEEK_END);
-    long size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    
-    char *buffer = malloc(size + 1);
-    if (!buffer) {
-        fclose(file);
-        return NULL;
-    }
-    
-    size_t read = fread(buffer, 1, size, file);
-    buffer[read] = '\0';
-    
-    fclose(file);
-    return buffer;
-}
-
-Module *project_load_module(Project *project, const char *path, const char *relative_to) {
-    char *res_path = resolve_module_path(relative_to, path);
-    if (!res_path) {
-        fprintf(stderr, "Error: Could not resolve module '%s' relative to '%s'\n", path, relative_to);
-        return NULL;
-    }
-    printf("Debug: Loading module '%s' (resolved: '%s')\n", path, res_path);
-    
-    // Check if already loaded
-    for (size_t i = 0; i < project->module_count; i++) {
-        if (strcmp(project->modules[i]->path, res_path) == 0) {
-            free(res_path);
-            if (project->modules[i]->is_loading) {
-                fprintf(stderr, "Error: Circular dependency detected involving module '%s'\n", project->modules[i]->path);
-                return NULL;
-            }
-            return project->modules[i];
-        }
-    }
-
-    // Load source
-    char *source = read_file(res_path);
-    if (!source) {
+// Lex and parse one file into a fresh arena; NULL on error (already reported)
+static ASTProgram *module_parse(const char *res_path, Arena **out_arena, uint64_t *out_hash) {
+    // Map source (tokens are views into it until the parser materializes them)
+    SourceBuffer source;
+    if (!source_buffer_open(&source, res_path)) {
         fprintf(stderr, "Error: Could not read file '%s'\n", res_path);
-        free(res_path);
         return NULL;
     }
+    // The path is part of the hash: generated code can embed it in diagnostics
+    *out_hash = cache_hash_bytes(source.data, source.size, cache_hash_string(res_path, 0));
 
-    // Parse
-    Lexer *lexer = lexer_init(source, res_path);
+    // Parse into the module's arena
+    Arena *arena = arena_create();
+    Arena *saved_arena = arena_current();
+    arena_set_current(arena);
+    
+    Lexer *lexer = lexer_init(source.data, res_path);
     Parser *parser = parser_init(lexer);
     ASTProgram *ast = parser_parse(parser);
     
+    parser_free(parser);
+    lexer_free(lexer);
+    source_buffer_close(&source);
+    arena_set_current(saved_arena);
+    
     if (!ast) {
-        parser_free(parser);
-        lexer_free(lexer);
-        free(source);
-        free(res_path);
+        arena_free(arena);
         return NULL;
     }
+    *out_arena = arena;
+    return ast;
+}
 
-    // Create module
+static Module *module_create(const char *res_path, ASTProgram *ast, Arena *arena, uint64_t source_hash) {
     Module *module = malloc(sizeof(Module));
     module->path = res_path;
+    module->source_hash = source_hash;
+    module->hash = source_hash;
     
     // Determine module name
     if (ast->module_name) {
-        module->name = strdup(ast->module_name);
+        module->name = intern(ast->module_name);
     } else {
         char *path_copy = strdup(res_path);
         char *bname = basename(path_copy);
         char *dot = strrchr(bname, '.');
         if (dot) *dot = '\0';
-        module->name = strdup(bname);
+        module->name = intern(bname);
         free(path_copy);
     }
     
     module->ast = ast;
+    module->arena = arena;
     module->symtable = symtable_create();
     module->symtable->name = strdup(module->name);
     module->is_analyzed = false;
+    module->is_loading = false;
+    return module;
+}
+
+static void module_free(Module *module) {
+    Arena *saved_arena = arena_current();
+    arena_set_current(module->arena);
+    symtable_free(module->symtable);
+    arena_set_current(saved_arena);
+    arena_free(module->arena);
+    free(module);
+}
+
+// Parallel loading: every newly discovered import path becomes a parse task.
+// Once the pool drains, modules are placed in the same depth-first pre-order
+// the serial loader produces, so later passes and output don't depend on -j.
+typedef struct LoadEntry {
+    const char *path;           // Interned resolved path
+    Module *module;             // NULL until parsed (or if parsing failed)
+    struct LoadEntry **imports; // Parallel to module->ast->imports
+    int state;                  // 0 = unplaced, 1 = on the DFS stack, 2 = placed
+} LoadEntry;
+
+typedef struct {
+    ThreadPool *pool;
+    pthread_mutex_t lock;       // Guards entries and failed
+    LoadEntry **entries;
+    size_t entry_count;
+    size_t entry_capacity;
+    bool failed;
+} ModuleLoader;
+
+typedef struct {
+    ModuleLoader *loader;
+    LoadEntry *entry;
+} LoadTask;
+
+static void load_task_run(void *arg);
+
+// Returns the entry for path, submitting a parse task the first time it is seen
+static LoadEntry *loader_claim(ModuleLoader *loader, const char *res_path) {
+    pthread_mutex_lock(&loader->lock);
+    for (size_t i = 0; i < loader->entry_count; i++) {
+        if (loader->entries[i]->path == res_path) {
+            LoadEntry *existing = loader->entries[i];
+            pthread_mutex_unlock(&loader->lock);
+            return existing;
+        }
+    }
+
+    LoadEntry *entry = malloc(sizeof(LoadEntry));
+    entry->path = res_path;
+    entry->module = NULL;
+    entry->imports = NULL;
+    entry->state = 0;
+    if (loader->entry_count >= loader->entry_capacity) {
+        loader->entry_capacity = loader->entry_capacity == 0 ? 8 : loader->entry_capacity * 2;
+        loader->entries = realloc(loader->entries, sizeof(LoadEntry*) * loader->entry_capacity);
+    }
+    loader->entries[loader->entry_count++] = entry;
+    pthread_mutex_unlock(&loader->lock);
+
+    LoadTask *task = malloc(sizeof(LoadTask));
+    task->loader = loader;
+    task->entry = entry;
+    threadpool_submit(loader->pool, load_task_run, task);
+    return entry;
+}
+
+static void loader_fail(ModuleLoader *loader) {
+    pthread_mutex_lock(&loader->lock);
+    loader->failed = true;
+    pthread_mutex_unlock(&loader->lock);
+}
+
+static void load_task_run(void *arg) {
+    LoadTask *task = arg;
+    ModuleLoader *loader = task->loader;
+    LoadEntry *entry = task->entry;
+    free(task);
+
+    Arena *arena = NULL;
+    uint64_t source_hash = 0;
+    ASTProgram *ast = module_parse(entry->path, &arena, &source_hash);
+    if (!ast) {
+        loader_fail(loader);
+        return;
+    }
+    Module *module = module_create(entry->path, ast, arena, source_hash);
+
+    LoadEntry **imports = calloc(ast->import_count ? ast->import_count : 1, sizeof(LoadEntry*));
+    for (size_t i = 0; i < ast->import_count; i++) {
+        const char *import_path = ast->imports[i]->import_path;
+        char *resolved = resolve_module_path(entry->path, import_path);
+        if (!resolved) {
+            fprintf(stderr, "Error: Could not resolve module '%s' relative to '%s'\n", import_path, entry->path);
+            loader_fail(loader);
+            continue;
+        }
+        const char *res_path = intern(resolved);
+        free(resolved);
+        imports[i] = loader_claim(loader, res_path);
+    }
+
+    // Published before the pool drains; read only after threadpool_wait
+    entry->imports = imports;
+    entry->module = module;
+}
+
+// Both loaders announce each import as they reach it, the way it was
+// written and where it resolved to
+static void report_module_load(const char *path, const char *res_path) {
+    printf("Debug: Loading module '%s' (resolved: '%s')\n", path, res_path);
+}
+
+static bool loader_place(Project *project, LoadEntry *entry) {
+    entry->state = 1;
+    Module *module = entry->module;
+    project->modules = realloc(project->modules, sizeof(Module*) * (project->module_count + 1));
+    project->modules[project->module_count++] = module;
+    if (project->module_count == 1) project->main_module = module;
+
+    for (size_t i = 0; i < module->ast->import_count; i++) {
+        LoadEntry *imported = entry->imports[i];
+        report_module_load(module->ast->imports[i]->import_path, imported->path);
+        if (imported->state == 1) {
+            fprintf(stderr, "Error: Circular dependency detected involving module '%s'\n", imported->path);
+            return false;
+        }
+        if (imported->state == 0 && !loader_place(project, imported)) return false;
+        module->hash = cache_hash_u64(imported->module->hash, module->hash);
+    }
+    entry->state = 2;
+    return true;
+}
+
+static Module *project_load_parallel(Project *project, const char *path, const char *res_path) {
+    ModuleLoader loader;
+    loader.pool = threadpool_create(project->jobs);
+    pthread_mutex_init(&loader.lock, NULL);
+    loader.entries = NULL;
+    loader.entry_count = 0;
+    loader.entry_capacity = 0;
+    loader.failed = false;
+
+    LoadEntry *root = loader_claim(&loader, res_path);
+    threadpool_wait(loader.pool);
+    threadpool_free(loader.pool);
+    pthread_mutex_destroy(&loader.lock);
+
+    bool ok = !loader.failed;
+    if (ok) {
+        report_module_load(path, root->path);
+        ok = loader_place(project, root);
+    }
+    Module *main_module = ok ? root->module : NULL;
+    if (!ok) {
+        // Modules already placed stay owned by the project
+        for (size_t i = 0; i < loader.entry_count; i++) {
+            if (loader.entries[i]->module && loader.entries[i]->state == 0) {
+                module_free(loader.entries[i]->module);
+            }
+        }
+    }
+    for (size_t i = 0; i < loader.entry_count; i++) {
+        free(loader.entries[i]->imports);
+        free(loader.entries[i]);
+    }
+    free(loader.entries);
+    return main_module;
+}
+
+Module *project_load_module(Project *project, const char *path, const char *relative_to) {
+    char *resolved = resolve_module_path(relative_to, path);
+    if (!resolved) {
+        fprintf(stderr, "Error: Could not resolve module '%s' relative to '%s'\n", path, relative_to);
+        return NULL;
+    }
+    const char *res_path = intern(resolved);
+    free(resolved);
+    if (project->jobs > 1 && project->module_count == 0) {
+        return project_load_parallel(project, path, res_path);
+    }
+    report_module_load(path, res_path);
+    
+    // Check if already loaded (module paths are interned)
+    for (size_t i = 0; i < project->module_count; i++) {
+        if (project->modules[i]->path == res_path) {
+            if (project->modules[i]->is_loading) {
+                fprintf(stderr, "Error: Circular dependency detected involving module '%s'\n", project->modules[i]->path);
+                return NULL;
+            }
+            return project->modules[i];
+        }
+    }
+
+    Arena *arena = NULL;
+    uint64_t source_hash = 0;
+    ASTProgram *ast = module_parse(res_path, &arena, &source_hash);
+    if (!ast) return NULL;
+
+    // Create module
+    Module *module = module_create(res_path, ast, arena, source_hash);
     module->is_loading = true; // Mark as currently loading
 
     // Add to project
@@ -114,53 +303,101 @@ Module *project_load_module(Project *project, const char *path, const char *rela
             // Error already printed
             return NULL;
         }
+        // Imports are fully loaded here (cycles were rejected above)
+        module->hash = cache_hash_u64(imported->hash, module->hash);
     }
     
     module->is_loading = false; // Finished loading dependencies
-
-    parser_free(parser);
-    lexer_free(lexer);
-    free(source);
     return module;
 }
 
-bool project_analyze(Project *project) {
-    // 1. First pass: Collect all definitions from all modules
-    for (size_t i = 0; i < project->module_count; i++) {
-        Module *m = project->modules[i];
-        SemanticAnalyzer *sa = semantic_create();
-        sa->strict_unsafe_mode = project->strict_unsafe_mode;
-        sa->current_filename = m->path;
-        symtable_free(sa->symtable);
-        sa->symtable = m->symtable;
-        
-        if (!semantic_analyze_declarations(sa, m->ast)) {
-            return false;
-        }
-        
+// Runs one semantic pass over a module using its own symbol table and arena
+static bool module_analyze(Project *project, Module *m, bool bodies) {
+    Arena *saved_arena = arena_current();
+    arena_set_current(m->arena);
+    SemanticAnalyzer *sa = semantic_create();
+    sa->strict_unsafe_mode = project->strict_unsafe_mode;
+    sa->current_filename = m->path;
+    symtable_free(sa->symtable);
+    sa->symtable = m->symtable;
+    
+    bool ok = bodies ? semantic_analyze_bodies(sa, m->ast) : semantic_analyze_declarations(sa, m->ast);
+    if (ok) {
         sa->symtable = symtable_create();
         semantic_free(sa);
     }
+    arena_set_current(saved_arena);
+    return ok;
+}
+
+typedef struct {
+    Project *project;
+    Module *module;
+    bool bodies;
+    bool ok;
+} AnalyzeTask;
+
+static void analyze_task_run(void *arg) {
+    AnalyzeTask *task = arg;
+    task->ok = module_analyze(task->project, task->module, task->bodies);
+}
+
+// Runs a pass over every module. Serially it stops at the first failure;
+// in parallel every module is analyzed and the pass fails if any did.
+static bool project_analyze_pass(Project *project, bool bodies) {
+    if (project->jobs <= 1 || project->module_count <= 1) {
+        for (size_t i = 0; i < project->module_count; i++) {
+            if (!module_analyze(project, project->modules[i], bodies)) return false;
+        }
+        return true;
+    }
+
+    AnalyzeTask *tasks = malloc(sizeof(AnalyzeTask) * project->module_count);
+    size_t threads = project->jobs < project->module_count ? project->jobs : project->module_count;
+    ThreadPool *pool = threadpool_create(threads);
+    for (size_t i = 0; i < project->module_count; i++) {
+        tasks[i].project = project;
+        tasks[i].module = project->modules[i];
+        tasks[i].bodies = bodies;
+        tasks[i].ok = false;
+        threadpool_submit(pool, analyze_task_run, &tasks[i]);
+    }
+    threadpool_wait(pool);
+    threadpool_free(pool);
+
+    bool ok = true;
+    for (size_t i = 0; i < project->module_count; i++) {
+        if (!tasks[i].ok) ok = false;
+    }
+    free(tasks);
+    return ok;
+}
+
+bool project_analyze(Project *project) {
+    // 1. First pass: Collect all definitions from all modules
+    if (!project_analyze_pass(project, false)) return false;
 
     // 2. Resolve imports: Link module symbols to imported modules
     for (size_t i = 0; i < project->module_count; i++) {
         Module *m = project->modules[i];
         for (size_t j = 0; j < m->ast->import_count; j++) {
             ASTImportDecl *imp = m->ast->imports[j];
-            char *res_path = resolve_module_path(m->path, imp->import_path);
-            if (!res_path) {
+            char *resolved = resolve_module_path(m->path, imp->import_path);
+            if (!resolved) {
                 fprintf(stderr, "Error: Could not resolve import '%s' in %s\n", imp->import_path, m->path);
                 return false;
             }
             
+            const char *res_path = intern_find(resolved);
+            free(resolved);
+            
             Module *target = NULL;
-            for (size_t k = 0; k < project->module_count; k++) {
-                if (strcmp(project->modules[k]->path, res_path) == 0) {
+            for (size_t k = 0; res_path && k < project->module_count; k++) {
+                if (project->modules[k]->path == res_path) {
                     target = project->modules[k];
                     break;
                 }
             }
-            free(res_path);
             
             if (!target) {
                 fprintf(stderr, "Error: Imported module '%s' not loaded in project\n", imp->import_path);
@@ -195,35 +432,35 @@ bool project_analyze(Project *project) {
         }
     }
 
-    // 3. Second pass: Body analysis (now that all imports are linked)
+    // 3. Second pass: Body analysis (now that all imports are linked).
+    // Modules only read each other's global scopes at this point.
+    return project_analyze_pass(project, true);
+}
+
+size_t project_arena_bytes(Project *project) {
+    size_t total = 0;
     for (size_t i = 0; i < project->module_count; i++) {
-        Module *m = project->modules[i];
-        SemanticAnalyzer *sa = semantic_create();
-        sa->strict_unsafe_mode = project->strict_unsafe_mode;
-        sa->current_filename = m->path;
-        symtable_free(sa->symtable);
-        sa->symtable = m->symtable;
-        
-        if (!semantic_analyze_bodies(sa, m->ast)) {
-            return false;
-        }
-        
-        sa->symtable = symtable_create();
-        semantic_free(sa);
+        total += project->modules[i]->arena->bytes_used;
     }
-
-    return true;
+    return total;
 }
 
 void project_free(Project *project) {
     if (!project) return;
+    
+    // Symbols may point at types in any module's arena, so release them
+    // while an arena is current and drop the arenas afterwards.
+    Arena *saved_arena = arena_current();
     for (size_t i = 0; i < project->module_count; i++) {
         Module *m = project->modules[i];
-        ast_free_program(m->ast);
-        free(m->path);
-        free(m->name);
-        
+        arena_set_current(m->arena);
         symtable_free(m->symtable);
+    }
+    arena_set_current(saved_arena);
+    
+    for (size_t i = 0; i < project->module_count; i++) {
+        Module *m = project->modules[i];
+        arena_free(m->arena);  // AST, types and tokens in one go
         free(m);
     }
     free(project->modules);
@@ -184,6 +184,10 @@ void error_report_ex(ErrorLevel level, const char *code, const char *filename, s
         level_color = ANSI_COLOR_BLUE;
     }
     
+    // Hold the stream so reports from concurrent front-end workers don't
+    // interleave; the counter is only touched under the same lock
+    flockfile(stderr);
+
     // Print header: level[code]: message
     fprintf(stderr, "%s%s%s", ANSI_COLOR_BOLD, level_color, level_str);
     if (code) {
@@ -254,12 +258,18 @@ void error_report_ex(ErrorLevel level, const char *code, const char *filename, s
     if (level == LEVEL_ERROR) {
         error_counter++;
     }
+    funlockfile(stderr);
 }
 
 int error_count(void) {
-    return error_counter;
+    flockfile(stderr);
+    int count = error_counter;
+    funlockfile(stderr);
+    return count;
 }
 
 void error_clear(void) {
+    flockfile(stderr);
     error_counter = 0;
+    funlockfile(stderr);
 }
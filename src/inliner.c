@@ -0,0 +1,389 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "../include/inliner.h"
+
+// Callers stop taking inlined bodies past this many instructions
+#define INLINER_MAX_CALLER_SIZE 20000
+
+// Cost taken off a call site for every constant argument, which the
+// scalar passes can usually fold through the inlined body
+#define INLINER_CONST_ARG_BONUS 2
+
+#define NO_NODE ((size_t)-1)
+
+typedef struct {
+    IRFunction *func;
+    size_t *callees;        // Functions called, by node index (repeats allowed)
+    size_t callee_count;
+    size_t size;            // Instructions other than labels and NOPs
+    size_t scc;             // Strongly connected component
+    bool recursive;         // Calls itself, directly or through its SCC
+    // Tarjan bookkeeping
+    size_t index;
+    size_t lowlink;
+    bool on_stack;
+} CallNode;
+
+typedef struct {
+    const char *name;
+    size_t node;
+} NameEntry;
+
+typedef struct {
+    CallNode *nodes;
+    size_t node_count;
+    NameEntry *names;       // Sorted by name, for call target lookup
+    size_t *order;          // Nodes, callees before callers
+    size_t order_count;
+    size_t *stack;
+    size_t stack_count;
+    size_t next_index;
+    size_t scc_count;
+} CallGraph;
+
+static size_t function_size(IRFunction *func) {
+    size_t size = 0;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IROpcode opcode = func->instructions[i]->opcode;
+        if (opcode != IR_LABEL && opcode != IR_NOP) size++;
+    }
+    return size;
+}
+
+static int compare_name_entries(const void *a, const void *b) {
+    return strcmp(((const NameEntry*)a)->name, ((const NameEntry*)b)->name);
+}
+
+static size_t graph_lookup(const CallGraph *graph, const char *name) {
+    size_t lo = 0, hi = graph->node_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(graph->names[mid].name, name);
+        if (cmp == 0) return graph->names[mid].node;
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return NO_NODE;
+}
+
+// Function an IR_CALL reaches, if its body is in the program
+static size_t call_target(const CallGraph *graph, IRInstruction *instr) {
+    if (instr->opcode != IR_CALL || !instr->src1 || instr->src1->kind != IR_OP_VAR) return NO_NODE;
+    return graph_lookup(graph, instr->src1->data.var_name);
+}
+
+static void strong_connect(CallGraph *graph, size_t v) {
+    CallNode *node = &graph->nodes[v];
+    node->index = node->lowlink = graph->next_index++;
+    graph->stack[graph->stack_count++] = v;
+    node->on_stack = true;
+
+    for (size_t c = 0; c < node->callee_count; c++) {
+        size_t w = node->callees[c];
+        if (w == v) node->recursive = true;
+        if (graph->nodes[w].index == NO_NODE) {
+            strong_connect(graph, w);
+            if (graph->nodes[w].lowlink < node->lowlink) node->lowlink = graph->nodes[w].lowlink;
+        } else if (graph->nodes[w].on_stack && graph->nodes[w].index < node->lowlink) {
+            node->lowlink = graph->nodes[w].index;
+        }
+    }
+
+    if (node->lowlink != node->index) return;
+
+    // v roots an SCC; Tarjan finishes SCCs callees first
+    size_t scc = graph->scc_count++;
+    size_t first = graph->order_count;
+    size_t w;
+    do {
+        w = graph->stack[--graph->stack_count];
+        graph->nodes[w].on_stack = false;
+        graph->nodes[w].scc = scc;
+        graph->order[graph->order_count++] = w;
+    } while (w != v);
+    if (graph->order_count - first > 1) {
+        for (size_t k = first; k < graph->order_count; k++) graph->nodes[graph->order[k]].recursive = true;
+    }
+}
+
+static void graph_build(CallGraph *graph, IRModule **modules, size_t module_count) {
+    size_t count = 0;
+    for (size_t m = 0; m < module_count; m++) count += modules[m]->function_count;
+
+    graph->nodes = calloc(count + 1, sizeof(CallNode));
+    graph->names = malloc((count + 1) * sizeof(NameEntry));
+    graph->order = malloc((count + 1) * sizeof(size_t));
+    graph->stack = malloc((count + 1) * sizeof(size_t));
+    for (size_t m = 0; m < module_count; m++) {
+        for (size_t f = 0; f < modules[m]->function_count; f++) {
+            size_t v = graph->node_count++;
+            graph->nodes[v].func = modules[m]->functions[f];
+            graph->nodes[v].index = NO_NODE;
+            graph->names[v].name = modules[m]->functions[f]->name;
+            graph->names[v].node = v;
+        }
+    }
+    qsort(graph->names, graph->node_count, sizeof(NameEntry), compare_name_entries);
+
+    for (size_t v = 0; v < graph->node_count; v++) {
+        CallNode *node = &graph->nodes[v];
+        IRFunction *func = node->func;
+        node->size = function_size(func);
+        node->callees = malloc((func->instruction_count + 1) * sizeof(size_t));
+        for (size_t i = 0; i < func->instruction_count; i++) {
+            size_t target = call_target(graph, func->instructions[i]);
+            if (target != NO_NODE) node->callees[node->callee_count++] = target;
+        }
+    }
+
+    for (size_t v = 0; v < graph->node_count; v++) {
+        if (graph->nodes[v].index == NO_NODE) strong_connect(graph, v);
+    }
+}
+
+static void graph_free(CallGraph *graph) {
+    for (size_t v = 0; v < graph->node_count; v++) free(graph->nodes[v].callees);
+    free(graph->nodes);
+    free(graph->names);
+    free(graph->order);
+    free(graph->stack);
+}
+
+// How an inlined body's names map into the caller
+typedef struct {
+    IRFunction *callee;
+    size_t site;            // Suffix shared by every renamed name
+    int *temps;             // Callee temp id -> caller temp id
+    size_t temp_limit;
+} InlineSite;
+
+static size_t name_length(const char *name) {
+    return strcspn(name, "[");  // Array locals are declared as "name[size]"
+}
+
+static bool is_callee_variable(const IRFunction *callee, const char *ident, size_t len) {
+    for (size_t p = 0; p < callee->param_count; p++) {
+        if (strlen(callee->params[p]) == len && strncmp(callee->params[p], ident, len) == 0) return true;
+    }
+    for (size_t l = 0; l < callee->local_var_count; l++) {
+        const char *name = callee->local_vars[l];
+        if (name_length(name) == len && strncmp(name, ident, len) == 0) return true;
+    }
+    return false;
+}
+
+static bool rename_callee_identifier(const char *ident, size_t len, char *out, size_t out_size, void *ctx) {
+    InlineSite *site = ctx;
+    int temp = ir_temp_identifier(ident, len);
+    if (temp >= 0 && (size_t)temp < site->temp_limit) {
+        snprintf(out, out_size, "t%d", site->temps[temp]);
+        return true;
+    }
+    if (!is_callee_variable(site->callee, ident, len)) return false;
+    snprintf(out, out_size, "%.*s_i%zu", (int)len, ident, site->site);
+    return true;
+}
+
+static char *site_name(const InlineSite *site, const char *name) {
+    size_t len = name_length(name);
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer), "%.*s_i%zu%s", (int)len, name, site->site, name + len);
+    return strdup(buffer);
+}
+
+static IROperand *rename_operand(InlineSite *site, IROperand *op) {
+    if (!op) return NULL;
+    switch (op->kind) {
+        case IR_OP_TEMP:
+            if (op->data.temp_id >= 0 && (size_t)op->data.temp_id < site->temp_limit) {
+                return ir_operand_temp(site->temps[op->data.temp_id]);
+            }
+            return ir_operand_clone(op);
+        case IR_OP_VAR: {
+            char *name = ir_rename_identifiers(op->data.var_name, rename_callee_identifier, site);
+            IROperand *renamed = ir_operand_var(name);
+            free(name);
+            return renamed;
+        }
+        case IR_OP_LABEL: {
+            char *name = site_name(site, op->data.label_name);
+            IROperand *renamed = ir_operand_label(name);
+            free(name);
+            return renamed;
+        }
+        default:
+            return ir_operand_clone(op);
+    }
+}
+
+static IRInstruction *rename_instruction(InlineSite *site, IRInstruction *instr) {
+    IRInstruction *copy = ir_instruction_create(instr->opcode, rename_operand(site, instr->dest),
+                                                rename_operand(site, instr->src1),
+                                                rename_operand(site, instr->src2));
+    if (instr->arg_count > 0) {
+        copy->args = malloc(instr->arg_count * sizeof(IROperand*));
+        for (size_t a = 0; a < instr->arg_count; a++) copy->args[a] = rename_operand(site, instr->args[a]);
+        copy->arg_count = instr->arg_count;
+    }
+    return copy;
+}
+
+static void add_local(IRFunction *func, char *name, const IRType *type) {
+    func->local_vars = realloc(func->local_vars, sizeof(char*) * (func->local_var_count + 1));
+    func->local_var_types = realloc(func->local_var_types, sizeof(IRType*) * (func->local_var_count + 1));
+    func->local_vars[func->local_var_count] = name;
+    func->local_var_types[func->local_var_count] = type ? type : ir_type_long();
+    func->local_var_count++;
+}
+
+// Struct values are copied by assignment; everything else converts the
+// way a call would, including slices passed to pointer parameters
+static IRInstruction *convert_into(IROperand *dest, IROperand *value, const IRType *type) {
+    if (type && (type->kind == IR_TYPE_STRUCT || type->kind == IR_TYPE_SLICE)) {
+        if (dest->kind == IR_OP_VAR) return ir_instruction_create(IR_STORE, NULL, dest, value);
+        return ir_instruction_create(IR_MOVE, dest, value, NULL);
+    }
+    return ir_instruction_create(IR_CAST, dest, value, NULL);
+}
+
+static size_t temp_limit(IRFunction *func) {
+    size_t limit = func->temp_count;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        IROperand *ops[3] = { instr->dest, instr->src1, instr->src2 };
+        for (size_t k = 0; k < 3; k++) {
+            if (ops[k] && ops[k]->kind == IR_OP_TEMP && ops[k]->data.temp_id >= 0 &&
+                (size_t)ops[k]->data.temp_id >= limit) {
+                limit = (size_t)ops[k]->data.temp_id + 1;
+            }
+        }
+    }
+    return limit;
+}
+
+static const IRType *temp_type(IRFunction *func, size_t temp) {
+    return (func->temp_types && temp < func->temp_count) ? func->temp_types[temp] : NULL;
+}
+
+// Append the callee's body for one call to out, replacing the call
+static size_t inline_call(IRFunction *caller, IRInstruction *call, IRFunction *callee, IRInstruction **out) {
+    size_t n = 0;
+    InlineSite site = { callee, caller->label_count++, NULL, temp_limit(callee) };
+    site.temps = malloc((site.temp_limit + 1) * sizeof(int));
+    for (size_t t = 0; t < site.temp_limit; t++) {
+        site.temps[t] = ir_function_new_temp(caller, temp_type(callee, t));
+    }
+
+    // Parameters become locals holding the arguments
+    for (size_t p = 0; p < callee->param_count; p++) {
+        char *name = site_name(&site, callee->params[p]);
+        out[n++] = convert_into(ir_operand_var(name), ir_operand_clone(call->args[p]), callee->param_types[p]);
+        add_local(caller, name, callee->param_types[p]);
+    }
+    for (size_t l = 0; l < callee->local_var_count; l++) {
+        add_local(caller, site_name(&site, callee->local_vars[l]),
+                  callee->local_var_types ? callee->local_var_types[l] : NULL);
+    }
+
+    int result = -1;
+    bool returns_value = callee->return_type && callee->return_type->kind != IR_TYPE_VOID;
+    if (call->dest && returns_value) result = ir_function_new_temp(caller, callee->return_type);
+    char *end_label = ir_function_new_label(caller, "Linl");
+
+    for (size_t i = 0; i < callee->instruction_count; i++) {
+        IRInstruction *instr = callee->instructions[i];
+        if (instr->opcode == IR_NOP) continue;
+        if (instr->opcode != IR_RETURN) {
+            out[n++] = rename_instruction(&site, instr);
+            continue;
+        }
+        if (instr->src1 && result >= 0) {
+            out[n++] = ir_instruction_create(IR_MOVE, ir_operand_temp(result), rename_operand(&site, instr->src1), NULL);
+        }
+        if (i + 1 < callee->instruction_count) {
+            out[n++] = ir_instruction_create(IR_JUMP, NULL, ir_operand_label(end_label), NULL);
+        }
+    }
+    out[n++] = ir_instruction_create(IR_LABEL, NULL, ir_operand_label(end_label), NULL);
+    if (result >= 0) {
+        out[n++] = convert_into(ir_operand_clone(call->dest), ir_operand_temp(result), callee->return_type);
+    }
+
+    free(end_label);
+    free(site.temps);
+    return n;
+}
+
+static bool can_inline(const CallGraph *graph, size_t caller, size_t callee, IRInstruction *call, size_t threshold) {
+    const CallNode *node = &graph->nodes[callee];
+    IRFunction *func = node->func;
+    if (node->recursive || node->scc == graph->nodes[caller].scc) return false;
+    if (func->instruction_count == 0 || strcmp(func->name, "main") == 0) return false;
+    if (call->arg_count != func->param_count) return false;
+    if (call->dest && (!func->return_type || func->return_type->kind == IR_TYPE_VOID)) return false;
+
+    size_t bonus = 0;
+    for (size_t a = 0; a < call->arg_count; a++) {
+        IROperandKind kind = call->args[a]->kind;
+        if (kind == IR_OP_CONST || kind == IR_OP_FLOAT || kind == IR_OP_STRING) bonus += INLINER_CONST_ARG_BONUS;
+    }
+    return node->size <= threshold + bonus;
+}
+
+// Inline the calls in one function whose callees pass the cost model
+static void inline_into(CallGraph *graph, size_t v, size_t threshold) {
+    CallNode *node = &graph->nodes[v];
+    IRFunction *func = node->func;
+
+    size_t extra = 0;
+    size_t inlined = 0;
+    size_t size = node->size;
+    bool *chosen = calloc(func->instruction_count + 1, sizeof(bool));
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        size_t target = call_target(graph, instr);
+        if (target == NO_NODE || !can_inline(graph, v, target, instr, threshold)) continue;
+        IRFunction *callee = graph->nodes[target].func;
+        if (size + graph->nodes[target].size > INLINER_MAX_CALLER_SIZE) continue;
+        chosen[i] = true;
+        size += graph->nodes[target].size;
+        // Parameter copies, the body with a jump per return, the end label
+        // and the result copy
+        extra += callee->param_count + callee->instruction_count * 2 + 2;
+        inlined++;
+    }
+
+    if (inlined > 0) {
+        IRInstruction **out = malloc((func->instruction_count + extra + 1) * sizeof(IRInstruction*));
+        size_t n = 0;
+        for (size_t i = 0; i < func->instruction_count; i++) {
+            IRInstruction *instr = func->instructions[i];
+            if (!chosen[i]) {
+                out[n++] = instr;
+                continue;
+            }
+            n += inline_call(func, instr, graph->nodes[call_target(graph, instr)].func, out + n);
+            ir_instruction_free(instr);
+        }
+        free(func->instructions);
+        func->instructions = out;
+        func->instruction_count = n;
+        func->instruction_capacity = func->instruction_count + extra + 1;
+        node->size = function_size(func);
+    }
+    free(chosen);
+}
+
+void inliner_run(IRModule **modules, size_t module_count, size_t threshold) {
+    if (!modules || threshold == 0) return;
+
+    CallGraph graph = {0};
+    graph_build(&graph, modules, module_count);
+    for (size_t k = 0; k < graph.order_count; k++) {
+        inline_into(&graph, graph.order[k], threshold);
+    }
+    graph_free(&graph);
+}
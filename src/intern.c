@@ -0,0 +1,122 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../include/intern.h"
+#include "../include/arena.h"
+
+#define INTERN_INITIAL_CAPACITY 1024
+
+typedef struct {
+    const char *str;
+    uint32_t hash;
+    uint32_t len;
+} InternEntry;
+
+static InternEntry *entries = NULL;
+static size_t entry_count = 0;
+static size_t entry_capacity = 0;  // Always a power of two
+static Arena *storage = NULL;      // Never released; strings live for the whole run
+
+// Front-end workers intern concurrently; one lock covers table and storage
+static pthread_mutex_t intern_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t intern_hash(const char *str, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static InternEntry *intern_slot(InternEntry *table, size_t capacity, const char *str, size_t len, uint32_t hash) {
+    size_t mask = capacity - 1;
+    size_t i = hash & mask;
+    while (table[i].str) {
+        if (table[i].hash == hash && table[i].len == len && memcmp(table[i].str, str, len) == 0) {
+            return &table[i];
+        }
+        i = (i + 1) & mask;
+    }
+    return &table[i];
+}
+
+static void intern_grow(void) {
+    size_t new_capacity = entry_capacity == 0 ? INTERN_INITIAL_CAPACITY : entry_capacity * 2;
+    InternEntry *new_entries = calloc(new_capacity, sizeof(InternEntry));
+    if (!new_entries) {
+        fprintf(stderr, "Error: Failed to grow string interner\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < entry_capacity; i++) {
+        if (!entries[i].str) continue;
+        InternEntry *slot = intern_slot(new_entries, new_capacity, entries[i].str, entries[i].len, entries[i].hash);
+        *slot = entries[i];
+    }
+    free(entries);
+    entries = new_entries;
+    entry_capacity = new_capacity;
+}
+
+const char *intern_n(const char *str, size_t len) {
+    if (!str) return NULL;
+    uint32_t hash = intern_hash(str, len);
+
+    pthread_mutex_lock(&intern_lock);
+    // Keep the load factor under 3/4
+    if ((entry_count + 1) * 4 > entry_capacity * 3) intern_grow();
+
+    InternEntry *slot = intern_slot(entries, entry_capacity, str, len, hash);
+    if (slot->str) {
+        const char *found = slot->str;
+        pthread_mutex_unlock(&intern_lock);
+        return found;
+    }
+
+    if (!storage) storage = arena_create();
+    char *copy = arena_alloc(storage, len + 1);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    slot->str = copy;
+    slot->hash = hash;
+    slot->len = (uint32_t)len;
+    entry_count++;
+    pthread_mutex_unlock(&intern_lock);
+    return copy;
+}
+
+const char *intern(const char *str) {
+    if (!str) return NULL;
+    return intern_n(str, strlen(str));
+}
+
+const char *intern_find(const char *str) {
+    if (!str) return NULL;
+    size_t len = strlen(str);
+    uint32_t hash = intern_hash(str, len);
+
+    pthread_mutex_lock(&intern_lock);
+    const char *found = NULL;
+    if (entry_count > 0) found = intern_slot(entries, entry_capacity, str, len, hash)->str;
+    pthread_mutex_unlock(&intern_lock);
+    return found;
+}
+
+size_t intern_count(void) {
+    pthread_mutex_lock(&intern_lock);
+    size_t count = entry_count;
+    pthread_mutex_unlock(&intern_lock);
+    return count;
+}
+
+size_t intern_bytes(void) {
+    pthread_mutex_lock(&intern_lock);
+    size_t bytes = storage ? storage->bytes_used : 0;
+    pthread_mutex_unlock(&intern_lock);
+    return bytes;
+}
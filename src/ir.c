@@ -2,80 +2,220 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
 #include "../include/ir.h"
+#include "../include/intern.h"
+
+// Type table, keyed by the interned spelling
+static IRType **type_slots = NULL;
+static size_t type_count = 0;
+static size_t type_capacity = 0;   // Always a power of two
+static pthread_mutex_t type_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void classify_type(IRType *type) {
+    static const struct { const char *name; IRTypeKind kind; unsigned size; } scalars[] = {
+        {"int8_t", IR_TYPE_INT, 1}, {"int16_t", IR_TYPE_INT, 2}, {"int32_t", IR_TYPE_INT, 4},
+        {"int64_t", IR_TYPE_INT, 8}, {"int", IR_TYPE_INT, 4}, {"long", IR_TYPE_INT, 8},
+        {"long long", IR_TYPE_INT, 8}, {"uint8_t", IR_TYPE_UINT, 1}, {"uint16_t", IR_TYPE_UINT, 2},
+        {"uint32_t", IR_TYPE_UINT, 4}, {"uint64_t", IR_TYPE_UINT, 8}, {"float", IR_TYPE_FLOAT, 4},
+        {"double", IR_TYPE_FLOAT, 8}, {"void", IR_TYPE_VOID, 0},
+    };
+    const char *name = type->c_name;
+    size_t len = strlen(name);
+    type->kind = IR_TYPE_OTHER;
+    type->size = 0;
+    type->is_const = false;
+
+    if (strchr(name, '[')) {
+        type->kind = IR_TYPE_ARRAY;
+        return;
+    }
+    if (len > 0 && name[len - 1] == '*') {
+        type->kind = IR_TYPE_POINTER;
+        type->size = sizeof(void*);
+        return;
+    }
+    if (strncmp(name, "const ", 6) == 0) {
+        type->is_const = true;
+        name += 6;
+    }
+    if (strncmp(name, "enum ", 5) == 0) {
+        // Enumerators are ints in C
+        type->kind = IR_TYPE_INT;
+        type->size = 4;
+    } else if (strncmp(name, "struct Slice_", 13) == 0) {
+        type->kind = IR_TYPE_SLICE;
+    } else if (strncmp(name, "struct ", 7) == 0) {
+        type->kind = IR_TYPE_STRUCT;
+    } else {
+        for (size_t i = 0; i < sizeof(scalars) / sizeof(scalars[0]); i++) {
+            if (strcmp(name, scalars[i].name) == 0) {
+                type->kind = scalars[i].kind;
+                type->size = scalars[i].size;
+                break;
+            }
+        }
+    }
+}
+
+static size_t type_slot(IRType **slots, size_t capacity, const char *key) {
+    size_t i = ((uintptr_t)key >> 3) & (capacity - 1);
+    while (slots[i] && slots[i]->c_name != key) i = (i + 1) & (capacity - 1);
+    return i;
+}
+
+const IRType *ir_type(const char *c_name) {
+    if (!c_name) return NULL;
+    const char *key = intern(c_name);
+
+    pthread_mutex_lock(&type_lock);
+    // Keep the load factor under 1/2
+    if ((type_count + 1) * 2 > type_capacity) {
+        size_t capacity = type_capacity == 0 ? 64 : type_capacity * 2;
+        IRType **slots = calloc(capacity, sizeof(IRType*));
+        for (size_t i = 0; i < type_capacity; i++) {
+            if (type_slots[i]) slots[type_slot(slots, capacity, type_slots[i]->c_name)] = type_slots[i];
+        }
+        free(type_slots);
+        type_slots = slots;
+        type_capacity = capacity;
+    }
+
+    size_t slot = type_slot(type_slots, type_capacity, key);
+    if (!type_slots[slot]) {
+        IRType *type = malloc(sizeof(IRType));
+        type->c_name = key;
+        classify_type(type);
+        type_slots[slot] = type;
+        type_count++;
+    }
+    IRType *found = type_slots[slot];
+    pthread_mutex_unlock(&type_lock);
+    return found;
+}
+
+const IRType *ir_type_long(void) {
+    static const IRType *long_type = NULL;
+    if (!long_type) long_type = ir_type("long");
+    return long_type;
+}
+
+// Operands and instructions come out of slabs of IR_POOL_SLAB records
+// instead of one heap block each, so the IR of a function lowered in one
+// go sits in a few contiguous runs. Freed records are reused and slabs
+// live for the whole run. Sanitizer builds keep plain malloc so they
+// still catch use after free.
+// TODO: Dense encoding: fixed-size instruction records with inline
+// operands, stored contiguously per function, call arguments in a side
+// pool, with passes going through ir_instruction_use/_target
+#define IR_POOL_SLAB 1024
+
+typedef struct {
+    void *free_list;        // Freed records, linked through their first word
+    char *next;             // Unused tail of the current slab
+    char *end;
+    size_t record_size;
+} IRPool;
+
+static IRPool operand_pool = { NULL, NULL, NULL, sizeof(IROperand) };
+static IRPool instruction_pool = { NULL, NULL, NULL, sizeof(IRInstruction) };
+
+static void *pool_alloc(IRPool *pool) {
+#ifdef __SANITIZE_ADDRESS__
+    return malloc(pool->record_size);
+#else
+    if (pool->free_list) {
+        void *record = pool->free_list;
+        pool->free_list = *(void**)record;
+        return record;
+    }
+    if (pool->next == pool->end) {
+        size_t bytes = pool->record_size * IR_POOL_SLAB;
+        pool->next = malloc(bytes);
+        if (!pool->next) {
+            fprintf(stderr, "Error: Out of memory for IR\n");
+            exit(1);
+        }
+        pool->end = pool->next + bytes;
+    }
+    void *record = pool->next;
+    pool->next += pool->record_size;
+    return record;
+#endif
+}
+
+static void pool_free(IRPool *pool, void *record) {
+#ifdef __SANITIZE_ADDRESS__
+    (void)pool;
+    free(record);
+#else
+    *(void**)record = pool->free_list;
+    pool->free_list = record;
+#endif
+}
 
 // Operand creation
 IROperand *ir_operand_temp(int temp_id) {
-    IROperand *op = malloc(sizeof(IROperand));
+    IROperand *op = pool_alloc(&operand_pool);
     op->kind = IR_OP_TEMP;
     op->data.temp_id = temp_id;
     return op;
 }
 
 IROperand *ir_operand_const(long value) {
-    IROperand *op = malloc(sizeof(IROperand));
+    IROperand *op = pool_alloc(&operand_pool);
     op->kind = IR_OP_CONST;
     op->data.const_value = value;
     return op;
 }
 
 IROperand *ir_operand_float(double value) {
-    IROperand *op = malloc(sizeof(IROperand));
+    IROperand *op = pool_alloc(&operand_pool);
     op->kind = IR_OP_FLOAT;
     op->data.float_value = value;
     return op;
 }
 
 IROperand *ir_operand_var(const char *name) {
-    IROperand *op = malloc(sizeof(IROperand));
+    IROperand *op = pool_alloc(&operand_pool);
     op->kind = IR_OP_VAR;
-    op->data.var_name = strdup(name);
+    op->data.var_name = intern(name);
     return op;
 }
 
 IROperand *ir_operand_label(const char *name) {
-    IROperand *op = malloc(sizeof(IROperand));
+    IROperand *op = pool_alloc(&operand_pool);
     op->kind = IR_OP_LABEL;
-    op->data.label_name = strdup(name);
+    op->data.label_name = intern(name);
     return op;
 }
 
 IROperand *ir_operand_string(const char *value) {
-    IROperand *op = malloc(sizeof(IROperand));
+    IROperand *op = pool_alloc(&operand_pool);
     op->kind = IR_OP_STRING;
-    op->data.string_value = strdup(value);
+    op->data.string_value = intern(value);
     return op;
 }
 
 void ir_operand_free(IROperand *op) {
     if (!op) return;
-    if (op->kind == IR_OP_VAR) {
-        free(op->data.var_name);
-    } else if (op->kind == IR_OP_LABEL) {
-        free(op->data.label_name);
-    } else if (op->kind == IR_OP_STRING) {
-        free(op->data.string_value);
-    }
-    free(op);
+    pool_free(&operand_pool, op);
 }
 
+// Names are interned, so a clone shares them
 IROperand *ir_operand_clone(IROperand *op) {
     if (!op) return NULL;
-    switch (op->kind) {
-        case IR_OP_TEMP: return ir_operand_temp(op->data.temp_id);
-        case IR_OP_CONST: return ir_operand_const(op->data.const_value);
-        case IR_OP_VAR: return ir_operand_var(op->data.var_name);
-        case IR_OP_LABEL: return ir_operand_label(op->data.label_name);
-        case IR_OP_STRING: return ir_operand_string(op->data.string_value);
-        case IR_OP_FLOAT: return ir_operand_float(op->data.float_value);
-        default: return NULL;
-    }
+    IROperand *copy = pool_alloc(&operand_pool);
+    *copy = *op;
+    return copy;
 }
 
-// Instruction creation
 // Instruction creation
 IRInstruction *ir_instruction_create(IROpcode opcode, IROperand *dest, IROperand *src1, IROperand *src2) {
-    IRInstruction *instr = malloc(sizeof(IRInstruction));
+    IRInstruction *instr = pool_alloc(&instruction_pool);
     instr->opcode = opcode;
     instr->dest = dest;
     instr->src1 = src1;
@@ -86,11 +226,14 @@ IRInstruction *ir_instruction_create(IROpcode opcode, IROperand *dest, IROperand
 }
 
 IRInstruction *ir_instruction_create_call(IROperand *dest, IROperand *func, IROperand **args, size_t arg_count) {
-    IRInstruction *instr = malloc(sizeof(IRInstruction));
-    instr->opcode = IR_CALL;
-    instr->dest = dest;
-    instr->src1 = func;
-    instr->src2 = NULL;
+    IRInstruction *instr = ir_instruction_create(IR_CALL, dest, func, NULL);
+    instr->args = args; // Takes ownership
+    instr->arg_count = arg_count;
+    return instr;
+}
+
+IRInstruction *ir_instruction_create_switch(IROperand *value, IROperand *default_label, IROperand **args, size_t arg_count) {
+    IRInstruction *instr = ir_instruction_create(IR_SWITCH, NULL, value, default_label);
     instr->args = args; // Takes ownership
     instr->arg_count = arg_count;
     return instr;
@@ -109,7 +252,108 @@ void ir_instruction_free(IRInstruction *instr) {
         free(instr->args);
     }
     
-    free(instr);
+    pool_free(&instruction_pool, instr);
+}
+
+IROperand **ir_instruction_use(IRInstruction *instr, size_t index) {
+    if (instr->opcode == IR_PHI) {
+        size_t slot = index * 2 + 1;
+        return slot < instr->arg_count ? &instr->args[slot] : NULL;
+    }
+    if (instr->opcode == IR_SWITCH) {
+        return index == 0 ? &instr->src1 : NULL;
+    }
+    IROperand **slots[2];
+    size_t count = 0;
+    if (instr->src1 && instr->opcode != IR_STORE && instr->opcode != IR_ADDR &&
+        instr->opcode != IR_LABEL) {
+        slots[count++] = &instr->src1;
+    }
+    if (instr->src2) slots[count++] = &instr->src2;
+    if (index < count) return slots[index];
+    index -= count;
+    return index < instr->arg_count ? &instr->args[index] : NULL;
+}
+
+IROperand **ir_instruction_target(IRInstruction *instr, size_t index) {
+    switch (instr->opcode) {
+        case IR_JUMP:
+            return index == 0 ? &instr->src1 : NULL;
+        case IR_BRANCH:
+            return index == 0 ? &instr->src2 : NULL;
+        case IR_SWITCH: {
+            if (index == 0) return &instr->src2;
+            size_t slot = (index - 1) * 2 + 1;
+            return slot < instr->arg_count ? &instr->args[slot] : NULL;
+        }
+        default:
+            return NULL;
+    }
+}
+
+void ir_scan_identifiers(const char *expr, IRIdentVisitor visit, void *ctx) {
+    const char *p = expr;
+    while (*p) {
+        if (isalpha((unsigned char)*p) || *p == '_') {
+            const char *start = p;
+            while (isalnum((unsigned char)*p) || *p == '_') p++;
+            // Skip member names: after "." or "->" they aren't variables
+            bool member = (start > expr && start[-1] == '.') ||
+                          (start > expr + 1 && start[-1] == '>' && start[-2] == '-');
+            if (!member) visit(start, (size_t)(p - start), ctx);
+        } else {
+            p++;
+        }
+    }
+}
+
+int ir_temp_identifier(const char *ident, size_t len) {
+    if (len < 2 || ident[0] != 't') return -1;
+    long id = 0;
+    for (size_t i = 1; i < len; i++) {
+        if (!isdigit((unsigned char)ident[i])) return -1;
+        id = id * 10 + (ident[i] - '0');
+        if (id > INT_MAX) return -1;
+    }
+    return (int)id;
+}
+
+typedef struct {
+    const char *expr;
+    IRIdentRenamer rename;
+    void *ctx;
+    char *out;
+    size_t length;
+    size_t capacity;
+    size_t copied;          // Characters of expr already in out
+} IdentRewrite;
+
+static void rewrite_append(IdentRewrite *rw, const char *text, size_t len) {
+    if (rw->length + len + 1 > rw->capacity) {
+        while (rw->length + len + 1 > rw->capacity) rw->capacity *= 2;
+        rw->out = realloc(rw->out, rw->capacity);
+    }
+    memcpy(rw->out + rw->length, text, len);
+    rw->length += len;
+    rw->out[rw->length] = '\0';
+}
+
+static void rewrite_identifier(const char *ident, size_t len, void *ctx) {
+    IdentRewrite *rw = ctx;
+    char name[256];
+    if (!rw->rename(ident, len, name, sizeof(name), rw->ctx)) return;
+    size_t offset = (size_t)(ident - rw->expr);
+    rewrite_append(rw, rw->expr + rw->copied, offset - rw->copied);
+    rewrite_append(rw, name, strlen(name));
+    rw->copied = offset + len;
+}
+
+char *ir_rename_identifiers(const char *expr, IRIdentRenamer rename, void *ctx) {
+    IdentRewrite rw = { expr, rename, ctx, malloc(strlen(expr) + 16), 0, strlen(expr) + 16, 0 };
+    rw.out[0] = '\0';
+    ir_scan_identifiers(expr, rewrite_identifier, &rw);
+    rewrite_append(&rw, expr + rw.copied, strlen(expr + rw.copied));
+    return rw.out;
 }
 
 // Function creation
@@ -146,27 +390,16 @@ void ir_function_free(IRFunction *func) {
     
     for (size_t i = 0; i < func->param_count; i++) {
         free(func->params[i]);
-        if (func->param_types && func->param_types[i]) free(func->param_types[i]);
     }
     free(func->params);
-    if (func->param_types) free(func->param_types);
-    if (func->return_type) free(func->return_type);
+    free(func->param_types);
     
     for (size_t i = 0; i < func->local_var_count; i++) {
         free(func->local_vars[i]);
-        if (func->local_var_types && func->local_var_types[i]) {
-            free(func->local_var_types[i]);
-        }
     }
     free(func->local_vars);
-    if (func->local_var_types) free(func->local_var_types);
-    
-    if (func->temp_types) {
-        for (size_t i = 0; i < func->temp_count; i++) {
-            if (func->temp_types[i]) free(func->temp_types[i]);
-        }
-        free(func->temp_types);
-    }
+    free(func->local_var_types);
+    free(func->temp_types);
     
     for (size_t i = 0; i < func->instruction_count; i++) {
         ir_instruction_free(func->instructions[i]);
@@ -175,6 +408,21 @@ void ir_function_free(IRFunction *func) {
     free(func);
 }
 
+// Append a temporary of the given type; returns its id
+int ir_function_new_temp(IRFunction *func, const IRType *type) {
+    int id = (int)func->temp_count++;
+    func->temp_types = realloc(func->temp_types, sizeof(IRType*) * func->temp_count);
+    func->temp_types[id] = type;
+    return id;
+}
+
+// Fresh label name, distinct from the ones irgen numbered
+char *ir_function_new_label(IRFunction *func, const char *prefix) {
+    char label[64];
+    snprintf(label, sizeof(label), "%s%zu", prefix, func->label_count++);
+    return strdup(label);
+}
+
 // Module creation
 IRModule *ir_module_create(void) {
     IRModule *module = malloc(sizeof(IRModule));
@@ -184,9 +432,22 @@ IRModule *ir_module_create(void) {
     module->globals = NULL;
     module->global_count = 0;
     module->global_capacity = 0;
+    module->result_types = NULL;
+    module->result_type_count = 0;
     return module;
 }
 
+void ir_module_add_result_type(IRModule *module, const char *c_type, const char *ok_type, const char *err_type) {
+    for (size_t i = 0; i < module->result_type_count; i++) {
+        if (strcmp(module->result_types[i].c_type, c_type) == 0) return;
+    }
+    module->result_types = realloc(module->result_types, sizeof(IRResultType) * (module->result_type_count + 1));
+    IRResultType *result = &module->result_types[module->result_type_count++];
+    result->c_type = strdup(c_type);
+    result->ok_type = strdup(ok_type);
+    result->err_type = strdup(err_type);
+}
+
 void ir_module_add_global(IRModule *module, const char *name, const char *c_type, long init_value) {
     if (module->global_count >= module->global_capacity) {
         module->global_capacity = module->global_capacity == 0 ? 4 : module->global_capacity * 2;
@@ -223,6 +484,13 @@ void ir_module_free(IRModule *module) {
         free(module->globals[i]);
     }
     free(module->globals);
+
+    for (size_t i = 0; i < module->result_type_count; i++) {
+        free(module->result_types[i].c_type);
+        free(module->result_types[i].ok_type);
+        free(module->result_types[i].err_type);
+    }
+    free(module->result_types);
     
     free(module);
 }
@@ -278,6 +546,7 @@ const char *ir_opcode_name(IROpcode opcode) {
         case IR_LABEL: return "LABEL";
         case IR_JUMP: return "JUMP";
         case IR_BRANCH: return "BRANCH";
+        case IR_SWITCH: return "SWITCH";
         case IR_FAIL: return "FAIL";
         case IR_CALL: return "CALL";
         case IR_RETURN: return "RETURN";
@@ -286,6 +555,8 @@ const char *ir_opcode_name(IROpcode opcode) {
         case IR_ADDR: return "ADDR";
         case IR_DEREF: return "DEREF";
         case IR_CAST: return "CAST";
+        case IR_PHI: return "PHI";
+        case IR_NOP: return "NOP";
         default: return "UNKNOWN";
     }
 }
@@ -321,6 +592,15 @@ void ir_instruction_print(IRInstruction *instr) {
         printf(", ");
         ir_operand_print(instr->src2);
     }
+    if (instr->opcode == IR_PHI || instr->opcode == IR_SWITCH) {
+        for (size_t i = 0; i + 1 < instr->arg_count; i += 2) {
+            printf("%s[", i ? ", " : " ");
+            ir_operand_print(instr->args[i]);
+            printf(": ");
+            ir_operand_print(instr->args[i + 1]);
+            printf("]");
+        }
+    }
     
     printf("\n");
 }
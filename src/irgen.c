@@ -4,6 +4,7 @@
 #include <string.h>
 #include "../include/irgen.h"
 #include "../include/compiler.h"
+#include "../include/util.h"
 
 // Forward declarations
 static char *type_to_c_string(Type *type);
@@ -53,83 +54,16 @@ static char *type_to_c_string_with_symtable(SymbolTable *symtable, Type *type) {
         type = resolve_type_alias_irgen(symtable, type);
     }
     
-    switch (type->kind) {
-        case TYPE_PRIMITIVE:
-            switch (type->data.primitive) {
-                case TOKEN_I8: return strdup("int8_t");
-                case TOKEN_U8: return strdup("uint8_t");
-                case TOKEN_I16: return strdup("int16_t");
-                case TOKEN_U16: return strdup("uint16_t");
-                case TOKEN_I32: return strdup("int32_t");
-                case TOKEN_U32: return strdup("uint32_t");
-                case TOKEN_I64: return strdup("long long");
-                case TOKEN_U64: return strdup("uint64_t");
-                case TOKEN_F32: return strdup("float");
-                case TOKEN_F64: return strdup("double");
-                case TOKEN_BOOL: return strdup("int");
-                case TOKEN_VOID: return strdup("void");
-                default: return strdup("long");
-            }
-            
-        case TYPE_STRUCT: {
-            if (strlen(type->data.struct_enum.name) == 1 && type->data.struct_enum.name[0] >= 'A' && type->data.struct_enum.name[0] <= 'Z') {
-                return strdup("uint8_t"); 
-            }
-            char buf[256];
-            snprintf(buf, 256, "struct %s", type->data.struct_enum.name);
-            return strdup(buf);
-        }
-        
-        case TYPE_ENUM:
-            if (type->data.struct_enum.name) {
-                char buf[256];
-                snprintf(buf, 256, "enum %s", type->data.struct_enum.name);
-                return strdup(buf);
-            }
-            return strdup("long");
-
-        case TYPE_ARRAY: {
-            char *elem = type_to_c_string(type->data.array.element);
-            char buf[256];
-            snprintf(buf, 256, "%s[%zu]", elem, type->data.array.size);
-            free(elem);
-            return strdup(buf);
-        }
-
-        case TYPE_POINTER: {
-             char *base = type_to_c_string(type->data.pointer.base);
-             char buf[256];
-             snprintf(buf, 256, "%s*", base);
-             free(base);
-             return strdup(buf);
-        }
-        
-        case TYPE_SLICE: {
-            char *elem_str = type_to_c_string(type->data.slice.element);
-            char *clean_elem = malloc(strlen(elem_str) + 1);
-            size_t j = 0;
-            for (size_t i = 0; elem_str[i]; i++) {
-                if (elem_str[i] != ' ' && elem_str[i] != '*') {
-                    clean_elem[j++] = elem_str[i];
-                }
-            }
-            clean_elem[j] = '\0';
-            
-            char buf[256];
-            snprintf(buf, 256, "struct Slice_%s", clean_elem);
-            free(elem_str);
-            free(clean_elem);
-            return strdup(buf);
-        }
-
-        case TYPE_RESULT:
-            return strdup("struct Result*");
-        
-        case TYPE_FUNCTION:
-            return strdup("void*");
-            
-        default: return strdup("long");
+    if (type->kind == TYPE_RESULT) {
+        char *ok = type_to_c_string_with_symtable(symtable, type->data.result.ok_type);
+        char *err = type_to_c_string_with_symtable(symtable, type->data.result.err_type);
+        char *c_type = util_result_c_type(ok, err);
+        free(ok);
+        free(err);
+        return c_type;
     }
+    if (type->kind == TYPE_ENUM && !type->data.struct_enum.name) return strdup("long");
+    return util_type_to_c_string(type);
 }
 
 // Wrapper for backward compatibility
@@ -137,6 +71,14 @@ static char *type_to_c_string(Type *type) {
     return type_to_c_string_with_symtable(NULL, type);
 }
 
+// Interned IR type of a Virex type
+static const IRType *ir_type_of(SymbolTable *symtable, Type *type) {
+    char *c_type = type_to_c_string_with_symtable(symtable, type);
+    const IRType *ir = ir_type(c_type);
+    free(c_type);
+    return ir;
+}
+
 typedef struct IRScope {
     struct IRScope *parent;
     char **names;      // Key (original name)
@@ -155,6 +97,7 @@ struct IRGenerator {
     IRScope *current_scope;
     int var_counter; // For generating unique variable names
     bool is_main;
+    Type *return_type; // Declared return type of the function being lowered
     
     // Loop stack for break/continue
     struct {
@@ -192,19 +135,54 @@ static char *current_break_label(IRGenerator *gen) {
 
 // Forward declarations
 static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr);
+static IROperand *lower_expr_as(IRGenerator *gen, ASTExpr *expr, Type *target);
 static void lower_stmt(IRGenerator *gen, ASTStmt *stmt);
 static void add_local_variable(IRGenerator *gen, const char *name, Type *type, bool is_const);
 static void lower_function(IRGenerator *gen, ASTDecl *decl);
 static void lower_match_stmt(IRGenerator *gen, ASTStmt *stmt);
 static void lower_fail_stmt(IRGenerator *gen, ASTStmt *stmt);
 
+// Record every result<T, E> instantiation reachable from type, payloads
+// first, so codegen can define the tagged structs in dependency order.
+static void note_result_types(IRGenerator *gen, SymbolTable *symtable, Type *type) {
+    if (symtable) type = resolve_type_alias_irgen(symtable, type);
+    if (!type) return;
+
+    switch (type->kind) {
+        case TYPE_POINTER:
+            note_result_types(gen, symtable, type->data.pointer.base);
+            break;
+        case TYPE_ARRAY:
+            note_result_types(gen, symtable, type->data.array.element);
+            break;
+        case TYPE_SLICE:
+            note_result_types(gen, symtable, type->data.slice.element);
+            break;
+        case TYPE_RESULT: {
+            note_result_types(gen, symtable, type->data.result.ok_type);
+            note_result_types(gen, symtable, type->data.result.err_type);
+            char *c_type = type_to_c_string_with_symtable(symtable, type);
+            char *ok = type_to_c_string_with_symtable(symtable, type->data.result.ok_type);
+            char *err = type_to_c_string_with_symtable(symtable, type->data.result.err_type);
+            ir_module_add_result_type(gen->module, c_type, ok, err);
+            free(c_type);
+            free(ok);
+            free(err);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
 // Helper functions
 static int new_temp(IRGenerator *gen, Type *type) {
     int id = gen->temp_counter++;
+    note_result_types(gen, NULL, type);
     if (gen->current_function) {
         gen->current_function->temp_count = gen->temp_counter;
-        gen->current_function->temp_types = realloc(gen->current_function->temp_types, sizeof(char*) * gen->current_function->temp_count);
-        gen->current_function->temp_types[id] = type_to_c_string(type);
+        gen->current_function->temp_types = realloc(gen->current_function->temp_types, sizeof(IRType*) * gen->current_function->temp_count);
+        gen->current_function->temp_types[id] = ir_type_of(NULL, type);
     }
     return id;
 }
@@ -371,6 +349,7 @@ IRGenerator *irgen_create(void) {
     gen->label_counter = 0;
     gen->current_scope = NULL; // Will be created per function
     gen->var_counter = 0;
+    gen->return_type = NULL;
     return gen;
 }
 
@@ -379,6 +358,126 @@ void irgen_free(IRGenerator *gen) {
     free(gen);
 }
 
+// Result values
+//
+// result<T, E> lowers to a by-value tagged struct, struct Result_<T>__<E>
+// { int is_ok; union { T ok; E err; } as; }, with the member for a
+// void side left out. result::ok(v) and result::err(v) are typed
+// result<T, void> and result<void, E> by the analyzer, so they are built
+// straight into the instantiation the context expects. Other results are
+// copied field by field whenever the context names a different
+// instantiation, such as the type-erased parameters of generic functions.
+
+static bool is_void_type(Type *type) {
+    return !type || (type->kind == TYPE_PRIMITIVE && type->data.primitive == TOKEN_VOID);
+}
+
+// 1 for result::ok(v), 0 for result::err(v), -1 for any other expression
+static int result_constructor(ASTExpr *expr) {
+    if (expr->type != AST_CALL_EXPR || expr->data.call.arg_count != 1) return -1;
+    if (expr->data.call.callee->type != AST_VARIABLE_EXPR) return -1;
+    const char *name = expr->data.call.callee->data.variable.name;
+    if (strcmp(name, "result::ok") == 0) return 1;
+    if (strcmp(name, "result::err") == 0) return 0;
+    return -1;
+}
+
+static void operand_access_string(IROperand *op, char *buf, size_t size) {
+    if (op && op->kind == IR_OP_TEMP) {
+        snprintf(buf, size, "t%d", op->data.temp_id);
+    } else if (op && op->kind == IR_OP_VAR) {
+        snprintf(buf, size, "%s", op->data.var_name);
+    } else {
+        snprintf(buf, size, "unknown");
+    }
+}
+
+static void emit_field_store(IRGenerator *gen, int temp, const char *field, IROperand *value) {
+    char access[64];
+    snprintf(access, sizeof(access), "t%d.%s", temp, field);
+    emit(gen, ir_instruction_create(IR_STORE, NULL, ir_operand_var(access), value));
+}
+
+static IROperand *lower_result_constructor(IRGenerator *gen, ASTExpr *expr, Type *result_type, bool is_ok) {
+    Type *payload_type = is_ok ? result_type->data.result.ok_type : result_type->data.result.err_type;
+    IROperand *value = lower_expr_as(gen, expr->data.call.arguments[0], payload_type);
+
+    int temp = new_temp(gen, result_type);
+    emit_field_store(gen, temp, "is_ok", ir_operand_const(is_ok ? 1 : 0));
+    if (!is_void_type(payload_type) && value) {
+        emit_field_store(gen, temp, is_ok ? "as.ok" : "as.err", value);
+    } else {
+        ir_operand_free(value);
+    }
+    return ir_operand_temp(temp);
+}
+
+static void emit_payload_copy(IRGenerator *gen, int temp, const char *source, const char *field) {
+    char access[300];
+    snprintf(access, sizeof(access), "%s.%s", source, field);
+    emit_field_store(gen, temp, field, ir_operand_var(access));
+}
+
+static IROperand *convert_result(IRGenerator *gen, IROperand *value, Type *from, Type *to) {
+    char source[256];
+    operand_access_string(value, source, sizeof(source));
+
+    bool copy_ok = !is_void_type(from->data.result.ok_type) && !is_void_type(to->data.result.ok_type);
+    bool copy_err = !is_void_type(from->data.result.err_type) && !is_void_type(to->data.result.err_type);
+    bool both_sides = !is_void_type(from->data.result.ok_type) && !is_void_type(from->data.result.err_type);
+
+    int temp = new_temp(gen, to);
+    int tag_temp = new_temp(gen, type_create_primitive(TOKEN_BOOL));
+    char tag_access[300];
+    snprintf(tag_access, sizeof(tag_access), "%s.is_ok", source);
+    emit(gen, ir_instruction_create(IR_MOVE, ir_operand_temp(tag_temp), ir_operand_var(tag_access), NULL));
+    emit_field_store(gen, temp, "is_ok", ir_operand_temp(tag_temp));
+
+    if (both_sides && (copy_ok || copy_err)) {
+        // Only the active member of the source union may be read
+        char *label_ok = new_label(gen, "result_ok");
+        char *label_err = new_label(gen, "result_err");
+        char *label_end = new_label(gen, "result_end");
+        emit(gen, ir_instruction_create(IR_BRANCH, NULL, ir_operand_temp(tag_temp), ir_operand_label(label_ok)));
+        emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_err), NULL));
+        emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label_ok), NULL));
+        if (copy_ok) emit_payload_copy(gen, temp, source, "as.ok");
+        emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_end), NULL));
+        emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label_err), NULL));
+        if (copy_err) emit_payload_copy(gen, temp, source, "as.err");
+        emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_end), NULL));
+        emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label_end), NULL));
+        free(label_ok);
+        free(label_err);
+        free(label_end);
+    } else if (copy_ok) {
+        emit_payload_copy(gen, temp, source, "as.ok");
+    } else if (copy_err) {
+        emit_payload_copy(gen, temp, source, "as.err");
+    }
+
+    ir_operand_free(value);
+    return ir_operand_temp(temp);
+}
+
+// Lower expr for a context that expects target, e.g. an initializer, a
+// returned value or an argument. Only results need the context.
+static IROperand *lower_expr_as(IRGenerator *gen, ASTExpr *expr, Type *target) {
+    if (!expr) return NULL;
+    target = resolve_type_alias_irgen(gen->symtable, target);
+    if (!target || target->kind != TYPE_RESULT) return lower_expr(gen, expr);
+
+    int constructor = result_constructor(expr);
+    if (constructor >= 0) return lower_result_constructor(gen, expr, target, constructor == 1);
+
+    IROperand *value = lower_expr(gen, expr);
+    Type *from = resolve_type_alias_irgen(gen->symtable, expr->expr_type);
+    if (!value || !from || from->kind != TYPE_RESULT) return value;
+
+    if (ir_type_of(NULL, from) == ir_type_of(NULL, target)) return value;
+    return convert_result(gen, value, from, target);
+}
+
 // Expression lowering
 static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
     if (!expr) return NULL;
@@ -395,7 +494,7 @@ static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
             } else if (expr->data.literal.token->type == TOKEN_FALSE) {
                 return ir_operand_const(0);
             } else if (expr->data.literal.token->type == TOKEN_STRING) {
-                return ir_operand_string(expr->data.literal.token->lexeme);
+                return ir_operand_string(token_lexeme(expr->data.literal.token));
             } else if (expr->data.literal.token->type == TOKEN_NULL) {
                 return ir_operand_const(0);
             }
@@ -433,7 +532,7 @@ static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
         
         case AST_BINARY_EXPR: {
             if (expr->data.binary.op == TOKEN_EQ) {
-                IROperand *right = lower_expr(gen, expr->data.binary.right);
+                IROperand *right = lower_expr_as(gen, expr->data.binary.right, expr->data.binary.left->expr_type);
                 
                 if (expr->data.binary.left->type == AST_VARIABLE_EXPR) {
                     const char *unique_name = scope_lookup(gen, expr->data.binary.left->data.variable.name);
@@ -503,17 +602,16 @@ static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
         }
         
         case AST_CALL_EXPR: {
-            IROperand **args = NULL;
-            if (expr->data.call.arg_count > 0) {
-                args = malloc(sizeof(IROperand*) * expr->data.call.arg_count);
-                for (size_t i = 0; i < expr->data.call.arg_count; i++) {
-                    args[i] = lower_expr(gen, expr->data.call.arguments[i]);
-                }
+            int constructor = result_constructor(expr);
+            Type *constructed = resolve_type_alias_irgen(gen->symtable, expr->expr_type);
+            if (constructor >= 0 && constructed && constructed->kind == TYPE_RESULT) {
+                return lower_result_constructor(gen, expr, constructed, constructor == 1);
             }
             
             char mangled_func_name[512];
             bool found_name = false;
             bool is_extern = false;
+            Symbol *callee_sym = NULL;
             
             // Handle qualified call: math.add()
             if (expr->data.call.callee->type == AST_MEMBER_EXPR && !expr->data.call.callee->data.member.is_arrow) {
@@ -531,6 +629,7 @@ static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
                             }
                             
                             Symbol *member_sym = symtable_lookup(mod_sym->module_table, member_name);
+                            callee_sym = member_sym;
                             if (member_sym && member_sym->kind == SYMBOL_FUNCTION && member_sym->is_extern) {
                                 is_extern = true;
                             }
@@ -549,15 +648,6 @@ static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
                         // Special handling for io.print and io.println - use virex_ prefix
                         snprintf(mangled_func_name, 512, "virex_%s", member_name);
                         is_extern = false; // Treat as internal for heuristic
-                    } else if (strcmp(target_module_name, "result") == 0 || strcmp(target_module_name, "std::result") == 0) {
-                        if (strcmp(member_name, "ok") == 0) {
-                            strncpy(mangled_func_name, "virex_result_ok", 511);
-                        } else if (strcmp(member_name, "err") == 0) {
-                            strncpy(mangled_func_name, "virex_result_err", 511);
-                        } else {
-                            snprintf(mangled_func_name, 512, "%s__%s", target_module_name, member_name);
-                        }
-                        is_extern = false;
                     } else {
                         char mod_name_buf[512];
                         strncpy(mod_name_buf, target_module_name, 511);
@@ -576,6 +666,7 @@ static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
                 
                 // Check if this is an extern function
                 Symbol *func_sym = symtable_lookup(gen->symtable, name);
+                callee_sym = func_sym;
                 /*
                 if (func_sym) {
                      printf("Debug IRGen: Found symbol '%s', kind=%d, is_extern=%d\n", name, func_sym->kind, func_sym->is_extern);
@@ -591,14 +682,7 @@ static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
                     mangled_func_name[511] = '\0';
                     found_name = true;
                     is_extern = true;
-                } else if (strcmp(name, "result::ok") == 0) {
-                    strncpy(mangled_func_name, "virex_result_ok", 511);
-                    found_name = true;
-                } else if (strcmp(name, "result::err") == 0) {
-                    strncpy(mangled_func_name, "virex_result_err", 511);
-                    found_name = true;
-                }
-                else if (strcmp(name, "main") == 0 || strncmp(name, "virex_", 6) == 0) {
+                } else if (strcmp(name, "main") == 0 || strncmp(name, "virex_", 6) == 0) {
                     strncpy(mangled_func_name, name, 511);
                     found_name = true;
                 } else {
@@ -623,10 +707,6 @@ static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
                     char tmp[1024];
                     snprintf(tmp, 1023, "virex_%s", mangled_func_name);
                     strncpy(mangled_func_name, tmp, 511);
-                } else if (strcmp(mangled_func_name, "result::ok") == 0) {
-                    strncpy(mangled_func_name, "virex_result_ok", 511);
-                } else if (strcmp(mangled_func_name, "result::err") == 0) {
-                    strncpy(mangled_func_name, "virex_result_err", 511);
                 } else if (strncmp(mangled_func_name, "std::math::", 11) == 0) {
                     char math_func[512];
                     snprintf(math_func, sizeof(math_func), "virex_math_%s", mangled_func_name + 11);
@@ -671,6 +751,25 @@ static IROperand *lower_expr(IRGenerator *gen, ASTExpr *expr) {
                 }
             }
             
+            // Arguments are lowered against the callee's parameter types so
+            // result arguments arrive in the instantiation it expects
+            Type **param_types = NULL;
+            size_t param_type_count = 0;
+            if (callee_sym && callee_sym->kind == SYMBOL_FUNCTION && callee_sym->type &&
+                callee_sym->type->kind == TYPE_FUNCTION) {
+                param_types = callee_sym->type->data.function.param_types;
+                param_type_count = callee_sym->type->data.function.param_count;
+            }
+            
+            IROperand **args = NULL;
+            if (expr->data.call.arg_count > 0) {
+                args = malloc(sizeof(IROperand*) * expr->data.call.arg_count);
+                for (size_t i = 0; i < expr->data.call.arg_count; i++) {
+                    Type *param_type = i < param_type_count ? param_types[i] : NULL;
+                    args[i] = lower_expr_as(gen, expr->data.call.arguments[i], param_type);
+                }
+            }
+            
             int temp = -1;
             bool is_void = false;
             if (expr->expr_type && expr->expr_type->kind == TYPE_PRIMITIVE && expr->expr_type->data.primitive == TOKEN_VOID) {
@@ -828,7 +927,7 @@ static void lower_stmt(IRGenerator *gen, ASTStmt *stmt) {
 
             // Generate initialization if present
             if (stmt->data.var_decl.initializer) {
-                IROperand *value = lower_expr(gen, stmt->data.var_decl.initializer);
+                IROperand *value = lower_expr_as(gen, stmt->data.var_decl.initializer, stmt->data.var_decl.var_type);
                 IROperand *var = ir_operand_var(unique_name);
                 emit(gen, ir_instruction_create(IR_STORE, NULL, var, value));
             }
@@ -949,7 +1048,7 @@ static void lower_stmt(IRGenerator *gen, ASTStmt *stmt) {
         
         case AST_RETURN_STMT: {
             if (stmt->data.return_stmt.value) {
-                IROperand *value = lower_expr(gen, stmt->data.return_stmt.value);
+                IROperand *value = lower_expr_as(gen, stmt->data.return_stmt.value, gen->return_type);
                 emit(gen, ir_instruction_create(IR_RETURN, NULL, value, NULL));
             } else {
                 emit(gen, ir_instruction_create(IR_RETURN, NULL, NULL, NULL));
@@ -1003,9 +1102,10 @@ static void add_local_variable(IRGenerator *gen, const char *name, Type *type, b
     
     // Check if max vars reached? Just realloc.
     func->local_vars = realloc(func->local_vars, sizeof(char*) * (func->local_var_count + 1));
-    func->local_var_types = realloc(func->local_var_types, sizeof(char*) * (func->local_var_count + 1));
+    func->local_var_types = realloc(func->local_var_types, sizeof(IRType*) * (func->local_var_count + 1));
     
     char *type_str = type ? type_to_c_string(type) : strdup("long");
+    note_result_types(gen, NULL, type);
     
     // Handle array stack allocation
     if (type && type->kind == TYPE_ARRAY) {
@@ -1028,7 +1128,8 @@ static void add_local_variable(IRGenerator *gen, const char *name, Type *type, b
         type_str = const_type;
     }
     
-    func->local_var_types[func->local_var_count] = type_str;
+    func->local_var_types[func->local_var_count] = ir_type(type_str);
+    free(type_str);
     func->local_var_count++;
 }
 
@@ -1048,81 +1149,69 @@ static void lower_match_stmt(IRGenerator *gen, ASTStmt *stmt) {
     IROperand *result_ptr = lower_expr(gen, expr);
 
     if (expr_type && expr_type->kind == TYPE_ENUM) {
-        // Enum Match Logic
+        // One switch over the variants; arms after a wildcard never run
         char *label_end = new_label(gen, "match_end");
+        size_t case_count = stmt->data.match_stmt.case_count;
+        char **arm_labels = calloc(case_count, sizeof(char*));
+        IROperand **pairs = malloc(sizeof(IROperand*) * (case_count * 2 + 1));
+        size_t pair_count = 0;
+        char *default_label = NULL;
+        size_t arm_count = 0;
         
-        for (size_t i = 0; i < stmt->data.match_stmt.case_count; i++) {
-            ASTMatchCase *cse = &stmt->data.match_stmt.cases[i];
-            char *label_next = new_label(gen, "match_next");
-            
+        for (; arm_count < case_count && !default_label; arm_count++) {
+            ASTMatchCase *cse = &stmt->data.match_stmt.cases[arm_count];
+            arm_labels[arm_count] = new_label(gen, "case");
             if (strcmp(cse->pattern_tag, "_") == 0) {
-                // Wildcard matches everything
-                scope_enter(gen);
-                lower_stmt(gen, cse->body);
-                scope_exit(gen);
-                emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_end), NULL));
-            } else {
-                // Lookup enum value
-                Symbol *sym = symtable_lookup(gen->symtable, cse->pattern_tag);
-                long enum_val = 0;
-                if (sym && sym->kind == SYMBOL_CONSTANT) {
-                    enum_val = sym->enum_value;
-                } else {
-                    // Start of function scope might not see variants? 
-                    // They should be in symtable.
-                    // Fallback: This relies on valid semantic analysis.
-                }
-                
-                int cond_temp = new_temp(gen, type_create_primitive(TOKEN_BOOL));
-                IROperand *cond = ir_operand_temp(cond_temp);
-                
-                emit(gen, ir_instruction_create(IR_EQ, cond, ir_operand_clone(result_ptr), ir_operand_const(enum_val)));
-                
-                char *label_case = new_label(gen, "case");
-                emit(gen, ir_instruction_create(IR_BRANCH, NULL, ir_operand_clone(cond), ir_operand_label(label_case)));
-                emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_next), NULL));
-                
-                emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label_case), NULL));
-                scope_enter(gen);
-                lower_stmt(gen, cse->body);
-                scope_exit(gen);
-                emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_end), NULL));
+                default_label = arm_labels[arm_count];
+                continue;
             }
             
-            emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label_next), NULL));
+            // Relies on valid semantic analysis having resolved the variant
+            Symbol *sym = symtable_lookup(gen->symtable, cse->pattern_tag);
+            long enum_val = (sym && sym->kind == SYMBOL_CONSTANT) ? sym->enum_value : 0;
+            
+            // A repeated variant keeps its first arm, like the compare chain did
+            bool repeated = false;
+            for (size_t p = 0; p < pair_count; p += 2) {
+                repeated |= pairs[p]->data.const_value == enum_val;
+            }
+            if (repeated) continue;
+            pairs[pair_count++] = ir_operand_const(enum_val);
+            pairs[pair_count++] = ir_operand_label(arm_labels[arm_count]);
+        }
+        
+        emit(gen, ir_instruction_create_switch(result_ptr, ir_operand_label(default_label ? default_label : label_end),
+                                               pairs, pair_count));
+        
+        for (size_t i = 0; i < arm_count; i++) {
+            emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(arm_labels[i]), NULL));
+            scope_enter(gen);
+            lower_stmt(gen, stmt->data.match_stmt.cases[i].body);
+            scope_exit(gen);
+            emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_end), NULL));
+            free(arm_labels[i]);
         }
         
         emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label_end), NULL));
+        free(arm_labels);
+        free(label_end);
         return;
     }
 
-    // Default: Result Match Logic (legacy hardcoded)
-    
-    // 1. Access tag (is_ok)
-    // Assume result is a struct value, so access .tag
-    // We assume the struct layout has 'tag' as first member (offset 0)
-    int is_ok_temp = new_temp(gen, type_create_primitive(TOKEN_I64));
-    IROperand *is_ok_op = ir_operand_temp(is_ok_temp);
-    
-    // Construct access string: ((struct Result*)var)->is_ok
-    char tag_access[256];
-    if (result_ptr->kind == IR_OP_VAR) {
-        snprintf(tag_access, 256, "((struct Result*)%s)->is_ok", result_ptr->data.var_name);
-    } else if (result_ptr->kind == IR_OP_TEMP) {
-        snprintf(tag_access, 256, "((struct Result*)t%d)->is_ok", result_ptr->data.temp_id);
-    } else {
-        snprintf(tag_access, 256, "((struct Result*)0)->is_ok"); 
-    }
+    // Result match: branch on the tag, captures copy the active payload
+    Type *result_type = resolve_type_alias_irgen(gen->symtable, expr_type);
+    char source[256];
+    operand_access_string(result_ptr, source, sizeof(source));
     
-    // Use MOVE instead of DEREF since we have the value in the operand string
-    emit(gen, ir_instruction_create(IR_MOVE, is_ok_op, ir_operand_var(tag_access), NULL));
+    int tag_temp = new_temp(gen, type_create_primitive(TOKEN_BOOL));
+    char tag_access[300];
+    snprintf(tag_access, sizeof(tag_access), "%s.is_ok", source);
+    emit(gen, ir_instruction_create(IR_MOVE, ir_operand_temp(tag_temp), ir_operand_var(tag_access), NULL));
     
-    // 2. Generate labels
     char *label_ok = new_label(gen, "match_ok");
     char *label_err = new_label(gen, "match_err");
     char *label_end = new_label(gen, "match_end");
     
-    // 3. Find OK and ERR cases
     ASTMatchCase *case_ok = NULL;
     ASTMatchCase *case_err = NULL;
     
@@ -1134,97 +1223,45 @@ static void lower_match_stmt(IRGenerator *gen, ASTStmt *stmt) {
         }
     }
     
-    // 4. Branch on is_ok
-    // if (is_ok == 1) goto label_ok;
-    // goto label_err;
-    int cond_temp = new_temp(gen, type_create_primitive(TOKEN_BOOL));
-    IROperand *cond = ir_operand_temp(cond_temp);
-    
-    emit(gen, ir_instruction_create(IR_EQ, cond, ir_operand_clone(is_ok_op), ir_operand_const(1)));
-    
-    // Branch true -> label_ok
-    emit(gen, ir_instruction_create(IR_BRANCH, NULL, ir_operand_clone(cond), ir_operand_label(label_ok)));
-    // Branch false (fallthrough replacement) -> label_err
+    emit(gen, ir_instruction_create(IR_BRANCH, NULL, ir_operand_temp(tag_temp), ir_operand_label(label_ok)));
     emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_err), NULL));
     
-    // --- OK Case ---
-    emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label_ok), NULL));
-    if (case_ok) {
-        scope_enter(gen);
-        
-        if (case_ok->capture_name) {
-            // Access data field
-            int val_temp = new_temp(gen, type_create_primitive(TOKEN_I64));
-            
-            char data_access[256];
-            if (result_ptr->kind == IR_OP_VAR) {
-                snprintf(data_access, 256, "((struct Result*)%s)->data.ok_val", result_ptr->data.var_name);
-            } else if (result_ptr->kind == IR_OP_TEMP) {
-                snprintf(data_access, 256, "((struct Result*)t%d)->data.ok_val", result_ptr->data.temp_id);
-            }
-            
-            emit(gen, ir_instruction_create(IR_MOVE, ir_operand_temp(val_temp), ir_operand_var(data_access), NULL));
-            
-            // Create user variable
-            char *unique_name = scope_define(gen, case_ok->capture_name);
-            
-            // Register for C declaration (assuming i32 for now, or fetch from symtable?)
-            // Wait, we generate C code "type var;".
-            // If we don't know type, we can't declare it correctly.
-            // FIX: We need type info.
-            
-            // Assuming 'long' for generic slots as simplified error handling Phase 12 plan?
-            // "type_to_c_string" uses AST Type.
-            // If I use "long" (generic slot) in C, it works for primitive integers.
-            // But strictly, we need true type.
-            // The AST doesn't have it on the case.
-            // Ideally semantic analysis annotates the case with the type.
-            // I'll use "long" for now as 'data' union member is likely 'long ok_val'.
-            // struct Result { long is_ok; union { long ok_val; long err_val; } data; };
-            // So captures are longs.
-            add_local_variable(gen, unique_name, NULL, false); // weak match capture, assumed mutable or default
-            
-            // Or creating a dummy type primitive long?
-            // I'll modify add_local_variable to handle specialized or default "long".
+    for (int side = 0; side < 2; side++) {
+        bool is_ok = side == 0;
+        ASTMatchCase *cse = is_ok ? case_ok : case_err;
+        emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(is_ok ? label_ok : label_err), NULL));
+        if (cse) {
+            scope_enter(gen);
             
-            emit(gen, ir_instruction_create(IR_MOVE, ir_operand_var(unique_name), ir_operand_temp(val_temp), NULL));
-        }
-        
-        lower_stmt(gen, case_ok->body);
-        scope_exit(gen);
-    }
-    emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_end), NULL));
-    
-    // --- ERR Case ---
-    emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label_err), NULL));
-    if (case_err) {
-        scope_enter(gen);
-        
-        if (case_err->capture_name) {
-            // Access data field
-            int val_temp = new_temp(gen, type_create_primitive(TOKEN_I64));
-            
-            char data_access[256];
-            if (result_ptr->kind == IR_OP_VAR) {
-                snprintf(data_access, 256, "((struct Result*)%s)->data.ok_val", result_ptr->data.var_name);
-            } else if (result_ptr->kind == IR_OP_TEMP) {
-                snprintf(data_access, 256, "((struct Result*)t%d)->data.ok_val", result_ptr->data.temp_id);
+            if (cse->capture_name) {
+                Type *payload_type = NULL;
+                if (result_type && result_type->kind == TYPE_RESULT) {
+                    payload_type = is_ok ? result_type->data.result.ok_type : result_type->data.result.err_type;
+                }
+                
+                char *unique_name = scope_define(gen, cse->capture_name);
+                if (!is_void_type(payload_type)) {
+                    add_local_variable(gen, unique_name, payload_type, false);
+                    
+                    int val_temp = new_temp(gen, payload_type);
+                    char data_access[300];
+                    snprintf(data_access, sizeof(data_access), "%s.as.%s", source, is_ok ? "ok" : "err");
+                    emit(gen, ir_instruction_create(IR_MOVE, ir_operand_temp(val_temp), ir_operand_var(data_access), NULL));
+                    emit(gen, ir_instruction_create(IR_MOVE, ir_operand_var(unique_name), ir_operand_temp(val_temp), NULL));
+                }
             }
             
-            emit(gen, ir_instruction_create(IR_MOVE, ir_operand_temp(val_temp), ir_operand_var(data_access), NULL));
-            
-            char *unique_name = scope_define(gen, case_err->capture_name);
-            add_local_variable(gen, unique_name, NULL, false);
-            emit(gen, ir_instruction_create(IR_MOVE, ir_operand_var(unique_name), ir_operand_temp(val_temp), NULL));
+            lower_stmt(gen, cse->body);
+            scope_exit(gen);
         }
-        
-        lower_stmt(gen, case_err->body);
-        scope_exit(gen);
+        emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_end), NULL));
     }
-    emit(gen, ir_instruction_create(IR_JUMP, NULL, ir_operand_label(label_end), NULL));
     
-    // End Label
     emit(gen, ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label_end), NULL));
+    ir_operand_free(result_ptr);
+    free(label_ok);
+    free(label_err);
+    free(label_end);
 }
 
 // Function lowering
@@ -1266,7 +1303,7 @@ static void lower_function(IRGenerator *gen, ASTDecl *decl) {
     // Add parameters
     if (decl->data.function.param_count > 0) {
         ir_func->params = malloc(sizeof(char*) * decl->data.function.param_count);
-        ir_func->param_types = malloc(sizeof(char*) * decl->data.function.param_count);
+        ir_func->param_types = malloc(sizeof(IRType*) * decl->data.function.param_count);
         ir_func->param_count = decl->data.function.param_count;
         
         for (size_t i = 0; i < decl->data.function.param_count; i++) {
@@ -1275,16 +1312,19 @@ static void lower_function(IRGenerator *gen, ASTDecl *decl) {
             
             // Update the stored param name in IR function signature
             ir_func->params[i] = strdup(unique_param_name);
-            ir_func->param_types[i] = type_to_c_string_with_symtable(gen->symtable, decl->data.function.params[i].param_type);
+            ir_func->param_types[i] = ir_type_of(gen->symtable, decl->data.function.params[i].param_type);
+            note_result_types(gen, gen->symtable, decl->data.function.params[i].param_type);
         }
     }
     
     // Set return type
     if (decl->data.function.return_type) {
-        ir_func->return_type = type_to_c_string_with_symtable(gen->symtable, decl->data.function.return_type);
+        ir_func->return_type = ir_type_of(gen->symtable, decl->data.function.return_type);
+        note_result_types(gen, gen->symtable, decl->data.function.return_type);
     } else {
-        ir_func->return_type = strdup("void");
+        ir_func->return_type = ir_type("void");
     }
+    gen->return_type = decl->data.function.return_type;
     
     // Lower function body
     if (decl->data.function.body) {
@@ -3,7 +3,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
 #include "../include/iropt.h"
+#include "../include/cfg.h"
+#include "../include/ssa.h"
+#include "../include/intern.h"
 
 struct IROptimizer {
     int dummy; // Placeholder
@@ -29,177 +36,1466 @@ static long get_const(IROperand *op) {
     return op->data.const_value;
 }
 
-// Constant folding: Evaluate constant expressions at compile time
-void iropt_constant_folding(IRModule *module) {
-    if (!module) return;
+static bool same_constant(IROperand *a, IROperand *b) {
+    if (a->kind != b->kind) return false;
+    if (a->kind == IR_OP_FLOAT) return a->data.float_value == b->data.float_value;
+    return a->data.const_value == b->data.const_value;
+}
+
+static bool same_value(IROperand *a, IROperand *b) {
+    if (!a || !b || a->kind != b->kind) return false;
+    if (a->kind == IR_OP_CONST) return a->data.const_value == b->data.const_value;
+    if (a->kind == IR_OP_TEMP) return a->data.temp_id == b->data.temp_id;
+    return false;
+}
+
+static bool is_ssa_temp(const SSAInfo *info, IROperand *op) {
+    return op && op->kind == IR_OP_TEMP && ssa_is_value(info, op);
+}
+
+// Fold an integer operation; false when C would not give the same result
+// (division by zero, overflow, unknown opcode)
+static bool fold_binary(IROpcode opcode, long left, long right, long *result) {
+    switch (opcode) {
+        case IR_ADD: return !__builtin_add_overflow(left, right, result);
+        case IR_SUB: return !__builtin_sub_overflow(left, right, result);
+        case IR_MUL: return !__builtin_mul_overflow(left, right, result);
+        case IR_DIV:
+            if (right == 0 || (right == -1 && left == LONG_MIN)) return false;
+            *result = left / right;
+            return true;
+        case IR_MOD:
+            if (right == 0 || (right == -1 && left == LONG_MIN)) return false;
+            *result = left % right;
+            return true;
+        case IR_EQ: *result = (left == right) ? 1 : 0; return true;
+        case IR_NE: *result = (left != right) ? 1 : 0; return true;
+        case IR_LT: *result = (left < right) ? 1 : 0; return true;
+        case IR_LE: *result = (left <= right) ? 1 : 0; return true;
+        case IR_GT: *result = (left > right) ? 1 : 0; return true;
+        case IR_GE: *result = (left >= right) ? 1 : 0; return true;
+        case IR_AND: *result = (left && right) ? 1 : 0; return true;
+        case IR_OR: *result = (left || right) ? 1 : 0; return true;
+        default: return false;
+    }
+}
+
+// The one float type folded values may take: C float literals are doubles
+static bool is_double(const IRType *type) {
+    return type && type->kind == IR_TYPE_FLOAT && type->size == 8 && !type->is_const;
+}
+
+static double numeric_value(IROperand *op) {
+    return op->kind == IR_OP_FLOAT ? op->data.float_value : (double)op->data.const_value;
+}
+
+// Fold an operation with a floating point operand, evaluated in double
+// like the emitted C. Arithmetic yields a double, comparisons an int.
+static IROperand *fold_float(IROpcode opcode, IROperand *left, IROperand *right, const IRType *dest_type) {
+    double l = numeric_value(left), r = numeric_value(right);
+    double value;
+    long truth;
+    switch (opcode) {
+        case IR_ADD: value = l + r; break;
+        case IR_SUB: value = l - r; break;
+        case IR_MUL: value = l * r; break;
+        case IR_DIV:
+            if (r == 0.0) return NULL;
+            value = l / r;
+            break;
+        case IR_EQ: truth = l == r; goto compare;
+        case IR_NE: truth = l != r; goto compare;
+        case IR_LT: truth = l < r; goto compare;
+        case IR_LE: truth = l <= r; goto compare;
+        case IR_GT: truth = l > r; goto compare;
+        case IR_GE: truth = l >= r; goto compare;
+        default: return NULL;
+    }
+    if (!is_double(dest_type) || !isfinite(value)) return NULL;
+    return ir_operand_float(value);
+compare:
+    return ssa_const_fits(dest_type, truth) ? ir_operand_const(truth) : NULL;
+}
+
+// SCCP lattice: a temp is UNDEF until an executable definition is seen,
+// then a single constant, then OVERDEFINED for good
+typedef enum {
+    LATTICE_UNDEF,
+    LATTICE_CONST,
+    LATTICE_OVERDEFINED
+} LatticeState;
+
+typedef struct {
+    LatticeState state;
+    IROperand *value;       // IR_OP_CONST or IR_OP_FLOAT when LATTICE_CONST
+} LatticeCell;
+
+typedef struct {
+    IRFunction *func;
+    CFG *cfg;
+    SSAInfo *info;
+    LatticeCell *cells;
+    bool *block_live;
+    size_t *edge_start;     // Edge id of each block's first succ; ids run
+    size_t *edge_from;      // parallel to the succs, block by block
+    bool *edge_live;
+    size_t *use_start;      // Instructions reading each temp, CSR layout
+    size_t *uses;
+    size_t *flow;           // Edge ids to visit
+    size_t flow_count;
+    size_t *ssa;            // Instructions whose operands changed
+    size_t ssa_count;
+    bool *ssa_queued;
+} SCCPState;
+
+// Constant a temp of this C type can be replaced by, or NULL
+static IROperand *lattice_constant(const IRType *type, IROperand *op) {
+    if (op->kind == IR_OP_CONST) {
+        return ssa_const_fits(type, op->data.const_value) ? ir_operand_const(op->data.const_value) : NULL;
+    }
+    // A float literal in C is a double; any other type would convert it
+    if (op->kind == IR_OP_FLOAT && is_double(type) && isfinite(op->data.float_value)) {
+        return ir_operand_float(op->data.float_value);
+    }
+    return NULL;
+}
+
+// Lattice value of an operand; literals are constants of their own
+static LatticeCell sccp_operand(SCCPState *state, IROperand *op) {
+    LatticeCell cell = { LATTICE_OVERDEFINED, NULL };
+    if (!op) return cell;
+    if (op->kind == IR_OP_CONST || op->kind == IR_OP_FLOAT) {
+        cell.state = LATTICE_CONST;
+        cell.value = op;
+    } else if (is_ssa_temp(state->info, op)) {
+        cell = state->cells[op->data.temp_id];
+    }
+    return cell;
+}
+
+static bool is_foldable(IROpcode opcode) {
+    switch (opcode) {
+        case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_MOD:
+        case IR_EQ: case IR_NE: case IR_LT: case IR_LE: case IR_GT: case IR_GE:
+        case IR_AND: case IR_OR: case IR_NOT: case IR_NEG:
+        case IR_MOVE: case IR_LOAD: case IR_PHI: case IR_CAST:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Label a switch on a known value goes to
+static IROperand *switch_target(IRInstruction *instr, long value) {
+    for (size_t a = 0; a + 1 < instr->arg_count; a += 2) {
+        if (instr->args[a]->data.const_value == value) return instr->args[a + 1];
+    }
+    return instr->src2;
+}
+
+static void sccp_mark_edge(SCCPState *state, size_t block, size_t succ) {
+    BasicBlock *b = &state->cfg->blocks[block];
+    for (size_t s = 0; s < b->succ_count; s++) {
+        size_t edge = state->edge_start[block] + s;
+        if (b->succs[s] == succ && !state->edge_live[edge]) {
+            state->edge_live[edge] = true;
+            state->flow[state->flow_count++] = edge;
+        }
+    }
+}
+
+static bool sccp_edge_live(SCCPState *state, size_t pred, size_t block) {
+    BasicBlock *b = &state->cfg->blocks[pred];
+    for (size_t s = 0; s < b->succ_count; s++) {
+        if (b->succs[s] == block && state->edge_live[state->edge_start[pred] + s]) return true;
+    }
+    return false;
+}
+
+// Lower a temp's cell; queue its readers when it moved
+static void sccp_lower(SCCPState *state, int temp, LatticeState to, IROperand *value) {
+    LatticeCell *cell = &state->cells[temp];
+    if (cell->state >= to) {
+        ir_operand_free(value);
+        return;
+    }
+    ir_operand_free(cell->value);
+    cell->state = to;
+    cell->value = value;
+    for (size_t u = state->use_start[temp]; u < state->use_start[temp + 1]; u++) {
+        size_t user = state->uses[u];
+        if (!state->ssa_queued[user] && state->block_live[state->cfg->block_of[user]]) {
+            state->ssa_queued[user] = true;
+            state->ssa[state->ssa_count++] = user;
+        }
+    }
+}
+
+// What an instruction's SSA dest evaluates to under the current cells
+static void sccp_evaluate_def(SCCPState *state, size_t index) {
+    IRInstruction *instr = state->func->instructions[index];
+    int temp = instr->dest->data.temp_id;
+    const IRType *type = ssa_temp_type(state->func, temp);
+
+    if (!is_foldable(instr->opcode) || state->info->pinned[temp]) {
+        sccp_lower(state, temp, LATTICE_OVERDEFINED, NULL);
+        return;
+    }
+
+    if (instr->opcode == IR_PHI) {
+        size_t block = state->cfg->block_of[index];
+        IROperand *agreed = NULL;
+        for (size_t a = 0; a + 1 < instr->arg_count; a += 2) {
+            size_t pred = cfg_label_block(state->cfg, instr->args[a]->data.label_name);
+            if (pred == CFG_NONE || !sccp_edge_live(state, pred, block)) continue;
+            LatticeCell in = sccp_operand(state, instr->args[a + 1]);
+            if (in.state == LATTICE_UNDEF) continue;
+            if (in.state == LATTICE_OVERDEFINED || (agreed && !same_constant(agreed, in.value))) {
+                sccp_lower(state, temp, LATTICE_OVERDEFINED, NULL);
+                return;
+            }
+            agreed = in.value;
+        }
+        if (agreed) {
+            IROperand *value = lattice_constant(type, agreed);
+            sccp_lower(state, temp, value ? LATTICE_CONST : LATTICE_OVERDEFINED, value);
+        }
+        return;
+    }
+
+    LatticeCell left = sccp_operand(state, instr->src1);
+    LatticeCell right = instr->src2 ? sccp_operand(state, instr->src2) : left;
+    if (left.state == LATTICE_OVERDEFINED || right.state == LATTICE_OVERDEFINED) {
+        sccp_lower(state, temp, LATTICE_OVERDEFINED, NULL);
+        return;
+    }
+    if (left.state == LATTICE_UNDEF || right.state == LATTICE_UNDEF) return;
+
+    IROperand *value = NULL;
+    IROperand *l = left.value, *r = right.value;
+    long result;
+    switch (instr->opcode) {
+        case IR_MOVE:
+        case IR_LOAD:
+            value = lattice_constant(type, l);
+            break;
+        case IR_CAST:
+            // Only conversions that keep the value exactly
+            if (l->kind == IR_OP_CONST && is_double(type) &&
+                l->data.const_value >= -(1L << 53) && l->data.const_value <= (1L << 53)) {
+                IROperand widened = { .kind = IR_OP_FLOAT, .data.float_value = (double)l->data.const_value };
+                value = lattice_constant(type, &widened);
+            } else {
+                value = lattice_constant(type, l);
+            }
+            break;
+        case IR_NOT:
+            if (l->kind == IR_OP_CONST && ssa_const_fits(type, !l->data.const_value)) {
+                value = ir_operand_const(!l->data.const_value);
+            }
+            break;
+        case IR_NEG:
+            if (l->kind == IR_OP_FLOAT) {
+                IROperand negated = { .kind = IR_OP_FLOAT, .data.float_value = -l->data.float_value };
+                value = lattice_constant(type, &negated);
+            } else if (l->data.const_value != LONG_MIN && ssa_const_fits(type, -l->data.const_value)) {
+                value = ir_operand_const(-l->data.const_value);
+            }
+            break;
+        default:
+            if (l->kind == IR_OP_FLOAT || r->kind == IR_OP_FLOAT) {
+                value = fold_float(instr->opcode, l, r, type);
+            } else if (fold_binary(instr->opcode, l->data.const_value, r->data.const_value, &result) &&
+                       ssa_const_fits(type, result)) {
+                value = ir_operand_const(result);
+            }
+            break;
+    }
+    sccp_lower(state, temp, value ? LATTICE_CONST : LATTICE_OVERDEFINED, value);
+}
+
+// Which way a block's terminator can go under the current cells
+static void sccp_evaluate_exit(SCCPState *state, size_t block) {
+    BasicBlock *b = &state->cfg->blocks[block];
+    IRInstruction *last = state->func->instructions[b->end - 1];
+    if (last->opcode == IR_SWITCH) {
+        LatticeCell value = sccp_operand(state, last->src1);
+        if (value.state == LATTICE_UNDEF) return;
+        if (value.state == LATTICE_CONST && value.value->kind == IR_OP_CONST) {
+            IROperand *taken = switch_target(last, value.value->data.const_value);
+            sccp_mark_edge(state, block, cfg_label_block(state->cfg, taken->data.label_name));
+            return;
+        }
+    }
+    if (last->opcode != IR_BRANCH) {
+        for (size_t s = 0; s < b->succ_count; s++) sccp_mark_edge(state, block, b->succs[s]);
+        return;
+    }
+
+    size_t target = cfg_label_block(state->cfg, last->src2->data.label_name);
+    size_t next = block + 1 < state->cfg->block_count ? block + 1 : CFG_NONE;
+    LatticeCell cond = sccp_operand(state, last->src1);
+    if (cond.state == LATTICE_UNDEF) return;
+    if (cond.state == LATTICE_CONST && cond.value->kind == IR_OP_CONST) {
+        sccp_mark_edge(state, block, cond.value->data.const_value ? target : next);
+        return;
+    }
+    for (size_t s = 0; s < b->succ_count; s++) sccp_mark_edge(state, block, b->succs[s]);
+}
+
+static void sccp_visit(SCCPState *state, size_t index) {
+    IRInstruction *instr = state->func->instructions[index];
+    if (is_ssa_temp(state->info, instr->dest)) sccp_evaluate_def(state, index);
+    size_t block = state->cfg->block_of[index];
+    if (index == state->cfg->blocks[block].end - 1) sccp_evaluate_exit(state, block);
+}
+
+static void sccp_solve(SCCPState *state) {
+    while (state->flow_count > 0 || state->ssa_count > 0) {
+        if (state->flow_count > 0) {
+            size_t edge = state->flow[--state->flow_count];
+            size_t from = state->edge_from[edge];
+            size_t block = state->cfg->blocks[from].succs[edge - state->edge_start[from]];
+            BasicBlock *b = &state->cfg->blocks[block];
+            if (state->block_live[block]) {
+                // A new edge into a visited block only changes its phis
+                for (size_t i = b->start; i < b->end; i++) {
+                    if (state->func->instructions[i]->opcode == IR_PHI) sccp_visit(state, i);
+                }
+                continue;
+            }
+            state->block_live[block] = true;
+            for (size_t i = b->start; i < b->end; i++) sccp_visit(state, i);
+            if (b->start == b->end) sccp_evaluate_exit(state, block);
+        } else {
+            size_t index = state->ssa[--state->ssa_count];
+            state->ssa_queued[index] = false;
+            sccp_visit(state, index);
+        }
+    }
+}
+
+// Replace a branch the solver proved one-way; drops the dead edge's phi
+// inputs later along with every other dead edge
+static void sccp_rewrite_branch(IRInstruction *instr, bool taken) {
+    if (taken) {
+        IROperand *target = instr->src2;
+        ir_operand_free(instr->src1);
+        instr->opcode = IR_JUMP;
+        instr->src1 = target;
+        instr->src2 = NULL;
+    } else {
+        ir_operand_free(instr->src1);
+        ir_operand_free(instr->src2);
+        instr->opcode = IR_NOP;
+        instr->src1 = NULL;
+        instr->src2 = NULL;
+    }
+}
+
+// A switch on a constant becomes a jump to the arm it selects
+static void sccp_rewrite_switch(IRInstruction *instr) {
+    IROperand *target = ir_operand_clone(switch_target(instr, instr->src1->data.const_value));
+    for (size_t a = 0; a < instr->arg_count; a++) ir_operand_free(instr->args[a]);
+    free(instr->args);
+    instr->args = NULL;
+    instr->arg_count = 0;
+    ir_operand_free(instr->src1);
+    ir_operand_free(instr->src2);
+    instr->opcode = IR_JUMP;
+    instr->src1 = target;
+    instr->src2 = NULL;
+}
+
+// C type an instruction assigns its first source to, when known
+static const IRType *assigned_type(IRFunction *func, IRInstruction *instr) {
+    switch (instr->opcode) {
+        case IR_MOVE:
+        case IR_LOAD:
+            return instr->dest && instr->dest->kind == IR_OP_TEMP ? ssa_temp_type(func, instr->dest->data.temp_id) : NULL;
+        case IR_RETURN:
+            return func->return_type;
+        case IR_STORE:
+            if (!instr->src1 || instr->src1->kind != IR_OP_VAR) return NULL;
+            for (size_t l = 0; l < func->local_var_count; l++) {
+                if (strcmp(func->local_vars[l], instr->src1->data.var_name) == 0) {
+                    return func->local_var_types ? func->local_var_types[l] : NULL;
+                }
+            }
+            return NULL;
+        default:
+            return NULL;
+    }
+}
+
+static void sccp_rewrite(SCCPState *state) {
+    IRFunction *func = state->func;
+    CFG *cfg = state->cfg;
+
+    // Phi inputs from dead edges go first, while every label the CFG
+    // resolves is still in place
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        BasicBlock *block = &cfg->blocks[b];
+        if (!state->block_live[b]) continue;
+        for (size_t i = block->start; i < block->end; i++) {
+            IRInstruction *instr = func->instructions[i];
+            if (instr->opcode != IR_PHI) continue;
+            size_t kept = 0;
+            for (size_t a = 0; a + 1 < instr->arg_count; a += 2) {
+                size_t pred = cfg_label_block(cfg, instr->args[a]->data.label_name);
+                if (pred != CFG_NONE && sccp_edge_live(state, pred, b)) {
+                    instr->args[kept++] = instr->args[a];
+                    instr->args[kept++] = instr->args[a + 1];
+                } else {
+                    ir_operand_free(instr->args[a]);
+                    ir_operand_free(instr->args[a + 1]);
+                }
+            }
+            instr->arg_count = kept;
+        }
+    }
+
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        BasicBlock *block = &cfg->blocks[b];
+        for (size_t i = block->start; i < block->end; i++) {
+            IRInstruction *instr = func->instructions[i];
+            if (!state->block_live[b]) {
+                // Never reached: nothing live jumps here any more
+                ir_instruction_free(instr);
+                func->instructions[i] = ir_instruction_create(IR_NOP, NULL, NULL, NULL);
+                continue;
+            }
+
+            const IRType *target = assigned_type(func, instr);
+            IROperand **slot;
+            for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+                if (!is_ssa_temp(state->info, *slot)) continue;
+                LatticeCell *cell = &state->cells[(*slot)->data.temp_id];
+                if (cell->state != LATTICE_CONST) continue;
+                // A constant assigned straight into a narrower type makes
+                // gcc warn, though C would convert it the same way
+                if (target && instr->src1 == *slot) {
+                    IROperand *fits = lattice_constant(target, cell->value);
+                    if (!fits) continue;
+                    ir_operand_free(fits);
+                }
+                ir_operand_free(*slot);
+                *slot = ir_operand_clone(cell->value);
+            }
+
+            if (instr->opcode == IR_BRANCH && instr->src1->kind == IR_OP_CONST) {
+                sccp_rewrite_branch(instr, instr->src1->data.const_value != 0);
+            } else if (instr->opcode == IR_SWITCH && instr->src1->kind == IR_OP_CONST) {
+                sccp_rewrite_switch(instr);
+            }
+        }
+    }
+}
+
+// Sparse conditional constant propagation over SSA form: finds the temps
+// that hold one constant on every executable path, treating a branch on
+// a constant as going one way only. Their uses become the constant, the
+// branches become jumps or fall-throughs, and blocks that are never
+// reached become NOPs. The definitions are left for DCE.
+void iropt_sccp(IRFunction *func) {
+    if (!func || func->instruction_count == 0) return;
+
+    SCCPState state = {0};
+    state.func = func;
+    state.cfg = cfg_build(func);
+    state.info = ssa_info_build(func, state.cfg);
+    size_t n = func->instruction_count;
+    size_t limit = state.info->temp_limit;
+    size_t blocks = state.cfg->block_count;
+
+    state.cells = calloc(limit + 1, sizeof(LatticeCell));
+    state.block_live = calloc(blocks, sizeof(bool));
+    state.edge_start = malloc((blocks + 1) * sizeof(size_t));
+    size_t edges = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        state.edge_start[b] = edges;
+        edges += state.cfg->blocks[b].succ_count;
+    }
+    state.edge_start[blocks] = edges;
+    state.edge_from = malloc((edges + 1) * sizeof(size_t));
+    for (size_t b = 0; b < blocks; b++) {
+        for (size_t e = state.edge_start[b]; e < state.edge_start[b + 1]; e++) state.edge_from[e] = b;
+    }
+    state.edge_live = calloc(edges + 1, sizeof(bool));
+    state.flow = malloc((edges + 1) * sizeof(size_t));
+    state.ssa = malloc(n * sizeof(size_t));
+    state.ssa_queued = calloc(n, sizeof(bool));
+
+    // Readers of each temp
+    state.use_start = calloc(limit + 2, sizeof(size_t));
+    for (size_t i = 0; i < n; i++) {
+        IROperand **slot;
+        for (size_t u = 0; (slot = ir_instruction_use(func->instructions[i], u)); u++) {
+            if (is_ssa_temp(state.info, *slot)) state.use_start[(*slot)->data.temp_id + 1]++;
+        }
+    }
+    for (size_t t = 0; t < limit; t++) state.use_start[t + 1] += state.use_start[t];
+    state.uses = malloc((state.use_start[limit] + 1) * sizeof(size_t));
+    size_t *fill = malloc((limit + 1) * sizeof(size_t));
+    memcpy(fill, state.use_start, (limit + 1) * sizeof(size_t));
+    for (size_t i = 0; i < n; i++) {
+        IROperand **slot;
+        for (size_t u = 0; (slot = ir_instruction_use(func->instructions[i], u)); u++) {
+            if (is_ssa_temp(state.info, *slot)) state.uses[fill[(*slot)->data.temp_id]++] = i;
+        }
+    }
+    free(fill);
+
+    BasicBlock *entry = &state.cfg->blocks[0];
+    state.block_live[0] = true;
+    for (size_t i = entry->start; i < entry->end; i++) sccp_visit(&state, i);
+    sccp_solve(&state);
+
+    // A branch or switch on a value still UNDEF reads something no
+    // executable path defines; assume every way rather than leave its
+    // targets dangling
+    bool settled = false;
+    while (!settled) {
+        settled = true;
+        for (size_t b = 0; b < blocks; b++) {
+            BasicBlock *block = &state.cfg->blocks[b];
+            if (!state.block_live[b] || block->start == block->end) continue;
+            IRInstruction *last = func->instructions[block->end - 1];
+            if ((last->opcode != IR_BRANCH && last->opcode != IR_SWITCH) ||
+                sccp_operand(&state, last->src1).state != LATTICE_UNDEF) continue;
+            for (size_t s = 0; s < block->succ_count; s++) {
+                if (!state.edge_live[state.edge_start[b] + s]) settled = false;
+                sccp_mark_edge(&state, b, block->succs[s]);
+            }
+        }
+        sccp_solve(&state);
+    }
+
+    sccp_rewrite(&state);
+
+    for (size_t t = 0; t < limit; t++) ir_operand_free(state.cells[t].value);
+    free(state.cells);
+    free(state.block_live);
+    free(state.edge_start);
+    free(state.edge_from);
+    free(state.edge_live);
+    free(state.flow);
+    free(state.ssa);
+    free(state.ssa_queued);
+    free(state.use_start);
+    free(state.uses);
+    ssa_info_free(state.info);
+    cfg_free(state.cfg);
+}
+
+// Temp an SSA temp's definition just copies, if any: a MOVE or LOAD of
+// a temp with the same C type, or a phi whose inputs all agree
+static IROperand *copy_source(IRFunction *func, const SSAInfo *info, IRInstruction *instr) {
+    IROperand *candidate = NULL;
+    switch (instr->opcode) {
+        case IR_MOVE:
+        case IR_LOAD:
+        case IR_CAST:
+            candidate = instr->src1;
+            break;
+        case IR_PHI:
+            // Ignoring the phi's own back edges
+            for (size_t a = 1; a < instr->arg_count; a += 2) {
+                IROperand *in = instr->args[a];
+                if (in && in->kind == IR_OP_TEMP && in->data.temp_id == instr->dest->data.temp_id) continue;
+                if (!in || (candidate && !same_value(candidate, in))) return NULL;
+                candidate = in;
+            }
+            break;
+        default:
+            return NULL;
+    }
+    if (is_ssa_temp(info, candidate) &&
+        ssa_temp_type(func, candidate->data.temp_id) == ssa_temp_type(func, instr->dest->data.temp_id)) {
+        return candidate;
+    }
+    return NULL;
+}
+
+// Copy propagation over SSA form: uses of a temp that only copies
+// another value read that value directly. The copies are left for DCE.
+void iropt_copy_propagation(IRFunction *func) {
+    if (!func || func->instruction_count == 0) return;
+    
+    CFG *cfg = cfg_build(func);
+    SSAInfo *info = ssa_info_build(func, cfg);
+    IROperand **source = calloc(info->temp_limit + 1, sizeof(IROperand*));
     
+    // Reverse post-order sees definitions before uses, except for phis
+    // fed by back edges; go around again when one of those changed
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t r = 0; r < cfg->rpo_count; r++) {
+            BasicBlock *block = &cfg->blocks[cfg->rpo[r]];
+            for (size_t i = block->start; i < block->end; i++) {
+                IRInstruction *instr = func->instructions[i];
+                IROperand **slot;
+                for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+                    IROperand *op = *slot;
+                    if (!is_ssa_temp(info, op) || !source[op->data.temp_id]) continue;
+                    *slot = ir_operand_clone(source[op->data.temp_id]);
+                    ir_operand_free(op);
+                    changed = true;
+                }
+                if (!is_ssa_temp(info, instr->dest) || source[instr->dest->data.temp_id]) continue;
+                IROperand *copied = copy_source(func, info, instr);
+                if (copied) {
+                    source[instr->dest->data.temp_id] = ir_operand_clone(copied);
+                    changed = true;
+                }
+            }
+        }
+    }
+    
+    for (size_t t = 0; t < info->temp_limit; t++) ir_operand_free(source[t]);
+    free(source);
+    ssa_info_free(info);
+    cfg_free(cfg);
+}
+
+// A variable path a VAR expression reads or writes: its leading
+// identifiers and member names up to the first index or dereference,
+// "g_v2.w" in "g_v2.w" and "s_v1.data" in "s_v1.data[t3]". Expressions
+// that start with a dereference, "(*p_v1).x", have none.
+typedef struct {
+    const char *text;
+    size_t len;
+    size_t root_len;        // The variable name at the start
+} VarPath;
+
+static bool var_path(const char *expr, VarPath *path) {
+    if (!isalpha((unsigned char)expr[0]) && expr[0] != '_') return false;
+    size_t root = 0;
+    while (isalnum((unsigned char)expr[root]) || expr[root] == '_') root++;
+    size_t len = root;
+    while (isalnum((unsigned char)expr[len]) || expr[len] == '_' || expr[len] == '.') len++;
+    path->text = expr;
+    path->len = len;
+    path->root_len = root;
+    return true;
+}
+
+static bool same_root(const VarPath *a, const VarPath *b) {
+    return a->root_len == b->root_len && strncmp(a->text, b->text, a->root_len) == 0;
+}
+
+// Whether writing one path can change what reading the other sees: one
+// is the other or a member of it
+static bool paths_overlap(const VarPath *a, const VarPath *b) {
+    const VarPath *shorter = a->len <= b->len ? a : b;
+    const VarPath *longer = a->len <= b->len ? b : a;
+    if (strncmp(shorter->text, longer->text, shorter->len) != 0) return false;
+    return longer->len == shorter->len || longer->text[shorter->len] == '.';
+}
+
+// Local (arrays included) or parameter the path is rooted at
+static bool is_declared_root(IRFunction *func, const VarPath *path) {
+    for (size_t i = 0; i < func->local_var_count + func->param_count; i++) {
+        const char *name = i < func->local_var_count ? func->local_vars[i] : func->params[i - func->local_var_count];
+        if (strncmp(name, path->text, path->root_len) == 0 &&
+            (name[path->root_len] == '\0' || name[path->root_len] == '[')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A VAR expression that is nothing but a path into a local or parameter
+static bool is_local_path(IRFunction *func, const char *expr, VarPath *path) {
+    return var_path(expr, path) && path->len == strlen(expr) && is_declared_root(func, path);
+}
+
+// Path an instruction assigns through a named variable, whole or in part
+static bool written_path(IRInstruction *instr, VarPath *path) {
+    IROperand *target = instr->opcode == IR_STORE ? instr->src1 : instr->dest;
+    return target && target->kind == IR_OP_VAR && var_path(target->data.var_name, path);
+}
+
+static bool is_scalar_type(const IRType *type) {
+    return type->kind == IR_TYPE_INT || type->kind == IR_TYPE_UINT ||
+           type->kind == IR_TYPE_FLOAT || type->kind == IR_TYPE_POINTER;
+}
+
+// A divisor that can't trap
+static bool is_safe_divisor(IROperand *op) {
+    return op && op->kind == IR_OP_CONST && op->data.const_value != 0 && op->data.const_value != -1;
+}
+
+static size_t module_function_index(IRModule *module, const char *name) {
     for (size_t f = 0; f < module->function_count; f++) {
-        IRFunction *func = module->functions[f];
-        
-        for (size_t i = 0; i < func->instruction_count; i++) {
-            IRInstruction *instr = func->instructions[i];
-            
-            // Skip if not a binary operation with constant operands
-            if (!instr->src1 || !instr->src2) continue;
-            if (!is_const(instr->src1) || !is_const(instr->src2)) continue;
-            
-            long left = get_const(instr->src1);
-            long right = get_const(instr->src2);
-            long result = 0;
-            bool can_fold = true;
-            
-            switch (instr->opcode) {
-                case IR_ADD: result = left + right; break;
-                case IR_SUB: result = left - right; break;
-                case IR_MUL: result = left * right; break;
-                case IR_DIV: 
-                    if (right != 0) result = left / right;
-                    else can_fold = false;
-                    break;
-                case IR_MOD:
-                    if (right != 0) result = left % right;
-                    else can_fold = false;
-                    break;
-                case IR_EQ: result = (left == right) ? 1 : 0; break;
-                case IR_NE: result = (left != right) ? 1 : 0; break;
-                case IR_LT: result = (left < right) ? 1 : 0; break;
-                case IR_LE: result = (left <= right) ? 1 : 0; break;
-                case IR_GT: result = (left > right) ? 1 : 0; break;
-                case IR_GE: result = (left >= right) ? 1 : 0; break;
-                case IR_AND: result = (left && right) ? 1 : 0; break;
-                case IR_OR: result = (left || right) ? 1 : 0; break;
-                default: can_fold = false; break;
+        if (strcmp(module->functions[f]->name, name) == 0) return f;
+    }
+    return CFG_NONE;
+}
+
+static bool is_pure_function(IRModule *module, size_t f, const bool *pure) {
+    IRFunction *func = module->functions[f];
+    if (func->instruction_count == 0) return false;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        switch (instr->opcode) {
+            case IR_FAIL:
+            case IR_ADDR:
+            case IR_DEREF:
+            case IR_PHI:
+                return false;
+            case IR_DIV:
+            case IR_MOD:
+                if (!is_safe_divisor(instr->src2)) return false;
+                break;
+            case IR_CALL: {
+                if (!instr->src1 || instr->src1->kind != IR_OP_VAR) return false;
+                size_t callee = module_function_index(module, instr->src1->data.var_name);
+                if (callee == CFG_NONE || !pure[callee]) return false;
+                break;
             }
-            
-            if (can_fold) {
-                // Replace with MOVE constant
-                ir_operand_free(instr->src1);
-                ir_operand_free(instr->src2);
-                instr->opcode = IR_MOVE;
-                instr->src1 = ir_operand_const(result);
-                instr->src2 = NULL;
+            default:
+                break;
+        }
+        IROperand *ops[3] = { instr->dest, instr->opcode == IR_CALL ? NULL : instr->src1, instr->src2 };
+        VarPath path;
+        for (size_t k = 0; k < 3; k++) {
+            if (ops[k] && ops[k]->kind == IR_OP_VAR && !is_local_path(func, ops[k]->data.var_name, &path)) return false;
+        }
+        for (size_t a = 0; a < instr->arg_count; a++) {
+            IROperand *arg = instr->args[a];
+            if (arg && arg->kind == IR_OP_VAR && !is_local_path(func, arg->data.var_name, &path)) return false;
+        }
+    }
+    CFG *cfg = cfg_build(func);
+    bool loop_free = cfg->loop_count == 0;
+    cfg_free(cfg);
+    return loop_free;
+}
+
+// Functions a loop may call once instead of on every iteration. They
+// touch nothing but their own parameters and locals, never trap, and
+// always return: no loops, and calls only to other such functions,
+// which rules out recursion.
+static bool *find_pure_functions(IRModule *module) {
+    bool *pure = calloc(module->function_count + 1, sizeof(bool));
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t f = 0; f < module->function_count; f++) {
+            if (!pure[f] && is_pure_function(module, f, pure)) {
+                pure[f] = true;
+                changed = true;
             }
         }
     }
+    return pure;
 }
 
-// Dead code elimination: Remove unreachable code and unused instructions
-void iropt_dead_code_elimination(IRModule *module) {
+// What a function's loops may assume about the variables they read
+typedef struct {
+    IRFunction *func;
+    VarPath *escaped;       // Variables whose address is taken
+    size_t escaped_count;
+    VarPath *writes;        // Paths the current loop assigns
+    size_t write_count;
+} LoopMemory;
+
+static void note_escaped(const char *ident, size_t len, void *ctx) {
+    LoopMemory *memory = ctx;
+    memory->escaped = realloc(memory->escaped, sizeof(VarPath) * (memory->escaped_count + 1));
+    memory->escaped[memory->escaped_count++] = (VarPath){ ident, len, len };
+}
+
+static void loop_memory_init(LoopMemory *memory, IRFunction *func) {
+    *memory = (LoopMemory){ func, NULL, 0, NULL, 0 };
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        if (instr->opcode == IR_ADDR && instr->src1 && instr->src1->kind == IR_OP_VAR) {
+            ir_scan_identifiers(instr->src1->data.var_name, note_escaped, memory);
+        }
+    }
+}
+
+static void loop_memory_free(LoopMemory *memory) {
+    free(memory->escaped);
+    free(memory->writes);
+}
+
+static void loop_memory_collect_writes(LoopMemory *memory, CFG *cfg, CFGLoop *loop) {
+    memory->write_count = 0;
+    for (size_t b = 0; b < loop->block_count; b++) {
+        BasicBlock *block = &cfg->blocks[loop->blocks[b]];
+        for (size_t k = block->start; k < block->end; k++) {
+            VarPath path;
+            if (!written_path(cfg->func->instructions[k], &path)) continue;
+            memory->writes = realloc(memory->writes, sizeof(VarPath) * (memory->write_count + 1));
+            memory->writes[memory->write_count++] = path;
+        }
+    }
+}
+
+// A read of a local or parameter, or a member of one, is invariant in
+// the loop whose writes were collected last when the loop assigns none
+// of it and no pointer can reach it. Anything read through a pointer or
+// an index may change.
+static bool loop_memory_invariant(LoopMemory *memory, const char *expr) {
+    VarPath path;
+    if (!is_local_path(memory->func, expr, &path)) return false;
+    for (size_t i = 0; i < memory->escaped_count; i++) {
+        if (same_root(&memory->escaped[i], &path)) return false;
+    }
+    for (size_t i = 0; i < memory->write_count; i++) {
+        if (same_root(&memory->writes[i], &path) && paths_overlap(&memory->writes[i], &path)) return false;
+    }
+    return true;
+}
+
+// Per-function facts LICM needs about temps and variables
+typedef struct {
+    IRModule *module;
+    IRFunction *func;
+    const bool *pure;       // Per module function, from find_pure_functions
+    size_t *def_count;      // Definitions of each temp
+    size_t *def_index;      // Instruction defining it (when def_count is 1)
+    bool *hoisted;          // Instruction already moved to a preheader
+    size_t temp_limit;
+    LoopMemory memory;
+} LicmState;
+
+static bool temp_in_range(LicmState *state, IROperand *op) {
+    return op->data.temp_id >= 0 && (size_t)op->data.temp_id < state->temp_limit;
+}
+
+// Helper: Check if operand is loop-invariant (doesn't change in loop)
+static bool is_loop_invariant(IROperand *op, CFG *cfg, size_t loop, LicmState *state) {
+    if (!op) return true;
+    
+    // Constants are always invariant
+    if (op->kind == IR_OP_CONST || op->kind == IR_OP_FLOAT) return true;
+    
+    // A temp is invariant when its only definition is outside the loop
+    // or has itself been hoisted
+    if (op->kind == IR_OP_TEMP) {
+        if (!temp_in_range(state, op)) return false;
+        size_t temp = (size_t)op->data.temp_id;
+        if (state->def_count[temp] == 0) return true;
+        if (state->def_count[temp] > 1) return false;
+        size_t def = state->def_index[temp];
+        return state->hoisted[def] || !cfg_loop_contains(cfg, loop, cfg->block_of[def]);
+    }
+    
+    if (op->kind == IR_OP_VAR) return loop_memory_invariant(&state->memory, op->data.var_name);
+    
+    return false;
+}
+
+// Helper: Check if instruction is loop-invariant
+static bool is_instruction_invariant(IRInstruction *instr, CFG *cfg, size_t loop, LicmState *state) {
+    // Only hoist pure operations, copies and calls to pure functions.
+    // Hoisted code runs even when the loop body doesn't, so it must not
+    // trap either.
+    if (!instr->dest || instr->dest->kind != IR_OP_TEMP) return false;
+    if (!temp_in_range(state, instr->dest) || state->def_count[instr->dest->data.temp_id] != 1) return false;
+    bool scalar = is_scalar_type(ssa_temp_type(state->func, instr->dest->data.temp_id));
+
+    switch (instr->opcode) {
+        case IR_DIV:
+        case IR_MOD:
+            if (!is_safe_divisor(instr->src2)) return false;
+            break;
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_EQ:
+        case IR_NE:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+        case IR_AND:
+        case IR_OR:
+        case IR_NOT:
+        case IR_NEG:
+            break;
+        case IR_MOVE:
+        case IR_LOAD:
+            if (!scalar) return false;
+            break;
+        case IR_CALL: {
+            if (!scalar || instr->src1->kind != IR_OP_VAR) return false;
+            size_t callee = module_function_index(state->module, instr->src1->data.var_name);
+            if (callee == CFG_NONE || !state->pure[callee]) return false;
+            for (size_t a = 0; a < instr->arg_count; a++) {
+                if (!is_loop_invariant(instr->args[a], cfg, loop, state)) return false;
+            }
+            return true;
+        }
+        default:
+            return false; // Don't hoist stores, impure calls, etc.
+    }
+    
+    // Check if all operands are invariant
+    if (!is_loop_invariant(instr->src1, cfg, loop, state)) return false;
+    if (!is_loop_invariant(instr->src2, cfg, loop, state)) return false;
+    
+    return true;
+}
+
+// Instruction index hoisted code is inserted before, or CFG_NONE when the
+// loop has no block that could serve as its preheader: the header must be
+// entered from outside only by falling through from the block above it
+static size_t loop_preheader_position(CFG *cfg, CFGLoop *loop) {
+    BasicBlock *header = &cfg->blocks[loop->header];
+    if (loop->header == 0) return CFG_NONE;
+    
+    size_t above = loop->header - 1;
+    for (size_t p = 0; p < header->pred_count; p++) {
+        size_t pred = header->preds[p];
+        if (cfg_loop_contains(cfg, (size_t)(loop - cfg->loops), pred)) continue;
+        if (pred != above) return CFG_NONE;
+    }
+    BasicBlock *pre = &cfg->blocks[above];
+    if (pre->end > pre->start) {
+        IROpcode last = cfg->func->instructions[pre->end - 1]->opcode;
+        if (last == IR_JUMP || last == IR_BRANCH || last == IR_SWITCH || last == IR_RETURN || last == IR_FAIL) return CFG_NONE;
+    }
+    return header->start;
+}
+
+// Loop Invariant Code Motion: hoist invariant computations, reads of
+// locals the loop doesn't assign and calls to pure functions into the
+// preheader of every natural loop they are invariant in
+void iropt_loop_invariant_code_motion(IRModule *module) {
     if (!module) return;
+    bool *pure = find_pure_functions(module);
     
     for (size_t f = 0; f < module->function_count; f++) {
         IRFunction *func = module->functions[f];
-        bool *reachable = calloc(func->instruction_count, sizeof(bool));
+        size_t n = func->instruction_count;
+        if (n == 0) continue;
         
-        // Mark all instructions as reachable initially (simplified)
-        // A full implementation would do control flow analysis
-        for (size_t i = 0; i < func->instruction_count; i++) {
-            reachable[i] = true;
+        CFG *cfg = cfg_build(func);
+        if (cfg->loop_count == 0) {
+            cfg_free(cfg);
+            continue;
+        }
+        
+        LicmState state = { module, func, pure, NULL, NULL, NULL, func->temp_count, {0} };
+        loop_memory_init(&state.memory, func);
+        for (size_t i = 0; i < n; i++) {
+            IROperand *dest = func->instructions[i]->dest;
+            if (dest && dest->kind == IR_OP_TEMP && dest->data.temp_id >= 0 &&
+                (size_t)dest->data.temp_id >= state.temp_limit) {
+                state.temp_limit = (size_t)dest->data.temp_id + 1;
+            }
+        }
+        state.def_count = calloc(state.temp_limit + 1, sizeof(size_t));
+        state.def_index = calloc(state.temp_limit + 1, sizeof(size_t));
+        state.hoisted = calloc(n, sizeof(bool));
+        for (size_t i = 0; i < n; i++) {
+            IROperand *dest = func->instructions[i]->dest;
+            if (dest && dest->kind == IR_OP_TEMP && temp_in_range(&state, dest)) {
+                state.def_count[dest->data.temp_id]++;
+                state.def_index[dest->data.temp_id] = i;
+            }
+        }
+        
+        // Hoisted instructions, chained per insertion point in the order
+        // they were hoisted, which puts definitions before their uses
+        size_t *head = malloc(n * sizeof(size_t));
+        size_t *tail = malloc(n * sizeof(size_t));
+        size_t *next = malloc(n * sizeof(size_t));
+        for (size_t i = 0; i < n; i++) head[i] = tail[i] = next[i] = CFG_NONE;
+        
+        // Outer loops come first, so an instruction lands in the preheader
+        // of the outermost loop it is invariant in, which is where hoisting
+        // the nest from the inside out would leave it too. Each loop is
+        // scanned until nothing more moves, since a hoist can make an
+        // earlier instruction invariant.
+        for (size_t l = 0; l < cfg->loop_count; l++) {
+            CFGLoop *loop = &cfg->loops[l];
+            size_t target = loop_preheader_position(cfg, loop);
+            if (target == CFG_NONE) continue;
+            loop_memory_collect_writes(&state.memory, cfg, loop);
             
-            // Mark code after unconditional return as unreachable
-            if (func->instructions[i]->opcode == IR_RETURN) {
-                // Mark subsequent non-label instructions as unreachable
-                for (size_t j = i + 1; j < func->instruction_count; j++) {
-                    if (func->instructions[j]->opcode == IR_LABEL) {
-                        break; // Stop at next label
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (size_t b = 0; b < loop->block_count; b++) {
+                    BasicBlock *block = &cfg->blocks[loop->blocks[b]];
+                    for (size_t k = block->start; k < block->end; k++) {
+                        if (state.hoisted[k]) continue;
+                        if (!is_instruction_invariant(func->instructions[k], cfg, l, &state)) continue;
+                        
+                        state.hoisted[k] = true;
+                        changed = true;
+                        if (head[target] == CFG_NONE) head[target] = k;
+                        else next[tail[target]] = k;
+                        tail[target] = k;
                     }
-                    reachable[j] = false;
                 }
             }
         }
         
-        // Remove unreachable instructions and NOPs
-        size_t write_idx = 0;
-        for (size_t read_idx = 0; read_idx < func->instruction_count; read_idx++) {
-            IRInstruction *instr = func->instructions[read_idx]; // temp ptr
-            if (reachable[read_idx] && instr->opcode != IR_NOP) {
-                func->instructions[write_idx++] = func->instructions[read_idx];
-            } else {
-                ir_instruction_free(func->instructions[read_idx]);
+        // Actually move the hoisted instructions
+        IRInstruction **new_instructions = malloc(n * sizeof(IRInstruction*));
+        size_t new_count = 0;
+        for (size_t i = 0; i < n; i++) {
+            for (size_t k = head[i]; k != CFG_NONE; k = next[k]) {
+                new_instructions[new_count++] = func->instructions[k];
+            }
+            if (!state.hoisted[i]) {
+                new_instructions[new_count++] = func->instructions[i];
             }
         }
-        func->instruction_count = write_idx;
         
-        free(reachable);
+        free(func->instructions);
+        func->instructions = new_instructions;
+        func->instruction_count = new_count;
+        func->instruction_capacity = n;
+        
+        free(head);
+        free(tail);
+        free(next);
+        free(state.def_count);
+        free(state.def_index);
+        free(state.hoisted);
+        loop_memory_free(&state.memory);
+        cfg_free(cfg);
+    }
+    free(pure);
+}
+
+// Basic induction variable of a loop: a header phi
+// i = PHI [preheader: init], [latch: next] with next = i + step
+typedef struct {
+    size_t phi;             // Instruction index of the phi
+    int temp;
+    size_t init_arg;        // Index of the preheader's label in the phi's args
+    size_t next;            // Instruction index of the increment
+    int next_temp;
+    IROperand *step;
+    bool dead;              // Merged into another IV or replaced by one
+} BasicIV;
+
+// Derived induction variable i * factor, kept as an IV of its own
+typedef struct {
+    size_t iv;
+    IROperand *factor;
+    int temp;
+} ReducedIV;
+
+// Instruction to insert while rebuilding the array, in the order added
+typedef struct {
+    size_t at;
+    bool before;
+    size_t order;
+    IRInstruction *instr;
+} IVInsert;
+
+typedef struct {
+    IRFunction *func;
+    CFG *cfg;
+    SSAInfo *info;
+    LoopMemory *memory;
+    size_t loop;
+    size_t preheader;       // The one block outside the loop entering its header
+    BasicIV *ivs;
+    size_t iv_count;
+    ReducedIV *reduced;
+    size_t reduced_count;
+    IVInsert *inserts;
+    size_t insert_count;
+} IVState;
+
+// Loop-invariant value the preheader can compute: a constant, a temp
+// defined outside the loop, or a variable the loop doesn't change
+static bool iv_invariant(IVState *state, IROperand *op) {
+    if (!op) return false;
+    if (op->kind == IR_OP_CONST) return true;
+    if (op->kind == IR_OP_VAR) return loop_memory_invariant(state->memory, op->data.var_name);
+    if (!is_ssa_temp(state->info, op)) return false;
+    size_t block = state->cfg->block_of[state->info->def[op->data.temp_id]];
+    return !cfg_loop_contains(state->cfg, state->loop, block) && cfg_dominates(state->cfg, block, state->preheader);
+}
+
+// The constant a temp was only ever copied from, so starting values
+// compare and fold as constants
+static IROperand *iv_value(IVState *state, IROperand *op) {
+    if (!is_ssa_temp(state->info, op)) return op;
+    IRInstruction *def = state->func->instructions[state->info->def[op->data.temp_id]];
+    return def->opcode == IR_MOVE && is_const(def->src1) ? def->src1 : op;
+}
+
+static bool same_invariant(IROperand *a, IROperand *b) {
+    if (a->kind == IR_OP_VAR && b->kind == IR_OP_VAR) return strcmp(a->data.var_name, b->data.var_name) == 0;
+    return same_value(a, b);
+}
+
+static bool is_integer_type(const IRType *type) {
+    return !type->is_const && (type->kind == IR_TYPE_INT || type->kind == IR_TYPE_UINT);
+}
+
+static void iv_insert(IVState *state, size_t at, bool before, IRInstruction *instr) {
+    state->inserts = realloc(state->inserts, sizeof(IVInsert) * (state->insert_count + 1));
+    state->inserts[state->insert_count] = (IVInsert){ at, before, state->insert_count, instr };
+    state->insert_count++;
+}
+
+// Append to the preheader, ahead of the jump or branch ending it
+static void iv_insert_preheader(IVState *state, IRInstruction *instr) {
+    size_t last = state->cfg->blocks[state->preheader].end - 1;
+    IROpcode opcode = state->func->instructions[last]->opcode;
+    bool terminator = opcode == IR_JUMP || opcode == IR_BRANCH || opcode == IR_SWITCH;
+    iv_insert(state, last, terminator, instr);
+}
+
+// a * b of two invariants: folded, or computed once in the preheader
+static IROperand *iv_product(IVState *state, IROperand *a, IROperand *b, const IRType *type) {
+    long value;
+    if (is_const(a) && is_const(b) && fold_binary(IR_MUL, get_const(a), get_const(b), &value) &&
+        ssa_const_fits(type, value)) {
+        return ir_operand_const(value);
+    }
+    if ((is_const(a) && get_const(a) == 0) || (is_const(b) && get_const(b) == 0)) return ir_operand_const(0);
+    if (is_const(b) && get_const(b) == 1) return ir_operand_clone(a);
+    if (is_const(a) && get_const(a) == 1) return ir_operand_clone(b);
+
+    int temp = ir_function_new_temp(state->func, type);
+    iv_insert_preheader(state, ir_instruction_create(IR_MUL, ir_operand_temp(temp),
+                                                     ir_operand_clone(a), ir_operand_clone(b)));
+    return ir_operand_temp(temp);
+}
+
+static bool is_temp(IROperand *op, int temp) {
+    return op && op->kind == IR_OP_TEMP && op->data.temp_id == temp;
+}
+
+static void find_temp_identifier(const char *ident, size_t len, void *ctx) {
+    int *temp = ctx;
+    if (*temp >= 0 && ir_temp_identifier(ident, len) == *temp) *temp = -1;
+}
+
+// Reads of a temp anywhere in the function; the last one is stored in
+// *where. A temp named inside a VAR expression counts as read too often
+// to be rewritten.
+static size_t iv_count_uses(IRFunction *func, int temp, size_t *where) {
+    size_t count = 0;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        IROperand **slot;
+        for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+            if (is_temp(*slot, temp)) {
+                count++;
+                *where = i;
+            }
+        }
+        for (size_t k = 0; k < 3 + instr->arg_count; k++) {
+            IROperand *op = k == 0 ? instr->dest : k == 1 ? instr->src1 : k == 2 ? instr->src2 : instr->args[k - 3];
+            if (!op || op->kind != IR_OP_VAR) continue;
+            int probe = temp;
+            ir_scan_identifiers(op->data.var_name, find_temp_identifier, &probe);
+            if (probe < 0) return SIZE_MAX;
+        }
+    }
+    return count;
+}
+
+static void iv_make_nop(IRFunction *func, size_t index) {
+    ir_instruction_free(func->instructions[index]);
+    func->instructions[index] = ir_instruction_create(IR_NOP, NULL, NULL, NULL);
+}
+
+// The increment feeding a header phi back around the loop, as a step
+static IROperand *iv_step(IVState *state, int temp, IROperand *next) {
+    if (!is_ssa_temp(state->info, next)) return NULL;
+    size_t def = state->info->def[next->data.temp_id];
+    if (!cfg_loop_contains(state->cfg, state->loop, state->cfg->block_of[def])) return NULL;
+    IRInstruction *instr = state->func->instructions[def];
+    if (ssa_temp_type(state->func, next->data.temp_id) != ssa_temp_type(state->func, temp)) return NULL;
+
+    if (instr->opcode == IR_ADD) {
+        if (is_temp(instr->src1, temp) && iv_invariant(state, instr->src2)) return ir_operand_clone(instr->src2);
+        if (is_temp(instr->src2, temp) && iv_invariant(state, instr->src1)) return ir_operand_clone(instr->src1);
+    }
+    if (instr->opcode == IR_SUB && is_temp(instr->src1, temp) && is_const(instr->src2) &&
+        get_const(instr->src2) != LONG_MIN) {
+        return ir_operand_const(-get_const(instr->src2));
+    }
+    return NULL;
+}
+
+static void find_basic_ivs(IVState *state) {
+    BasicBlock *header = &state->cfg->blocks[state->cfg->loops[state->loop].header];
+    for (size_t i = header->start; i < header->end; i++) {
+        IRInstruction *phi = state->func->instructions[i];
+        if (phi->opcode == IR_LABEL) continue;
+        if (phi->opcode != IR_PHI) break;
+        if (phi->arg_count != 4 || !is_integer_type(ssa_temp_type(state->func, phi->dest->data.temp_id))) continue;
+
+        size_t init_arg = cfg_label_block(state->cfg, phi->args[0]->data.label_name) == state->preheader ? 0 : 2;
+        if (cfg_label_block(state->cfg, phi->args[init_arg]->data.label_name) != state->preheader) continue;
+        IROperand *next = phi->args[2 - init_arg + 1];
+        if (!phi->args[init_arg + 1]) continue;
+        IROperand *step = iv_step(state, phi->dest->data.temp_id, next);
+        if (!step) continue;
+
+        state->ivs = realloc(state->ivs, sizeof(BasicIV) * (state->iv_count + 1));
+        state->ivs[state->iv_count++] = (BasicIV){ i, phi->dest->data.temp_id, init_arg,
+                                                   state->info->def[next->data.temp_id], next->data.temp_id, step, false };
+    }
+}
+
+// Two IVs that start at the same value and move by the same step are
+// one: the later one's readers read the earlier one
+static void merge_redundant_ivs(IVState *state) {
+    IRFunction *func = state->func;
+    for (size_t j = 0; j < state->iv_count; j++) {
+        BasicIV *iv = &state->ivs[j];
+        IRInstruction *phi = func->instructions[iv->phi];
+        for (size_t i = 0; i < j; i++) {
+            BasicIV *kept = &state->ivs[i];
+            IRInstruction *kept_phi = func->instructions[kept->phi];
+            size_t where;
+            if (kept->dead || ssa_temp_type(func, kept->temp) != ssa_temp_type(func, iv->temp)) continue;
+            if (!same_invariant(iv_value(state, kept_phi->args[kept->init_arg + 1]),
+                                iv_value(state, phi->args[iv->init_arg + 1]))) continue;
+            if (!same_invariant(kept->step, iv->step)) continue;
+            if (iv_count_uses(func, iv->temp, &where) == SIZE_MAX) continue;
+
+            for (size_t k = 0; k < func->instruction_count; k++) {
+                IROperand **slot;
+                for (size_t u = 0; (slot = ir_instruction_use(func->instructions[k], u)); u++) {
+                    if (!is_temp(*slot, iv->temp)) continue;
+                    ir_operand_free(*slot);
+                    *slot = ir_operand_temp(kept->temp);
+                }
+            }
+            iv_make_nop(func, iv->phi);
+            if (iv_count_uses(func, iv->next_temp, &where) == 0) iv_make_nop(func, iv->next);
+            iv->dead = true;
+            break;
+        }
+    }
+}
+
+// The derived IV equal to ivs[iv] * factor, created on first use: a phi
+// next to the basic IV's starting at init * factor and stepping by
+// step * factor right after the basic IV's increment
+static ReducedIV *reduced_iv(IVState *state, size_t iv_index, IROperand *factor) {
+    for (size_t r = 0; r < state->reduced_count; r++) {
+        ReducedIV *reduced = &state->reduced[r];
+        if (reduced->iv == iv_index && same_invariant(reduced->factor, factor)) return reduced;
+    }
+
+    BasicIV *iv = &state->ivs[iv_index];
+    IRInstruction *phi = state->func->instructions[iv->phi];
+    const IRType *type = ssa_temp_type(state->func, iv->temp);
+    IROperand *init = iv_product(state, iv_value(state, phi->args[iv->init_arg + 1]), factor, type);
+    IROperand *stride = iv_product(state, iv->step, factor, type);
+    int temp = ir_function_new_temp(state->func, type);
+    int next = ir_function_new_temp(state->func, type);
+
+    IRInstruction *new_phi = ir_instruction_create(IR_PHI, ir_operand_temp(temp), NULL, NULL);
+    new_phi->arg_count = 4;
+    new_phi->args = malloc(4 * sizeof(IROperand*));
+    for (size_t a = 0; a < 4; a += 2) {
+        new_phi->args[a] = ir_operand_clone(phi->args[a]);
+        new_phi->args[a + 1] = a == iv->init_arg ? init : ir_operand_temp(next);
+    }
+    iv_insert(state, iv->phi, false, new_phi);
+    iv_insert(state, iv->next, false, ir_instruction_create(IR_ADD, ir_operand_temp(next), ir_operand_temp(temp), stride));
+
+    state->reduced = realloc(state->reduced, sizeof(ReducedIV) * (state->reduced_count + 1));
+    state->reduced[state->reduced_count] = (ReducedIV){ iv_index, ir_operand_clone(factor), temp };
+    return &state->reduced[state->reduced_count++];
+}
+
+static size_t basic_iv_of(IVState *state, IROperand *op) {
+    if (!op || op->kind != IR_OP_TEMP) return CFG_NONE;
+    for (size_t i = 0; i < state->iv_count; i++) {
+        if (!state->ivs[i].dead && state->ivs[i].temp == op->data.temp_id) return i;
+    }
+    return CFG_NONE;
+}
+
+// Every i * factor in the loop, nested loops included, reads the derived
+// IV instead of multiplying
+static bool reduce_multiplies(IVState *state) {
+    CFGLoop *loop = &state->cfg->loops[state->loop];
+    bool changed = false;
+    for (size_t b = 0; b < loop->block_count; b++) {
+        BasicBlock *block = &state->cfg->blocks[loop->blocks[b]];
+        for (size_t i = block->start; i < block->end; i++) {
+            IRInstruction *instr = state->func->instructions[i];
+            if (instr->opcode != IR_MUL || !instr->dest || instr->dest->kind != IR_OP_TEMP) continue;
+            size_t iv = basic_iv_of(state, instr->src1);
+            IROperand *factor = instr->src2;
+            if (iv == CFG_NONE) {
+                iv = basic_iv_of(state, instr->src2);
+                factor = instr->src1;
+            }
+            if (iv == CFG_NONE || !iv_invariant(state, factor)) continue;
+            if (ssa_temp_type(state->func, instr->dest->data.temp_id) != ssa_temp_type(state->func, state->ivs[iv].temp)) continue;
+
+            ReducedIV *reduced = reduced_iv(state, iv, factor);
+            ir_operand_free(instr->src1);
+            ir_operand_free(instr->src2);
+            instr->opcode = IR_MOVE;
+            instr->src1 = ir_operand_temp(reduced->temp);
+            instr->src2 = NULL;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+static bool reads_temp(IRInstruction *instr, int temp) {
+    IROperand **slot;
+    for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+        if (is_temp(*slot, temp)) return true;
+    }
+    return false;
+}
+
+static bool is_comparison(IROpcode opcode) {
+    return opcode == IR_LT || opcode == IR_LE || opcode == IR_GT || opcode == IR_GE ||
+           opcode == IR_EQ || opcode == IR_NE;
+}
+
+// Linear function test replacement: a basic IV read only by its own
+// increment and one comparison with an invariant bound, i < n, has the
+// comparison moved onto a derived IV with a positive constant factor,
+// i * c < n * c, and is deleted along with its increment. The two tests
+// only agree while n * c doesn't wrap, and the program never computes
+// n * c itself, so the bound must be a constant whose product fits the
+// counter's type. Narrower and unsigned counters keep their test.
+static void replace_exit_tests(IVState *state) {
+    IRFunction *func = state->func;
+    for (size_t r = 0; r < state->reduced_count; r++) {
+        ReducedIV *reduced = &state->reduced[r];
+        BasicIV *iv = &state->ivs[reduced->iv];
+        if (iv->dead || !is_const(reduced->factor) || get_const(reduced->factor) <= 0) continue;
+        const IRType *type = ssa_temp_type(func, iv->temp);
+        if (type->kind != IR_TYPE_INT || type->size < sizeof(int)) continue;
+
+        size_t where;
+        if (iv_count_uses(func, iv->next_temp, &where) != 1 || where != iv->phi) continue;
+        if (iv_count_uses(func, iv->temp, &where) != 2) continue;
+        size_t test = CFG_NONE;
+        for (size_t i = 0; i < func->instruction_count; i++) {
+            if (i != iv->next && reads_temp(func->instructions[i], iv->temp)) test = i;
+        }
+        if (test == CFG_NONE || !cfg_loop_contains(state->cfg, state->loop, state->cfg->block_of[test])) continue;
+        IRInstruction *cmp = func->instructions[test];
+        if (!is_comparison(cmp->opcode)) continue;
+        IROperand **bound = is_temp(cmp->src1, iv->temp) ? &cmp->src2 : &cmp->src1;
+        if (is_temp(*bound, iv->temp) || !is_const(*bound)) continue;
+        long product;
+        if (!fold_binary(IR_MUL, get_const(*bound), get_const(reduced->factor), &product) ||
+            !ssa_const_fits(type, product)) {
+            continue;
+        }
+
+        IROperand *scaled = iv_product(state, *bound, reduced->factor, type);
+        ir_operand_free(*bound);
+        *bound = scaled;
+        IROperand **counter = is_temp(cmp->src1, iv->temp) ? &cmp->src1 : &cmp->src2;
+        ir_operand_free(*counter);
+        *counter = ir_operand_temp(reduced->temp);
+
+        iv_make_nop(func, iv->phi);
+        iv_make_nop(func, iv->next);
+        iv->dead = true;
     }
 }
 
-// Copy propagation: Replace uses of copied values with the original
-void iropt_copy_propagation(IRModule *module) {
-    if (!module) return;
-    
-    for (size_t f = 0; f < module->function_count; f++) {
-        IRFunction *func = module->functions[f];
-        
-        // Simple copy propagation: t1 = t0; use(t1) -> use(t0)
-        for (size_t i = 0; i < func->instruction_count; i++) {
-            IRInstruction *instr = func->instructions[i];
-            
-            // Look for MOVE instructions: dest = src
-            if (instr->opcode != IR_MOVE) continue;
-            if (!instr->dest || !instr->src1) continue;
-            if (instr->dest->kind != IR_OP_TEMP) continue;
-            if (instr->src1->kind != IR_OP_TEMP) continue;
-            
-            int dest_temp = instr->dest->data.temp_id;
-            int src_temp = instr->src1->data.temp_id;
-            
-            // Replace uses of dest_temp with src_temp in subsequent instructions
-            for (size_t j = i + 1; j < func->instruction_count; j++) {
-                IRInstruction *use = func->instructions[j];
-                
-                // Check src1
-                if (use->src1 && use->src1->kind == IR_OP_TEMP && 
-                    use->src1->data.temp_id == dest_temp) {
-                    use->src1->data.temp_id = src_temp;
-                }
-                
-                // Check src2
-                if (use->src2 && use->src2->kind == IR_OP_TEMP && 
-                    use->src2->data.temp_id == dest_temp) {
-                    use->src2->data.temp_id = src_temp;
-                }
-                
-                // Stop if dest_temp is redefined
-                if (use->dest && use->dest->kind == IR_OP_TEMP && 
-                    use->dest->data.temp_id == dest_temp) {
-                    break;
-                }
-            }
+static int compare_inserts(const void *a, const void *b) {
+    const IVInsert *x = a, *y = b;
+    if (x->at != y->at) return x->at < y->at ? -1 : 1;
+    if (x->before != y->before) return x->before ? -1 : 1;
+    return x->order < y->order ? -1 : (x->order > y->order);
+}
+
+static void apply_inserts(IVState *state) {
+    IRFunction *func = state->func;
+    qsort(state->inserts, state->insert_count, sizeof(IVInsert), compare_inserts);
+    size_t count = func->instruction_count + state->insert_count;
+    IRInstruction **instructions = malloc(count * sizeof(IRInstruction*));
+    size_t n = 0, k = 0;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        while (k < state->insert_count && state->inserts[k].at == i && state->inserts[k].before) {
+            instructions[n++] = state->inserts[k++].instr;
+        }
+        instructions[n++] = func->instructions[i];
+        while (k < state->insert_count && state->inserts[k].at == i) {
+            instructions[n++] = state->inserts[k++].instr;
         }
     }
+    free(func->instructions);
+    func->instructions = instructions;
+    func->instruction_count = n;
+    func->instruction_capacity = count;
 }
 
-// Helper: Check if operand is loop-invariant (doesn't change in loop)
-static bool is_loop_invariant(IROperand *op, IRFunction *func, size_t loop_start, size_t loop_end) {
-    if (!op) return true;
-    
-    // Constants are always invariant
-    if (op->kind == IR_OP_CONST) return true;
-    
-    // Check if temp is modified in loop
-    if (op->kind == IR_OP_TEMP) {
-        int temp_id = op->data.temp_id;
-        for (size_t i = loop_start; i <= loop_end; i++) {
-            IRInstruction *instr = func->instructions[i];
-            if (instr->dest && instr->dest->kind == IR_OP_TEMP && 
-                instr->dest->data.temp_id == temp_id) {
-                return false; // Modified in loop
-            }
+// Induction variable optimization over SSA form, per natural loop.
+// Multiplying a basic IV by an invariant becomes a derived IV stepped
+// by addition, so a[y * w + x] costs an add per row instead of a
+// multiply. IVs that duplicate each other are merged, and a basic IV
+// left with nothing to do but decide when the loop exits has that test
+// rewritten onto a derived IV and is deleted. The copies left where
+// the multiplies were are for copy propagation and DCE.
+void iropt_induction_variables(IRFunction *func) {
+    if (!func || func->instruction_count == 0) return;
+
+    LoopMemory memory;
+    loop_memory_init(&memory, func);
+    CFG *cfg = cfg_build(func);
+    size_t loop_count = cfg->loop_count;
+
+    for (size_t l = 0; l < loop_count; l++) {
+        // Every loop sees the instruction indices the last one left
+        if (l > 0) {
+            cfg_free(cfg);
+            cfg = cfg_build(func);
         }
-        return true;
+        if (l >= cfg->loop_count) break;
+        CFGLoop *loop = &cfg->loops[l];
+        BasicBlock *header = &cfg->blocks[loop->header];
+        size_t preheader = CFG_NONE;
+        bool single_entry = true;
+        for (size_t p = 0; p < header->pred_count; p++) {
+            if (cfg_loop_contains(cfg, l, header->preds[p])) continue;
+            single_entry = preheader == CFG_NONE;
+            preheader = header->preds[p];
+        }
+        if (preheader == CFG_NONE || !single_entry) continue;
+
+        IVState state = { func, cfg, ssa_info_build(func, cfg), &memory, l, preheader, NULL, 0, NULL, 0, NULL, 0 };
+        loop_memory_collect_writes(&memory, cfg, loop);
+        find_basic_ivs(&state);
+        if (state.iv_count > 0) {
+            merge_redundant_ivs(&state);
+            if (reduce_multiplies(&state)) replace_exit_tests(&state);
+            if (state.insert_count > 0) apply_inserts(&state);
+        }
+
+        for (size_t i = 0; i < state.iv_count; i++) ir_operand_free(state.ivs[i].step);
+        for (size_t r = 0; r < state.reduced_count; r++) ir_operand_free(state.reduced[r].factor);
+        free(state.ivs);
+        free(state.reduced);
+        free(state.inserts);
+        ssa_info_free(state.info);
     }
-    
-    // Variables might be modified (conservative)
-    if (op->kind == IR_OP_VAR) return false;
-    
-    return true;
+
+    cfg_free(cfg);
+    loop_memory_free(&memory);
 }
 
-// Helper: Check if instruction is loop-invariant
-static bool is_instruction_invariant(IRInstruction *instr, IRFunction *func, size_t loop_start, size_t loop_end) {
-    // Only hoist pure operations (arithmetic, comparisons)
-    switch (instr->opcode) {
+static bool is_pure_operation(IROpcode opcode) {
+    switch (opcode) {
         case IR_ADD:
         case IR_SUB:
         case IR_MUL:
@@ -215,222 +1511,558 @@ static bool is_instruction_invariant(IRInstruction *instr, IRFunction *func, siz
         case IR_OR:
         case IR_NOT:
         case IR_NEG:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Operands as value-numbering keys: literals by value, SSA temps by id
+static bool gvn_operand_equal(IROperand *a, IROperand *b) {
+    if (!a || !b) return a == b;
+    if (a->kind != b->kind) return false;
+    if (a->kind == IR_OP_TEMP) return a->data.temp_id == b->data.temp_id;
+    return same_constant(a, b);
+}
+
+static uint64_t gvn_operand_bits(IROperand *op) {
+    if (!op) return 0;
+    if (op->kind == IR_OP_TEMP) return (uint64_t)op->data.temp_id;
+    if (op->kind == IR_OP_FLOAT) {
+        uint64_t bits;
+        memcpy(&bits, &op->data.float_value, sizeof(bits));
+        return bits;
+    }
+    return (uint64_t)op->data.const_value;
+}
+
+// Total order used to put commutative operands in a canonical order
+static int gvn_operand_compare(IROperand *a, IROperand *b) {
+    if (a->kind != b->kind) return a->kind < b->kind ? -1 : 1;
+    uint64_t x = gvn_operand_bits(a), y = gvn_operand_bits(b);
+    return x == y ? 0 : (x < y ? -1 : 1);
+}
+
+static uint64_t gvn_mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+// Rewrite an operation into the one form every equivalent spelling
+// shares: operands of commutative operators sorted, and a > b turned
+// into b < a (likewise >=)
+static void gvn_canonicalize(IRInstruction *instr) {
+    switch (instr->opcode) {
+        case IR_GT:
+            instr->opcode = IR_LT;
+            break;
+        case IR_GE:
+            instr->opcode = IR_LE;
+            break;
+        case IR_ADD:
+        case IR_MUL:
+        case IR_EQ:
+        case IR_NE:
+        case IR_AND:
+        case IR_OR:
+            if (gvn_operand_compare(instr->src1, instr->src2) <= 0) return;
             break;
         default:
-            return false; // Don't hoist memory ops, calls, etc.
+            return;
     }
-    
-    // Check if all operands are invariant
-    if (!is_loop_invariant(instr->src1, func, loop_start, loop_end)) return false;
-    if (!is_loop_invariant(instr->src2, func, loop_start, loop_end)) return false;
-    
-    return true;
+    IROperand *swap = instr->src1;
+    instr->src1 = instr->src2;
+    instr->src2 = swap;
 }
 
-// Loop Invariant Code Motion: Hoist invariant expressions outside loops
-void iropt_loop_invariant_code_motion(IRModule *module) {
-    if (!module) return;
+typedef struct {
+    size_t index;           // Instruction computing the value, CFG_NONE if empty
+    uint64_t hash;
+} GVNSlot;
+
+typedef struct {
+    IRFunction *func;
+    GVNSlot *slots;
+    size_t mask;
+    size_t *log;            // Filled slots in insertion order, for scoping
+    size_t log_count;
+} GVNTable;
+
+static uint64_t gvn_hash(IRFunction *func, IRInstruction *instr) {
+    uint64_t hash = gvn_mix(0, (uint64_t)instr->opcode);
+    hash = gvn_mix(hash, ((uint64_t)instr->src1->kind << 32) ^ gvn_operand_bits(instr->src1));
+    if (instr->src2) hash = gvn_mix(hash, ((uint64_t)instr->src2->kind << 32) ^ gvn_operand_bits(instr->src2));
+    return gvn_mix(hash, (uint64_t)(uintptr_t)ssa_temp_type(func, instr->dest->data.temp_id));
+}
+
+static bool gvn_same_expression(IRFunction *func, IRInstruction *a, IRInstruction *b) {
+    return a->opcode == b->opcode &&
+           gvn_operand_equal(a->src1, b->src1) &&
+           gvn_operand_equal(a->src2, b->src2) &&
+           ssa_temp_type(func, a->dest->data.temp_id) == ssa_temp_type(func, b->dest->data.temp_id);
+}
+
+// Earlier instruction computing the same value, or records this one
+static size_t gvn_lookup_or_insert(GVNTable *table, size_t index) {
+    IRInstruction *instr = table->func->instructions[index];
+    uint64_t hash = gvn_hash(table->func, instr);
+    size_t slot = (size_t)hash & table->mask;
+    while (table->slots[slot].index != CFG_NONE) {
+        GVNSlot *entry = &table->slots[slot];
+        if (entry->hash == hash &&
+            gvn_same_expression(table->func, table->func->instructions[entry->index], instr)) {
+            return entry->index;
+        }
+        slot = (slot + 1) & table->mask;
+    }
+    table->slots[slot].index = index;
+    table->slots[slot].hash = hash;
+    table->log[table->log_count++] = slot;
+    return CFG_NONE;
+}
+
+// Forget entries made since the log had mark entries. Removing in
+// reverse insertion order keeps linear probing chains intact.
+static void gvn_unwind(GVNTable *table, size_t mark) {
+    while (table->log_count > mark) {
+        table->slots[table->log[--table->log_count]].index = CFG_NONE;
+    }
+}
+
+// Global value numbering over SSA form: an operation on the same values
+// as one that dominates it is replaced by a copy of that result. Walks
+// the dominator tree with a scoped hash table of the expressions
+// available on the current path, after rewriting operands to their
+// value numbers and commutative operations to a canonical order.
+void iropt_global_value_numbering(IRFunction *func) {
+    if (!func || func->instruction_count == 0) return;
     
-    for (size_t f = 0; f < module->function_count; f++) {
-        IRFunction *func = module->functions[f];
-        
-        // Track which instructions to hoist and where
-        bool *to_hoist = calloc(func->instruction_count, sizeof(bool));
-        size_t *hoist_target = calloc(func->instruction_count, sizeof(size_t));
-        
-        // Detect loops: look for backward jumps (jump to earlier label)
-        for (size_t i = 0; i < func->instruction_count; i++) {
-            IRInstruction *instr = func->instructions[i];
-            
-            // Look for conditional branches that jump backward
-            if (instr->opcode == IR_BRANCH && instr->src2 && instr->src2->kind == IR_OP_LABEL) {
-                const char *target_label = instr->src2->data.label_name;
-                
-                // Find the target label (should be before current instruction)
-                size_t loop_start = 0;
-                bool found_loop = false;
-                
-                for (size_t j = 0; j < i; j++) {
-                    IRInstruction *label_instr = func->instructions[j];
-                    if (label_instr->opcode == IR_LABEL && 
-                        label_instr->dest && 
-                        label_instr->dest->kind == IR_OP_LABEL &&
-                        strcmp(label_instr->dest->data.label_name, target_label) == 0) {
-                        loop_start = j;
-                        found_loop = true;
-                        break;
-                    }
+    CFG *cfg = cfg_build(func);
+    SSAInfo *info = ssa_info_build(func, cfg);
+    size_t count = cfg->block_count;
+    size_t n = func->instruction_count;
+    
+    size_t *child_start = calloc(count + 1, sizeof(size_t));
+    size_t *children = malloc((count + 1) * sizeof(size_t));
+    for (size_t i = 1; i < cfg->rpo_count; i++) child_start[cfg->blocks[cfg->rpo[i]].idom + 1]++;
+    for (size_t b = 0; b < count; b++) child_start[b + 1] += child_start[b];
+    size_t *fill = malloc((count + 1) * sizeof(size_t));
+    memcpy(fill, child_start, count * sizeof(size_t));
+    for (size_t i = 1; i < cfg->rpo_count; i++) {
+        size_t b = cfg->rpo[i];
+        children[fill[cfg->blocks[b].idom]++] = b;
+    }
+    
+    GVNTable table = { .func = func };
+    size_t capacity = 16;
+    while (capacity < n * 2) capacity *= 2;
+    table.slots = malloc(capacity * sizeof(GVNSlot));
+    for (size_t s = 0; s < capacity; s++) table.slots[s].index = CFG_NONE;
+    table.mask = capacity - 1;
+    table.log = malloc((n + 1) * sizeof(size_t));
+    
+    // Value number of each SSA temp: the temp holding the same value
+    // first, so redundant results read the original
+    int *number = malloc((info->temp_limit + 1) * sizeof(int));
+    for (size_t t = 0; t < info->temp_limit; t++) number[t] = (int)t;
+    
+    size_t *mark = malloc((count + 1) * sizeof(size_t));
+    size_t *stack = malloc((count + 1) * sizeof(size_t));
+    size_t *next_child = calloc(count + 1, sizeof(size_t));
+    size_t depth = 0;
+    
+    stack[depth++] = 0;
+    mark[0] = 0;
+    bool entered = false;
+    while (depth > 0) {
+        size_t b = stack[depth - 1];
+        if (!entered) {
+            BasicBlock *block = &cfg->blocks[b];
+            for (size_t i = block->start; i < block->end; i++) {
+                IRInstruction *instr = func->instructions[i];
+                IROperand **slot;
+                for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+                    if (is_ssa_temp(info, *slot)) (*slot)->data.temp_id = number[(*slot)->data.temp_id];
                 }
+                if (!is_ssa_temp(info, instr->dest) || info->pinned[instr->dest->data.temp_id]) continue;
+                int dest = instr->dest->data.temp_id;
                 
-                if (!found_loop) continue;
+                IROperand *copied = copy_source(func, info, instr);
+                if (copied && instr->opcode != IR_PHI) {
+                    number[dest] = copied->data.temp_id;
+                    continue;
+                }
+                if (!is_pure_operation(instr->opcode)) continue;
+                if (!ssa_is_value(info, instr->src1)) continue;
+                if (instr->src2 && !ssa_is_value(info, instr->src2)) continue;
                 
-                size_t loop_end = i;
+                gvn_canonicalize(instr);
+                size_t prev = gvn_lookup_or_insert(&table, i);
+                if (prev == CFG_NONE) continue;
                 
-                // Find invariant instructions in loop
-                for (size_t k = loop_start + 1; k < loop_end; k++) {
-                    IRInstruction *loop_instr = func->instructions[k];
-                    
-                    // Skip if already marked for hoisting
-                    if (to_hoist[k]) continue;
-                    
-                    // Skip labels, jumps, etc.
-                    if (!loop_instr->dest) continue;
-                    if (loop_instr->dest->kind != IR_OP_TEMP) continue;
-                    
-                    // Check if this instruction is loop-invariant
-                    if (is_instruction_invariant(loop_instr, func, loop_start, loop_end)) {
-                        // Mark for hoisting before loop label
-                        to_hoist[k] = true;
-                        hoist_target[k] = loop_start;
-                    }
-                }
+                // Replace current instruction with MOVE from previous result
+                int original = func->instructions[prev]->dest->data.temp_id;
+                ir_operand_free(instr->src1);
+                ir_operand_free(instr->src2);
+                instr->opcode = IR_MOVE;
+                instr->src1 = ir_operand_temp(original);
+                instr->src2 = NULL;
+                number[dest] = original;
             }
         }
         
-        // Actually move the hoisted instructions
-        // Build new instruction array with hoisted instructions moved
-        IRInstruction **new_instructions = malloc(func->instruction_count * sizeof(IRInstruction*));
-        size_t new_count = 0;
-        
-        for (size_t i = 0; i < func->instruction_count; i++) {
-            // First, insert any instructions that should be hoisted to this position
-            for (size_t j = 0; j < func->instruction_count; j++) {
-                if (to_hoist[j] && hoist_target[j] == i) {
-                    new_instructions[new_count++] = func->instructions[j];
-                }
-            }
-            
-            // Then add the current instruction if it wasn't hoisted
-            if (!to_hoist[i]) {
-                new_instructions[new_count++] = func->instructions[i];
+        size_t c = child_start[b] + next_child[b];
+        if (c < child_start[b + 1]) {
+            next_child[b]++;
+            size_t child = children[c];
+            mark[child] = table.log_count;
+            stack[depth++] = child;
+            entered = false;
+        } else {
+            gvn_unwind(&table, mark[b]);
+            depth--;
+            entered = true;
+        }
+    }
+    
+    free(table.slots);
+    free(table.log);
+    free(number);
+    free(mark);
+    free(stack);
+    free(next_child);
+    free(child_start);
+    free(children);
+    free(fill);
+    ssa_info_free(info);
+    cfg_free(cfg);
+}
+
+// Whether evaluating an operand only reads a value: anything but a VAR
+// expression, which may dereference memory
+static bool is_plain_read(IROperand *op) {
+    if (!op || op->kind != IR_OP_VAR) return true;
+    for (const char *c = op->data.var_name; *c; c++) {
+        if (!isalnum((unsigned char)*c) && *c != '_') return false;
+    }
+    return true;
+}
+
+// Calls into the runtime's math library have no side effects
+static bool is_pure_call(IRInstruction *instr) {
+    if (instr->opcode != IR_CALL || !instr->src1 || instr->src1->kind != IR_OP_VAR) return false;
+    if (strncmp(instr->src1->data.var_name, "virex_math_", 11) != 0) return false;
+    for (size_t a = 0; a < instr->arg_count; a++) {
+        if (!is_plain_read(instr->args[a])) return false;
+    }
+    return true;
+}
+
+// Whether removing an unused instruction can't change behaviour
+static bool is_removable(IRInstruction *instr) {
+    if (!is_plain_read(instr->src1) || !is_plain_read(instr->src2)) return false;
+    switch (instr->opcode) {
+        case IR_DIV:
+        case IR_MOD:
+            if (instr->src2->kind == IR_OP_FLOAT) return true;
+            return is_const(instr->src2) && get_const(instr->src2) != 0;
+        case IR_MOVE:
+        case IR_LOAD:
+        case IR_CAST:
+        case IR_PHI:
+            return true;
+        case IR_CALL:
+            return is_pure_call(instr);
+        default:
+            return is_pure_operation(instr->opcode);
+    }
+}
+
+// Dead code elimination over SSA form: mark everything with an effect,
+// then everything those read, and delete the rest. Cycles of phis and
+// increments nothing else reads die too.
+void iropt_dead_value_elimination(IRFunction *func) {
+    if (!func || func->instruction_count == 0) return;
+    
+    CFG *cfg = cfg_build(func);
+    SSAInfo *info = ssa_info_build(func, cfg);
+    size_t n = func->instruction_count;
+    bool *live = calloc(n, sizeof(bool));
+    size_t *worklist = malloc(n * sizeof(size_t));
+    size_t top = 0;
+    
+    for (size_t i = 0; i < n; i++) {
+        IRInstruction *instr = func->instructions[i];
+        bool root = !is_ssa_temp(info, instr->dest) || info->pinned[instr->dest->data.temp_id] ||
+                    !is_removable(instr);
+        if (instr->opcode == IR_NOP || (!instr->dest && is_pure_call(instr))) root = false;
+        if (root) {
+            live[i] = true;
+            worklist[top++] = i;
+        }
+    }
+    while (top > 0) {
+        IRInstruction *instr = func->instructions[worklist[--top]];
+        IROperand **slot;
+        for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+            if (!is_ssa_temp(info, *slot)) continue;
+            size_t def = info->def[(*slot)->data.temp_id];
+            if (!live[def]) {
+                live[def] = true;
+                worklist[top++] = def;
             }
         }
+    }
+    
+    for (size_t i = 0; i < n; i++) {
+        if (live[i] || func->instructions[i]->opcode == IR_NOP) continue;
+        ir_instruction_free(func->instructions[i]);
+        func->instructions[i] = ir_instruction_create(IR_NOP, NULL, NULL, NULL);
+    }
+    
+    free(live);
+    free(worklist);
+    ssa_info_free(info);
+    cfg_free(cfg);
+}
+
+// Delete computations whose temp is never read, and the computations
+// feeding only those. Works on any IR: a temp with several definitions
+// dies once its last reader is gone.
+static void sweep_unused_temps(IRFunction *func, const SSAInfo *info) {
+    size_t n = func->instruction_count;
+    size_t limit = info->temp_limit;
+    size_t *uses = calloc(limit + 1, sizeof(size_t));
+    size_t *def_start = calloc(limit + 2, sizeof(size_t));
+    
+    for (size_t i = 0; i < n; i++) {
+        IRInstruction *instr = func->instructions[i];
+        IROperand **slot;
+        for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+            if ((*slot)->kind == IR_OP_TEMP && (*slot)->data.temp_id >= 0) uses[(*slot)->data.temp_id]++;
+        }
+        if (instr->dest && instr->dest->kind == IR_OP_TEMP && instr->dest->data.temp_id >= 0) {
+            def_start[instr->dest->data.temp_id + 1]++;
+        }
+    }
+    for (size_t t = 0; t < limit; t++) def_start[t + 1] += def_start[t];
+    size_t *defs = malloc((def_start[limit] + 1) * sizeof(size_t));
+    size_t *fill = malloc((limit + 1) * sizeof(size_t));
+    memcpy(fill, def_start, (limit + 1) * sizeof(size_t));
+    for (size_t i = 0; i < n; i++) {
+        IROperand *dest = func->instructions[i]->dest;
+        if (dest && dest->kind == IR_OP_TEMP && dest->data.temp_id >= 0) defs[fill[dest->data.temp_id]++] = i;
+    }
+    
+    size_t *worklist = malloc((n + 1) * sizeof(size_t));
+    size_t top = 0;
+    for (size_t t = 0; t < limit; t++) {
+        if (uses[t] > 0 || info->pinned[t]) continue;
+        for (size_t d = def_start[t]; d < def_start[t + 1]; d++) worklist[top++] = defs[d];
+    }
+    while (top > 0) {
+        size_t i = worklist[--top];
+        IRInstruction *instr = func->instructions[i];
+        if (instr->opcode == IR_NOP || !is_removable(instr)) continue;
         
-        // Replace the instruction array
-        free(func->instructions);
-        func->instructions = new_instructions;
-        func->instruction_count = new_count;
-        
-        free(to_hoist);
-        free(hoist_target);
+        IROperand **slot;
+        for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+            if ((*slot)->kind != IR_OP_TEMP || (*slot)->data.temp_id < 0) continue;
+            int t = (*slot)->data.temp_id;
+            if (--uses[t] > 0 || info->pinned[t]) continue;
+            for (size_t d = def_start[t]; d < def_start[t + 1]; d++) worklist[top++] = defs[d];
+        }
+        ir_instruction_free(instr);
+        func->instructions[i] = ir_instruction_create(IR_NOP, NULL, NULL, NULL);
     }
+    
+    free(uses);
+    free(def_start);
+    free(defs);
+    free(fill);
+    free(worklist);
 }
 
-// Run all optimizations
-void iropt_optimize(IRModule *module) {
-    if (!module) return;
+typedef struct {
+    int *renumber;          // Old temp id -> new, -1 when unused
+    size_t limit;
+} TempRenumber;
+
+static void mark_named_temp(const char *ident, size_t len, void *ctx) {
+    TempRenumber *map = ctx;
+    int temp = ir_temp_identifier(ident, len);
+    if (temp >= 0 && (size_t)temp < map->limit) map->renumber[temp] = 0;
+}
+
+static void mark_operand_temps(TempRenumber *map, IROperand *op) {
+    if (!op) return;
+    if (op->kind == IR_OP_TEMP && op->data.temp_id >= 0 && (size_t)op->data.temp_id < map->limit) {
+        map->renumber[op->data.temp_id] = 0;
+    } else if (op->kind == IR_OP_VAR) {
+        ir_scan_identifiers(op->data.var_name, mark_named_temp, map);
+    }
+}
+
+static bool rename_named_temp(const char *ident, size_t len, char *out, size_t out_size, void *ctx) {
+    const TempRenumber *map = ctx;
+    int temp = ir_temp_identifier(ident, len);
+    if (temp < 0 || (size_t)temp >= map->limit) return false;
+    snprintf(out, out_size, "t%d", map->renumber[temp]);
+    return true;
+}
+
+static void renumber_operand(const TempRenumber *map, IROperand *op) {
+    if (!op) return;
+    if (op->kind == IR_OP_TEMP && op->data.temp_id >= 0 && (size_t)op->data.temp_id < map->limit) {
+        op->data.temp_id = map->renumber[op->data.temp_id];
+    } else if (op->kind == IR_OP_VAR) {
+        char *renamed = ir_rename_identifiers(op->data.var_name, rename_named_temp, (void*)map);
+        op->data.var_name = intern(renamed);
+        free(renamed);
+    }
+}
+
+// Number the temps still in use densely and drop the rest from
+// temp_types, so the emitted C only declares what it uses
+static void compact_temps(IRFunction *func, size_t limit) {
+    TempRenumber map = { malloc((limit + 1) * sizeof(int)), limit };
+    for (size_t t = 0; t < limit; t++) map.renumber[t] = -1;
+    
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        mark_operand_temps(&map, instr->dest);
+        mark_operand_temps(&map, instr->src1);
+        mark_operand_temps(&map, instr->src2);
+        for (size_t a = 0; a < instr->arg_count; a++) mark_operand_temps(&map, instr->args[a]);
+    }
+    
+    size_t count = 0;
+    for (size_t t = 0; t < limit; t++) {
+        if (map.renumber[t] < 0) continue;
+        const IRType *type = (func->temp_types && t < func->temp_count) ? func->temp_types[t] : NULL;
+        map.renumber[t] = (int)count;
+        if (func->temp_types) func->temp_types[count] = type;
+        count++;
+    }
+    if (!func->temp_types && count > 0) func->temp_types = calloc(count, sizeof(IRType*));
+    func->temp_count = count;
+    
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        renumber_operand(&map, instr->dest);
+        renumber_operand(&map, instr->src1);
+        renumber_operand(&map, instr->src2);
+        for (size_t a = 0; a < instr->arg_count; a++) renumber_operand(&map, instr->args[a]);
+    }
+    free(map.renumber);
+}
+
+typedef struct {
+    const char *name;       // Array locals are declared as "name[size]"
+    size_t length;
+    size_t index;
+} LocalName;
+
+typedef struct {
+    LocalName *sorted;
+    size_t count;
+    bool *used;
+} LocalUse;
+
+static int compare_names(const char *a, size_t a_len, const char *b, size_t b_len) {
+    int cmp = strncmp(a, b, a_len < b_len ? a_len : b_len);
+    if (cmp != 0) return cmp;
+    return a_len == b_len ? 0 : (a_len < b_len ? -1 : 1);
+}
+
+static int compare_local_names(const void *a, const void *b) {
+    const LocalName *x = a, *y = b;
+    return compare_names(x->name, x->length, y->name, y->length);
+}
+
+static void mark_named_local(const char *ident, size_t len, void *ctx) {
+    LocalUse *use = ctx;
+    size_t lo = 0, hi = use->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = compare_names(use->sorted[mid].name, use->sorted[mid].length, ident, len);
+        if (cmp == 0) {
+            use->used[use->sorted[mid].index] = true;
+            return;
+        }
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+}
+
+// Drop locals nothing names any more, such as the ones SSA promoted
+static void prune_locals(IRFunction *func) {
+    if (func->local_var_count == 0) return;
+    LocalUse use = { malloc(func->local_var_count * sizeof(LocalName)), func->local_var_count,
+                     calloc(func->local_var_count, sizeof(bool)) };
+    for (size_t i = 0; i < func->local_var_count; i++) {
+        use.sorted[i].name = func->local_vars[i];
+        use.sorted[i].length = strcspn(func->local_vars[i], "[");
+        use.sorted[i].index = i;
+    }
+    qsort(use.sorted, use.count, sizeof(LocalName), compare_local_names);
     
-    // Run optimization passes
-    iropt_constant_folding(module);
-    iropt_copy_propagation(module);
-    iropt_common_subexpression_elimination(module);  // CSE - eliminate redundant computations
-    iropt_loop_invariant_code_motion(module);
-    iropt_strength_reduction(module);  // Replace expensive ops with cheaper ones
-    iropt_dead_store_elimination_loops(module);  // Remove redundant stores
-    iropt_dead_code_elimination(module);
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        IROperand *ops[3] = { instr->dest, instr->src1, instr->src2 };
+        for (size_t k = 0; k < 3; k++) {
+            if (ops[k] && ops[k]->kind == IR_OP_VAR) ir_scan_identifiers(ops[k]->data.var_name, mark_named_local, &use);
+        }
+        for (size_t a = 0; a < instr->arg_count; a++) {
+            if (instr->args[a] && instr->args[a]->kind == IR_OP_VAR) {
+                ir_scan_identifiers(instr->args[a]->data.var_name, mark_named_local, &use);
+            }
+        }
+    }
     
-    // Could run multiple iterations for better results
-    // For now, single pass is sufficient
+    size_t kept = 0;
+    for (size_t i = 0; i < func->local_var_count; i++) {
+        if (use.used[i]) {
+            func->local_vars[kept] = func->local_vars[i];
+            if (func->local_var_types) func->local_var_types[kept] = func->local_var_types[i];
+            kept++;
+        } else {
+            free(func->local_vars[i]);
+        }
+    }
+    func->local_var_count = kept;
+    free(use.sorted);
+    free(use.used);
 }
 
-// Common Subexpression Elimination: Reuse already-computed values
-void iropt_common_subexpression_elimination(IRModule *module) {
+// Dead code elimination: remove unreachable blocks, computations nothing
+// reads, NOPs, and the temps and locals left without a use
+void iropt_dead_code_elimination(IRModule *module) {
     if (!module) return;
     
     for (size_t f = 0; f < module->function_count; f++) {
         IRFunction *func = module->functions[f];
+        CFG *cfg = cfg_build(func);
+        SSAInfo *info = ssa_info_build(func, cfg);
+        sweep_unused_temps(func, info);
         
-        // For each instruction, check if we've already computed this expression
-        for (size_t i = 0; i < func->instruction_count; i++) {
-            IRInstruction *instr = func->instructions[i];
-            
-            // Only optimize pure binary operations
-            if (!instr->dest || instr->dest->kind != IR_OP_TEMP) continue;
-            if (!instr->src1 || !instr->src2) continue;
-            
-            // Check if this is a pure operation
-            bool is_pure = false;
-            switch (instr->opcode) {
-                case IR_ADD:
-                case IR_SUB:
-                case IR_MUL:
-                case IR_DIV:
-                case IR_MOD:
-                case IR_EQ:
-                case IR_NE:
-                case IR_LT:
-                case IR_LE:
-                case IR_GT:
-                case IR_GE:
-                    is_pure = true;
-                    break;
-                default:
-                    break;
-            }
-            
-            if (!is_pure) continue;
-            
-            // Look backward for a matching expression
-            for (size_t j = 0; j < i; j++) {
-                IRInstruction *prev = func->instructions[j];
-                
-                // Must be same opcode
-                if (prev->opcode != instr->opcode) continue;
-                if (!prev->dest || prev->dest->kind != IR_OP_TEMP) continue;
-                if (!prev->src1 || !prev->src2) continue;
-                
-                // Check if operands match
-                bool src1_match = false;
-                bool src2_match = false;
-                
-                // Compare src1
-                if (prev->src1->kind == instr->src1->kind) {
-                    if (prev->src1->kind == IR_OP_CONST) {
-                        src1_match = (prev->src1->data.const_value == instr->src1->data.const_value);
-                    } else if (prev->src1->kind == IR_OP_TEMP) {
-                        src1_match = (prev->src1->data.temp_id == instr->src1->data.temp_id);
-                    } else if (prev->src1->kind == IR_OP_VAR) {
-                        src1_match = (strcmp(prev->src1->data.var_name, instr->src1->data.var_name) == 0);
-                    }
-                }
-                
-                // Compare src2
-                if (prev->src2->kind == instr->src2->kind) {
-                    if (prev->src2->kind == IR_OP_CONST) {
-                        src2_match = (prev->src2->data.const_value == instr->src2->data.const_value);
-                    } else if (prev->src2->kind == IR_OP_TEMP) {
-                        src2_match = (prev->src2->data.temp_id == instr->src2->data.temp_id);
-                    } else if (prev->src2->kind == IR_OP_VAR) {
-                        src2_match = (strcmp(prev->src2->data.var_name, instr->src2->data.var_name) == 0);
-                    }
-                }
-                
-                if (src1_match && src2_match) {
-                    // Check that the previous result hasn't been redefined
-                    int prev_temp = prev->dest->data.temp_id;
-                    bool redefined = false;
-                    
-                    for (size_t k = j + 1; k < i; k++) {
-                        IRInstruction *between = func->instructions[k];
-                        if (between->dest && between->dest->kind == IR_OP_TEMP &&
-                            between->dest->data.temp_id == prev_temp) {
-                            redefined = true;
-                            break;
-                        }
-                    }
-                    
-                    if (!redefined) {
-                        // Replace current instruction with MOVE from previous result
-                        ir_operand_free(instr->src1);
-                        ir_operand_free(instr->src2);
-                        instr->opcode = IR_MOVE;
-                        instr->src1 = ir_operand_temp(prev_temp);
-                        instr->src2 = NULL;
-                        break; // Found a match, stop searching
-                    }
-                }
+        // A block no path from the entry reaches can go, label and all:
+        // every jump to its label is itself unreachable
+        size_t write_idx = 0;
+        for (size_t read_idx = 0; read_idx < func->instruction_count; read_idx++) {
+            IRInstruction *instr = func->instructions[read_idx];
+            if (cfg_reachable(cfg, cfg->block_of[read_idx]) && instr->opcode != IR_NOP) {
+                func->instructions[write_idx++] = instr;
+            } else {
+                ir_instruction_free(instr);
             }
         }
+        func->instruction_count = write_idx;
+        
+        compact_temps(func, info->temp_limit);
+        prune_locals(func);
+        ssa_info_free(info);
+        cfg_free(cfg);
     }
 }
 
@@ -518,62 +2150,3 @@ void iropt_strength_reduction(IRModule *module) {
         }
     }
 }
-
-// Dead Store Elimination in Loops: Remove stores that are immediately overwritten
-void iropt_dead_store_elimination_loops(IRModule *module) {
-    if (!module) return;
-    
-    for (size_t f = 0; f < module->function_count; f++) {
-        IRFunction *func = module->functions[f];
-        
-        // Look for stores that are overwritten before being read
-        for (size_t i = 0; i < func->instruction_count; i++) {
-            IRInstruction *instr = func->instructions[i];
-            
-            // Skip if not a store or assignment
-            if (!instr->dest || instr->dest->kind != IR_OP_TEMP) continue;
-            
-            int dest_temp = instr->dest->data.temp_id;
-            
-            // Look ahead to see if this value is used before being redefined
-            bool is_used = false;
-            bool is_redefined = false;
-            
-            for (size_t j = i + 1; j < func->instruction_count && j < i + 20; j++) {
-                IRInstruction *next = func->instructions[j];
-                
-                // Check if used
-                if (next->src1 && next->src1->kind == IR_OP_TEMP && next->src1->data.temp_id == dest_temp) {
-                    is_used = true;
-                    break;
-                }
-                if (next->src2 && next->src2->kind == IR_OP_TEMP && next->src2->data.temp_id == dest_temp) {
-                    is_used = true;
-                    break;
-                }
-                
-                // Check if redefined
-                if (next->dest && next->dest->kind == IR_OP_TEMP && next->dest->data.temp_id == dest_temp) {
-                    is_redefined = true;
-                    break;
-                }
-                
-                // Stop at labels (control flow boundary)
-                if (next->opcode == IR_LABEL) break;
-            }
-            
-            // If redefined before use, this is a dead store
-            if (is_redefined && !is_used) {
-                 // Safe to remove!
-                 // Replace with NOP
-                 if (instr->dest) ir_operand_free(instr->dest);
-                 if (instr->src1) ir_operand_free(instr->src1);
-                 if (instr->src2) ir_operand_free(instr->src2);
-                 instr->opcode = IR_NOP;
-                 instr->dest = NULL;
-                 instr->src1 = NULL;
-                 instr->src2 = NULL;
-            }
-        }
-    }
-}
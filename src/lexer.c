@@ -2,9 +2,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "../include/lexer.h"
 #include "../include/error.h"
+#include "../include/arena.h"
 
 // Keyword table
 typedef struct {
@@ -58,6 +62,64 @@ static const KeywordEntry keywords[] = {
     {NULL, TOKEN_EOF} // Sentinel
 };
 
+// Perfect hash over keywords[]: KEYWORD_HASH picks a unique slot for every
+// keyword, and keyword_slots maps the slot to its index + 1 (0 = empty).
+// The multipliers were found by brute-force search; when adding a keyword,
+// re-run the search and regenerate the table.
+#define KEYWORD_MIN_LENGTH 2
+#define KEYWORD_MAX_LENGTH 8
+#define KEYWORD_HASH(s, len) \
+    (((unsigned char)(s)[0] + (unsigned char)(s)[1] * 13u + (unsigned char)(s)[(len) - 1] + (unsigned)(len) * 8u) & 127u)
+
+static const unsigned char keyword_slots[128] = {
+     0,  0,  0,  0,  0,  0,  0,  0, 10, 28,  0,  0,  0,  4,  0,  0,
+     0, 38,  0,  7,  0, 32, 17,  0,  0,  0,  0, 18,  0, 39, 11,  0,
+    12,  0,  2,  0,  0, 16,  0,  0,  0,  0,  0, 14,  0,  0,  0,  0,
+     0,  8,  0,  0, 29,  0,  0, 24,  0,  0,  0, 19,  0,  0,  0, 13,
+    33,  0,  0, 26,  0,  0,  0, 36,  0,  0, 30,  0,  6,  0,  0,  0,
+     0,  0,  0,  0,  0,  0, 34,  0,  0,  0,  3,  0,  0,  0,  0, 21,
+    27,  0,  0,  0,  0,  0,  5,  0,  0,  0, 20, 22,  0,  1,  0,  0,
+    37, 25,  0, 31, 15,  0,  0,  0,  0,  0,  0,  9,  0, 23,  0, 35,
+};
+
+// Character classes
+enum {
+    CC_SPACE   = 1 << 0,
+    CC_NEWLINE = 1 << 1,
+    CC_ALPHA   = 1 << 2,  // [A-Za-z_]
+    CC_DIGIT   = 1 << 3,
+};
+#define CC_IDENT (CC_ALPHA | CC_DIGIT)
+
+#define S CC_SPACE
+#define N (CC_SPACE | CC_NEWLINE)
+#define A CC_ALPHA
+#define D CC_DIGIT
+static const unsigned char char_class[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, S, N, S, S, S, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    S, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0,
+    0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+    A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, A,
+    0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+    A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+#undef S
+#undef N
+#undef A
+#undef D
+
+#define IS_CLASS(c, cls) (char_class[(unsigned char)(c)] & (cls))
+
 // Helper functions
 static char lexer_peek_next(Lexer *lexer);
 static void lexer_advance(Lexer *lexer);
@@ -69,8 +131,80 @@ static Token *lexer_lex_string(Lexer *lexer);
 static bool lexer_match(Lexer *lexer, char expected);
 static char lexer_peek(Lexer *lexer);
 static bool lexer_is_at_end(Lexer *lexer);
-static Token *lexer_make_token(Lexer *lexer, TokenType type, const char *lexeme, size_t start_line, size_t start_column);
+static Token *lexer_make_token(Lexer *lexer, TokenType type, size_t start, size_t start_line, size_t start_column);
 static Token *lexer_error_token(Lexer *lexer, const char *message);
+static Token *lexer_scan(Lexer *lexer);
+
+// Bulk scanners. Each returns how many bytes of p[0, n) belong to the run;
+// the SSE2 paths look at 16 bytes per step and finish with the scalar loop.
+#ifdef __SSE2__
+static inline size_t sse2_first_zero(int mask) {
+    return (size_t)__builtin_ctz(~(unsigned)mask);
+}
+#endif
+
+// Identifier characters [A-Za-z0-9_]
+static size_t scan_ident(const char *p, size_t n) {
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i lower_a = _mm_set1_epi8('a' - 1), lower_z = _mm_set1_epi8('z' + 1);
+    const __m128i digit_0 = _mm_set1_epi8('0' - 1), digit_9 = _mm_set1_epi8('9' + 1);
+    const __m128i case_bit = _mm_set1_epi8(0x20), underscore = _mm_set1_epi8('_');
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        __m128i folded = _mm_or_si128(v, case_bit);
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(folded, lower_a), _mm_cmplt_epi8(folded, lower_z));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, digit_0), _mm_cmplt_epi8(v, digit_9));
+        __m128i ident = _mm_or_si128(_mm_or_si128(alpha, digit), _mm_cmpeq_epi8(v, underscore));
+        int mask = _mm_movemask_epi8(ident);
+        if (mask != 0xFFFF) return i + sse2_first_zero(mask);
+    }
+#endif
+    while (i < n && IS_CLASS(p[i], CC_IDENT)) i++;
+    return i;
+}
+
+// Horizontal whitespace (spaces and tabs, the bulk of indentation)
+static size_t scan_blanks(const char *p, size_t n) {
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)));
+        if (mask != 0xFFFF) return i + sse2_first_zero(mask);
+    }
+#endif
+    while (i < n && (p[i] == ' ' || p[i] == '\t')) i++;
+    return i;
+}
+
+// Bytes up to the first a, b or c
+static size_t scan_until(const char *p, size_t n, char a, char b, char c) {
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)), _mm_cmpeq_epi8(v, vc));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0) return i + (size_t)__builtin_ctz((unsigned)mask);
+    }
+#endif
+    while (i < n && p[i] != a && p[i] != b && p[i] != c) i++;
+    return i;
+}
+
+// Skip count bytes known to contain no newline
+static inline void lexer_skip(Lexer *lexer, size_t count) {
+    lexer->pos += count;
+    lexer->column += count;
+    lexer->current = lexer->source[lexer->pos];
+}
+
+static inline size_t lexer_remaining(Lexer *lexer) {
+    return lexer->length - lexer->pos;
+}
 
 Lexer *lexer_init(const char *source, const char *filename) {
     Lexer *lexer = malloc(sizeof(Lexer));
@@ -80,6 +214,7 @@ Lexer *lexer_init(const char *source, const char *filename) {
     }
     
     lexer->source = source;
+    lexer->length = strlen(source);
     lexer->filename = filename ? filename : "<input>";
     lexer->pos = 0;
     lexer->line = 1;
@@ -129,29 +264,32 @@ static void lexer_advance(Lexer *lexer) {
 }
 
 static void lexer_skip_whitespace(Lexer *lexer) {
-    while (isspace(lexer->current)) {
-        lexer_advance(lexer);
+    while (IS_CLASS(lexer->current, CC_SPACE)) {
+        if (lexer->current == ' ' || lexer->current == '\t') {
+            lexer_skip(lexer, scan_blanks(&lexer->source[lexer->pos], lexer_remaining(lexer)));
+        } else {
+            lexer_advance(lexer); // Newlines and other spaces do the line bookkeeping
+        }
     }
 }
 
 static bool lexer_skip_comment(Lexer *lexer) {
     // Single-line comment
     if (lexer->current == '/' && lexer_peek_next(lexer) == '/') {
-        while (lexer->current != '\n' && lexer->current != '\0') {
-            lexer_advance(lexer);
-        }
+        const char *rest = &lexer->source[lexer->pos];
+        const char *end = memchr(rest, '\n', lexer_remaining(lexer));
+        lexer_skip(lexer, end ? (size_t)(end - rest) : lexer_remaining(lexer));
         return true;
     }
     
     // Multi-line comment
     if (lexer->current == '/' && lexer_peek_next(lexer) == '*') {
-        lexer_advance(lexer); // consume '/'
-        lexer_advance(lexer); // consume '*'
+        lexer_skip(lexer, 2); // consume '/*'
         
         while (lexer->current != '\0') {
+            lexer_skip(lexer, scan_until(&lexer->source[lexer->pos], lexer_remaining(lexer), '*', '\n', '*'));
             if (lexer->current == '*' && lexer_peek_next(lexer) == '/') {
-                lexer_advance(lexer); // consume '*'
-                lexer_advance(lexer); // consume '/'
+                lexer_skip(lexer, 2); // consume '*/'
                 return true;
             }
             lexer_advance(lexer);
@@ -165,14 +303,17 @@ static bool lexer_skip_comment(Lexer *lexer) {
     return false;
 }
 
-static Token *lexer_make_token(Lexer *lexer, TokenType type, const char *lexeme, size_t start_line, size_t start_column) {
-    (void)lexer; // Unused parameter
-    return token_create(type, lexeme, start_line, start_column);
+// Token viewing source[start, pos). The scanner builds every token in
+// lexer->scratch; callers copy it out.
+static Token *lexer_make_token(Lexer *lexer, TokenType type, size_t start, size_t start_line, size_t start_column) {
+    token_init_view(&lexer->scratch, type, lexer->source, start, lexer->pos - start, start_line, start_column);
+    return &lexer->scratch;
 }
 
 static Token *lexer_error_token(Lexer *lexer, const char *message) {
     error_report(lexer->filename, lexer->line, lexer->column, message);
-    return token_create(TOKEN_ERROR, message, lexer->line, lexer->column);
+    token_init(&lexer->scratch, TOKEN_ERROR, message, lexer->line, lexer->column);
+    return &lexer->scratch;
 }
 
 static Token *lexer_lex_identifier(Lexer *lexer) {
@@ -181,34 +322,31 @@ static Token *lexer_lex_identifier(Lexer *lexer) {
     size_t start = lexer->pos;
     
     // Identifier: [a-zA-Z_][a-zA-Z0-9_]*
-    while (isalnum(lexer->current) || lexer->current == '_') {
-        lexer_advance(lexer);
-    }
+    lexer_skip(lexer, scan_ident(&lexer->source[start], lexer_remaining(lexer)));
     
     size_t length = lexer->pos - start;
-    char *lexeme = strndup(&lexer->source[start], length);
+    const char *text = &lexer->source[start];
     
     // Check if it's a keyword
-    for (int i = 0; keywords[i].keyword != NULL; i++) {
-        if (strcmp(lexeme, keywords[i].keyword) == 0) {
-            Token *token = lexer_make_token(lexer, keywords[i].type, lexeme, start_line, start_column);
+    if (length >= KEYWORD_MIN_LENGTH && length <= KEYWORD_MAX_LENGTH) {
+        unsigned slot = keyword_slots[KEYWORD_HASH(text, length)];
+        const KeywordEntry *entry = slot ? &keywords[slot - 1] : NULL;
+        if (entry && strncmp(entry->keyword, text, length) == 0 && entry->keyword[length] == '\0') {
+            Token *token = lexer_make_token(lexer, entry->type, start, start_line, start_column);
             
             // Set boolean values
-            if (keywords[i].type == TOKEN_TRUE) {
+            if (entry->type == TOKEN_TRUE) {
                 token->value.bool_value = true;
-            } else if (keywords[i].type == TOKEN_FALSE) {
+            } else if (entry->type == TOKEN_FALSE) {
                 token->value.bool_value = false;
             }
             
-            free(lexeme);
             return token;
         }
     }
     
     // It's an identifier
-    Token *token = lexer_make_token(lexer, TOKEN_IDENTIFIER, lexeme, start_line, start_column);
-    free(lexeme);
-    return token;
+    return lexer_make_token(lexer, TOKEN_IDENTIFIER, start, start_line, start_column);
 }
 
 static Token *lexer_lex_number(Lexer *lexer) {
@@ -218,16 +356,16 @@ static Token *lexer_lex_number(Lexer *lexer) {
     bool is_float = false;
     
     // Integer part
-    while (isdigit(lexer->current)) {
+    while (IS_CLASS(lexer->current, CC_DIGIT)) {
         lexer_advance(lexer);
     }
     
     // Check for decimal point
-    if (lexer->current == '.' && isdigit(lexer_peek_next(lexer))) {
+    if (lexer->current == '.' && IS_CLASS(lexer_peek_next(lexer), CC_DIGIT)) {
         is_float = true;
         lexer_advance(lexer); // consume '.'
         
-        while (isdigit(lexer->current)) {
+        while (IS_CLASS(lexer->current, CC_DIGIT)) {
             lexer_advance(lexer);
         }
     }
@@ -241,24 +379,21 @@ static Token *lexer_lex_number(Lexer *lexer) {
             lexer_advance(lexer);
         }
         
-        while (isdigit(lexer->current)) {
+        while (IS_CLASS(lexer->current, CC_DIGIT)) {
             lexer_advance(lexer);
         }
     }
     
-    size_t length = lexer->pos - start;
-    char *lexeme = strndup(&lexer->source[start], length);
-    
+    // The conversions stop at the same character the scan above did
     Token *token;
     if (is_float) {
-        token = lexer_make_token(lexer, TOKEN_FLOAT, lexeme, start_line, start_column);
-        token->value.float_value = atof(lexeme);
+        token = lexer_make_token(lexer, TOKEN_FLOAT, start, start_line, start_column);
+        token->value.float_value = strtod(&lexer->source[start], NULL);
     } else {
-        token = lexer_make_token(lexer, TOKEN_INTEGER, lexeme, start_line, start_column);
-        token->value.int_value = atoll(lexeme);
+        token = lexer_make_token(lexer, TOKEN_INTEGER, start, start_line, start_column);
+        token->value.int_value = strtoll(&lexer->source[start], NULL, 10);
     }
     
-    free(lexeme);
     return token;
 }
 
@@ -267,42 +402,23 @@ static Token *lexer_lex_string(Lexer *lexer) {
     size_t start_column = lexer->column;
     
     lexer_advance(lexer); // Skip opening quote
+    size_t content_start = lexer->pos;
     
-    char buffer[1024];
-    size_t len = 0;
-    
-    while (lexer->current != '"' && lexer->current != '\0') {
-        if (len >= sizeof(buffer) - 2) {  // Check BEFORE adding characters
-            return lexer_error_token(lexer, "string too long");
-        }
-        
-        char c = lexer->current;
-        
-        if (c == '\\') {
+    // Find the closing quote, skipping plain runs in bulk
+    bool has_escape = false;
+    while (true) {
+        lexer_skip(lexer, scan_until(&lexer->source[lexer->pos], lexer_remaining(lexer), '"', '\\', '\n'));
+        if (lexer->current == '\\') {
+            has_escape = true;
             lexer_advance(lexer); // Skip backslash
             if (lexer->current == '\0') {
                 return lexer_error_token(lexer, "unterminated string");
             }
-            
-            char next = lexer->current;
-            switch (next) {
-                case 'n':  buffer[len++] = '\n'; break;
-                case 't':  buffer[len++] = '\t'; break;
-                case 'r':  buffer[len++] = '\r'; break;
-                case '\\': buffer[len++] = '\\'; break;
-                case '"':  buffer[len++] = '"'; break;
-                default:
-                    buffer[len++] = '\\';
-                    if (len >= sizeof(buffer) - 1) {
-                        return lexer_error_token(lexer, "string too long");
-                    }
-                    buffer[len++] = next;
-                    break;
-            }
             lexer_advance(lexer);
-        } else {
-            buffer[len++] = c;
+        } else if (lexer->current == '\n') {
             lexer_advance(lexer);
+        } else {
+            break;
         }
     }
     
@@ -310,14 +426,71 @@ static Token *lexer_lex_string(Lexer *lexer) {
         return lexer_error_token(lexer, "unterminated string");
     }
     
+    size_t content_length = lexer->pos - content_start;
     lexer_advance(lexer); // Skip closing quote
+    
+    // Plain strings stay a view of the source
+    if (!has_escape) {
+        token_init_view(&lexer->scratch, TOKEN_STRING, lexer->source, content_start, content_length, start_line, start_column);
+        return &lexer->scratch;
+    }
+    
+    // Decode escapes; the result is never longer than the source text
+    const char *text = &lexer->source[content_start];
+    char *buffer = malloc(content_length + 1);
+    size_t len = 0;
+    for (size_t i = 0; i < content_length; i++) {
+        if (text[i] != '\\') {
+            buffer[len++] = text[i];
+            continue;
+        }
+        
+        char next = text[++i];
+        switch (next) {
+            case 'n':  buffer[len++] = '\n'; break;
+            case 't':  buffer[len++] = '\t'; break;
+            case 'r':  buffer[len++] = '\r'; break;
+            case '\\': buffer[len++] = '\\'; break;
+            case '"':  buffer[len++] = '"'; break;
+            default:
+                buffer[len++] = '\\';
+                buffer[len++] = next;
+                break;
+        }
+    }
     buffer[len] = '\0';
     
-    Token *token = lexer_make_token(lexer, TOKEN_STRING, buffer, start_line, start_column);
-    return token;
+    token_init(&lexer->scratch, TOKEN_STRING, buffer, start_line, start_column);
+    free(buffer);
+    return &lexer->scratch;
 }
 
 Token *lexer_next_token(Lexer *lexer) {
+    Token *token = arena_node_alloc(sizeof(Token));
+    *token = *lexer_scan(lexer);
+    return token;
+}
+
+Token *lexer_tokenize(Lexer *lexer, size_t *count) {
+    // Roughly one token per six bytes of source; grow if that's short
+    size_t capacity = lexer->length / 6 + 16;
+    size_t n = 0;
+    Token *tokens = malloc(sizeof(Token) * capacity);
+    
+    while (true) {
+        if (n == capacity) {
+            capacity *= 2;
+            tokens = realloc(tokens, sizeof(Token) * capacity);
+        }
+        tokens[n] = *lexer_scan(lexer);
+        if (tokens[n++].type == TOKEN_EOF) break;
+    }
+    
+    *count = n;
+    return tokens;
+}
+
+static Token *lexer_scan(Lexer *lexer) {
     // Skip whitespace and comments
     while (true) {
         lexer_skip_whitespace(lexer);
@@ -326,21 +499,22 @@ Token *lexer_next_token(Lexer *lexer) {
         }
     }
     
+    size_t start = lexer->pos;
     size_t start_line = lexer->line;
     size_t start_column = lexer->column;
     
     // End of file
     if (lexer->current == '\0') {
-        return lexer_make_token(lexer, TOKEN_EOF, "", start_line, start_column);
+        return lexer_make_token(lexer, TOKEN_EOF, start, start_line, start_column);
     }
     
     // Identifier or keyword
-    if (isalpha(lexer->current) || lexer->current == '_') {
+    if (IS_CLASS(lexer->current, CC_ALPHA)) {
         return lexer_lex_identifier(lexer);
     }
     
     // Number
-    if (isdigit(lexer->current)) {
+    if (IS_CLASS(lexer->current, CC_DIGIT)) {
         return lexer_lex_number(lexer);
     }
     
@@ -356,130 +530,130 @@ Token *lexer_next_token(Lexer *lexer) {
     if (current == '=' && next == '=') {
         lexer_advance(lexer);
         lexer_advance(lexer);
-        return lexer_make_token(lexer, TOKEN_EQ_EQ, "==", start_line, start_column);
+        return lexer_make_token(lexer, TOKEN_EQ_EQ, start, start_line, start_column);
     }
     if (current == '!' && next == '=') {
         lexer_advance(lexer);
         lexer_advance(lexer);
-        return lexer_make_token(lexer, TOKEN_BANG_EQ, "!=", start_line, start_column);
+        return lexer_make_token(lexer, TOKEN_BANG_EQ, start, start_line, start_column);
     }
     if (current == '<' && next == '=') {
         lexer_advance(lexer);
         lexer_advance(lexer);
-        return lexer_make_token(lexer, TOKEN_LT_EQ, "<=", start_line, start_column);
+        return lexer_make_token(lexer, TOKEN_LT_EQ, start, start_line, start_column);
     }
     if (current == '>' && next == '=') {
         lexer_advance(lexer);
         lexer_advance(lexer);
-        return lexer_make_token(lexer, TOKEN_GT_EQ, ">=", start_line, start_column);
+        return lexer_make_token(lexer, TOKEN_GT_EQ, start, start_line, start_column);
     }
     if (current == '&' && next == '&') {
         lexer_advance(lexer);
         lexer_advance(lexer);
-        return lexer_make_token(lexer, TOKEN_AMP_AMP, "&&", start_line, start_column);
+        return lexer_make_token(lexer, TOKEN_AMP_AMP, start, start_line, start_column);
     }
     if (current == '|' && next == '|') {
         lexer_advance(lexer);
         lexer_advance(lexer);
-        return lexer_make_token(lexer, TOKEN_PIPE_PIPE, "||", start_line, start_column);
+        return lexer_make_token(lexer, TOKEN_PIPE_PIPE, start, start_line, start_column);
     }
     if (current == '-' && next == '>') {
         lexer_advance(lexer);
         lexer_advance(lexer);
-        return lexer_make_token(lexer, TOKEN_ARROW, "->", start_line, start_column);
+        return lexer_make_token(lexer, TOKEN_ARROW, start, start_line, start_column);
     }
     if (current == ':' && next == ':') {
         lexer_advance(lexer);
         lexer_advance(lexer);
-        return lexer_make_token(lexer, TOKEN_COLON_COLON, "::", start_line, start_column);
+        return lexer_make_token(lexer, TOKEN_COLON_COLON, start, start_line, start_column);
     }
     // Single-character tokens and two-character operators
     char c = lexer->current;
     lexer_advance(lexer); // Consume the current character
     
     switch (c) {
-        case '(': return lexer_make_token(lexer, TOKEN_LPAREN, "(", start_line, start_column);
-        case ')': return lexer_make_token(lexer, TOKEN_RPAREN, ")", start_line, start_column);
-        case '{': return lexer_make_token(lexer, TOKEN_LBRACE, "{", start_line, start_column);
-        case '}': return lexer_make_token(lexer, TOKEN_RBRACE, "}", start_line, start_column);
-        case '[': return lexer_make_token(lexer, TOKEN_LBRACKET, "[", start_line, start_column);
-        case ']': return lexer_make_token(lexer, TOKEN_RBRACKET, "]", start_line, start_column);
-        case ';': return lexer_make_token(lexer, TOKEN_SEMICOLON, ";", start_line, start_column);
-        case ',': return lexer_make_token(lexer, TOKEN_COMMA, ",", start_line, start_column);
+        case '(': return lexer_make_token(lexer, TOKEN_LPAREN, start, start_line, start_column);
+        case ')': return lexer_make_token(lexer, TOKEN_RPAREN, start, start_line, start_column);
+        case '{': return lexer_make_token(lexer, TOKEN_LBRACE, start, start_line, start_column);
+        case '}': return lexer_make_token(lexer, TOKEN_RBRACE, start, start_line, start_column);
+        case '[': return lexer_make_token(lexer, TOKEN_LBRACKET, start, start_line, start_column);
+        case ']': return lexer_make_token(lexer, TOKEN_RBRACKET, start, start_line, start_column);
+        case ';': return lexer_make_token(lexer, TOKEN_SEMICOLON, start, start_line, start_column);
+        case ',': return lexer_make_token(lexer, TOKEN_COMMA, start, start_line, start_column);
         
         case '-':
             if (lexer_match(lexer, '>')) {
-                 return lexer_make_token(lexer, TOKEN_ARROW, "->", start_line, start_column);
+                 return lexer_make_token(lexer, TOKEN_ARROW, start, start_line, start_column);
             }
-            return lexer_make_token(lexer, TOKEN_MINUS, "-", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_MINUS, start, start_line, start_column);
             
-        case '+': return lexer_make_token(lexer, TOKEN_PLUS, "+", start_line, start_column);
-        case '*': return lexer_make_token(lexer, TOKEN_STAR, "*", start_line, start_column);
+        case '+': return lexer_make_token(lexer, TOKEN_PLUS, start, start_line, start_column);
+        case '*': return lexer_make_token(lexer, TOKEN_STAR, start, start_line, start_column);
         case '/': 
             if (lexer_match(lexer, '/')) {
                 // Comment
                 while (lexer_peek(lexer) != '\n' && !lexer_is_at_end(lexer)) {
                     lexer_advance(lexer);
                 }
-                return lexer_next_token(lexer); // Re-lex after comment
+                return lexer_scan(lexer); // Re-lex after comment
             }
-            return lexer_make_token(lexer, TOKEN_SLASH, "/", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_SLASH, start, start_line, start_column);
             
-        case '%': return lexer_make_token(lexer, TOKEN_PERCENT, "%", start_line, start_column);
+        case '%': return lexer_make_token(lexer, TOKEN_PERCENT, start, start_line, start_column);
         
         case '=':
             if (lexer_match(lexer, '=')) {
-                return lexer_make_token(lexer, TOKEN_EQ_EQ, "==", start_line, start_column);
+                return lexer_make_token(lexer, TOKEN_EQ_EQ, start, start_line, start_column);
             }
             if (lexer_match(lexer, '>')) {
-                return lexer_make_token(lexer, TOKEN_FAT_ARROW, "=>", start_line, start_column);
+                return lexer_make_token(lexer, TOKEN_FAT_ARROW, start, start_line, start_column);
             }
-            return lexer_make_token(lexer, TOKEN_EQ, "=", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_EQ, start, start_line, start_column);
             
         case '!':
             if (lexer_match(lexer, '=')) {
-                return lexer_make_token(lexer, TOKEN_BANG_EQ, "!=", start_line, start_column);
+                return lexer_make_token(lexer, TOKEN_BANG_EQ, start, start_line, start_column);
             }
-            return lexer_make_token(lexer, TOKEN_BANG, "!", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_BANG, start, start_line, start_column);
             
         case '<':
             if (lexer_match(lexer, '=')) {
-                return lexer_make_token(lexer, TOKEN_LT_EQ, "<=", start_line, start_column);
+                return lexer_make_token(lexer, TOKEN_LT_EQ, start, start_line, start_column);
             }
-            return lexer_make_token(lexer, TOKEN_LT, "<", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_LT, start, start_line, start_column);
             
         case '>':
             if (lexer_match(lexer, '=')) {
-                return lexer_make_token(lexer, TOKEN_GT_EQ, ">=", start_line, start_column);
+                return lexer_make_token(lexer, TOKEN_GT_EQ, start, start_line, start_column);
             }
-            return lexer_make_token(lexer, TOKEN_GT, ">", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_GT, start, start_line, start_column);
             
         case '&':
             if (lexer_match(lexer, '&')) {
-                return lexer_make_token(lexer, TOKEN_AMP_AMP, "&&", start_line, start_column);
+                return lexer_make_token(lexer, TOKEN_AMP_AMP, start, start_line, start_column);
             }
-            return lexer_make_token(lexer, TOKEN_AMP, "&", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_AMP, start, start_line, start_column);
             
         case '|':
             if (lexer_match(lexer, '|')) {
-                return lexer_make_token(lexer, TOKEN_PIPE_PIPE, "||", start_line, start_column);
+                return lexer_make_token(lexer, TOKEN_PIPE_PIPE, start, start_line, start_column);
             }
-            return lexer_make_token(lexer, TOKEN_PIPE, "|", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_PIPE, start, start_line, start_column);
             
         case ':':
             if (lexer_match(lexer, ':')) {
-                return lexer_make_token(lexer, TOKEN_COLON_COLON, "::", start_line, start_column);
+                return lexer_make_token(lexer, TOKEN_COLON_COLON, start, start_line, start_column);
             }
-            return lexer_make_token(lexer, TOKEN_COLON, ":", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_COLON, start, start_line, start_column);
             
         case '.':
             if (lexer_match(lexer, '.')) {
                if (lexer_match(lexer, '.')) {
-                   return lexer_make_token(lexer, TOKEN_ELLIPSIS, "...", start_line, start_column);
+                   return lexer_make_token(lexer, TOKEN_ELLIPSIS, start, start_line, start_column);
                }
-               return lexer_make_token(lexer, TOKEN_DOT_DOT, "..", start_line, start_column);
+               return lexer_make_token(lexer, TOKEN_DOT_DOT, start, start_line, start_column);
             }
-            return lexer_make_token(lexer, TOKEN_DOT, ".", start_line, start_column);
+            return lexer_make_token(lexer, TOKEN_DOT, start, start_line, start_column);
         
         default: {
             char error_msg[64];
@@ -1,11 +1,12 @@
 #include "../include/loop_transform.h"
 #include "../include/ir.h"
+#include "../include/cfg.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
 // Detect if a sequence starting at idx forms a simple counting loop
-LoopInfo detect_simple_loop(IRFunction *func, size_t start_idx) {
+LoopInfo detect_simple_loop(IRFunction *func, const CFG *cfg, size_t start_idx) {
     LoopInfo info = {0};
     info.is_simple_loop = false;
     
@@ -37,17 +38,20 @@ LoopInfo detect_simple_loop(IRFunction *func, size_t start_idx) {
     if (branch->opcode != IR_BRANCH) return info;
     if (!branch->src2 || branch->src2->kind != IR_OP_LABEL) return info;
     
-    // Find the backward jump (goto loop_label)
-    for (size_t i = start_idx + 3; i < func->instruction_count && i < start_idx + 100; i++) {
-        IRInstruction *jmp = func->instructions[i];
-        if (jmp->opcode == IR_JUMP && jmp->src1 && jmp->src1->kind == IR_OP_LABEL) {
-            if (strcmp(jmp->src1->data.label_name, loop_label) == 0) {
-                // Found backward jump - this looks like a loop!
-                info.is_simple_loop = true;
-                info.loop_end_idx = i;
-                return info;
-            }
-        }
+    // The label must head a natural loop, which ends at its last latch.
+    // Earlier latches are `continue` paths and stay inside the body.
+    size_t header = cfg->block_of[start_idx];
+    size_t loop = cfg_loop_of_header(cfg, header);
+    if (loop == CFG_NONE || cfg->blocks[header].start != start_idx) return info;
+    
+    const CFGLoop *l = &cfg->loops[loop];
+    const BasicBlock *latch = &cfg->blocks[l->latches[l->latch_count - 1]];
+    if (latch->end <= start_idx + 3) return info;
+    IRInstruction *jmp = func->instructions[latch->end - 1];
+    if (jmp->opcode == IR_JUMP && jmp->src1 && jmp->src1->kind == IR_OP_LABEL &&
+        strcmp(jmp->src1->data.label_name, loop_label) == 0) {
+        info.is_simple_loop = true;
+        info.loop_end_idx = latch->end - 1;
     }
     
     return info;
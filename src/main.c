@@ -3,9 +3,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <libgen.h>
+#include <time.h>
 #include "../include/virex.h"
 #include "../include/lexer.h"
 #include "../include/token.h"
@@ -16,9 +18,15 @@
 #include "../include/ir.h"
 #include "../include/irgen.h"
 #include "../include/iropt.h"
+#include "../include/inliner.h"
+#include "../include/passes.h"
 #include "../include/codegen.h"
 #include "../include/llvm_codegen.h"
+#include "../include/threadpool.h"
+#include "../include/cache.h"
+#include "../include/util.h"
 #include "../include/compiler.h"
+#include "../include/intern.h"
 
 void print_version(void) {
     printf("Virex compiler v%s\n", VIREX_VERSION);
@@ -33,6 +41,17 @@ void print_help(void) {
     printf("Options:\n");
     printf("  --backend=<backend>   Select backend: 'c' (default) or 'llvm'\n");
     printf("  --strict-unsafe       Treat checks like unnecessary unsafe blocks as errors\n");
+    printf("  --stats               Print front-end arena usage per phase\n");
+    printf("  -j <n>                Parse and analyze modules on n threads (0 = all cores)\n");
+    printf("  --no-cache            Ignore and don't update the %s/ build cache\n", BUILD_CACHE_DIR);
+    printf("  --inline-threshold=<n> Inline callees of up to n IR instructions (default %d, 0 = off)\n",
+           INLINER_DEFAULT_THRESHOLD);
+    printf("  --report-bce          List the slice bounds checks left after optimization\n");
+    printf("  -O<level>             IR pass pipeline, 0 to %d (default %d); also passed to gcc\n",
+           PASS_MAX_LEVEL, PASS_DEFAULT_LEVEL);
+    printf("  --passes=<list>       Run these IR passes instead, e.g. inline,[sccp,gvn],dce\n");
+    printf("                        (bracketed passes repeat until nothing changes)\n");
+    printf("  --print-after=<pass>  Print the IR after every run of a pass\n");
     printf("  --version             Print version information\n");
     printf("  --help                Print this help message\n");
     printf("  -o <file>             Specify output file path (directories auto-created)\n\n");
@@ -78,6 +97,149 @@ static int ensure_directory_exists(const char *path) {
     return 1;
 }
 
+// Parses the count of "-j N" / "-jN"; returns false if it is not a number
+static bool parse_jobs(const char *text, size_t *jobs) {
+    char *end = NULL;
+    long value = strtol(text, &end, 10);
+    if (!*text || *end || value < 0) return false;
+    *jobs = value == 0 ? threadpool_cpu_count() : (size_t)value;
+    return true;
+}
+
+// Arguments handled by virexc itself rather than passed to gcc
+static bool is_virex_flag(int *i, int argc, char **argv) {
+    const char *arg = argv[*i];
+    if (strcmp(arg, "--strict-unsafe") == 0 || strcmp(arg, "--stats") == 0 ||
+        strcmp(arg, "--no-cache") == 0 || strncmp(arg, "--backend=", 10) == 0 ||
+        strncmp(arg, "--inline-threshold=", 19) == 0 || strcmp(arg, "--report-bce") == 0 ||
+        strncmp(arg, "--passes=", 9) == 0 || strncmp(arg, "--print-after=", 14) == 0) {
+        return true;
+    }
+    if (strncmp(arg, "-j", 2) == 0 || strcmp(arg, "-o") == 0) {
+        if (!arg[2] && *i + 1 < argc) (*i)++; // skip the value
+        return true;
+    }
+    return false;
+}
+
+// Appends gcc passthrough arguments. The compile step only gets options;
+// objects and libraries (-l, -L, -Wl) go to the link step.
+static int append_gcc_args(char *cmd, size_t size, int offset, int argc, char **argv, bool compile_step) {
+    for (int i = 0; i < argc; i++) {
+        if (is_virex_flag(&i, argc, argv)) continue;
+        const char *arg = argv[i];
+        bool link_only = arg[0] != '-' || strncmp(arg, "-l", 2) == 0 ||
+                         strncmp(arg, "-L", 2) == 0 || strncmp(arg, "-Wl,", 4) == 0;
+        if (compile_step && link_only) continue;
+        offset += snprintf(cmd + offset, size - offset, " %s", arg);
+    }
+    return offset;
+}
+
+// Cache key for the whole program's object: every module (through the main
+// module's chained hash), the compiler binary and everything on the command
+// line that can change the generated code
+static uint64_t build_cache_key(Project *project, int argc, char **argv) {
+    uint64_t key = cache_hash_u64(project->main_module->hash, cache_compiler_hash());
+    key = cache_hash_u64(project->strict_unsafe_mode, key);
+    key = cache_hash_u64(project->inline_threshold, key);
+    key = cache_hash_string(project->passes ? project->passes : "", key);
+    for (int i = 0; i < argc; i++) {
+        if (is_virex_flag(&i, argc, argv)) continue;
+        key = cache_hash_string(argv[i], key);
+    }
+    return key;
+}
+
+// Generates one C unit per module into CODEGEN_UNIT_DIR and compiles them
+// with up to jobs gcc processes. With the cache, each object is keyed by its
+// unit, the shared header, the compiler and the compile flags, and units
+// whose object is already cached are not recompiled.
+static bool compile_units(Project *project, bool show_stats, bool use_cache, size_t jobs,
+                          int extra_argc, char **extra_argv, char ***out_objects, size_t *out_count) {
+    if (!ensure_directory_exists(CODEGEN_UNIT_DIR)) return false;
+
+    CodeGenerator *codegen = codegen_create();
+    struct timespec backend_start, backend_end;
+    clock_gettime(CLOCK_MONOTONIC, &backend_start);
+    size_t unit_count = 0;
+    char **units = codegen_generate_units(codegen, project, CODEGEN_UNIT_DIR, &unit_count);
+    clock_gettime(CLOCK_MONOTONIC, &backend_end);
+
+    if (show_stats) {
+        double backend_ms = (backend_end.tv_sec - backend_start.tv_sec) * 1e3 +
+                            (backend_end.tv_nsec - backend_start.tv_nsec) / 1e6;
+        printf("Backend: %zu modules, %zu IR lowerings, %.3f ms\n",
+               project->module_count, codegen_lowered_modules(codegen), backend_ms);
+    }
+    codegen_free(codegen);
+    if (!units) return false;
+
+    char flags[2048];
+    int flags_len = append_gcc_args(flags, sizeof(flags), 0, extra_argc, extra_argv, true);
+    flags[flags_len] = '\0';
+
+    uint64_t unit_seed = cache_hash_string(flags, cache_compiler_hash());
+    char header_path[512];
+    snprintf(header_path, sizeof(header_path), "%s/%s", CODEGEN_UNIT_DIR, CODEGEN_HEADER_NAME);
+    cache_hash_file(header_path, &unit_seed);
+
+    char **objects = malloc(sizeof(char*) * unit_count);
+    char **temps = malloc(sizeof(char*) * unit_count);
+    char **commands = malloc(sizeof(char*) * unit_count);
+    size_t command_count = 0;
+
+    for (size_t i = 0; i < unit_count; i++) {
+        char object[512];
+        uint64_t key = unit_seed;
+        if (use_cache && cache_hash_file(units[i], &key)) {
+            cache_artifact_path(object, sizeof(object), key, ".o");
+        } else {
+            snprintf(object, sizeof(object), "%.*s.o", (int)(strlen(units[i]) - 2), units[i]);
+        }
+        objects[i] = strdup(object);
+        temps[i] = NULL;
+        if (use_cache && access(object, R_OK) == 0) continue;
+
+        // Compile into a temporary name and publish it only once gcc
+        // succeeded, so a failed or interrupted build never hits
+        size_t temp_size = strlen(object) + 32;
+        temps[i] = malloc(temp_size);
+        snprintf(temps[i], temp_size, "%s.%ld.tmp", object, (long)getpid());
+
+        size_t command_size = strlen(units[i]) + strlen(flags) + temp_size + 64;
+        commands[command_count] = malloc(command_size);
+        snprintf(commands[command_count], command_size, "gcc -O2 -c %s%s -o %s 2>&1", units[i], flags, temps[i]);
+        command_count++;
+    }
+
+    printf("✓ Generated C code: %s/ (%zu units)\n", CODEGEN_UNIT_DIR, unit_count);
+    printf("✓ Compiling with gcc (%zu of %zu units, %zu jobs)...\n", command_count, unit_count, jobs);
+    bool ok = run_commands(commands, command_count, jobs);
+
+    for (size_t i = 0; i < unit_count; i++) {
+        if (temps[i]) {
+            if (ok && rename(temps[i], objects[i]) != 0) ok = false;
+            remove(temps[i]);
+            free(temps[i]);
+        }
+        free(units[i]);
+    }
+    for (size_t i = 0; i < command_count; i++) free(commands[i]);
+    free(commands);
+    free(temps);
+    free(units);
+
+    if (!ok) {
+        for (size_t i = 0; i < unit_count; i++) free(objects[i]);
+        free(objects);
+        return false;
+    }
+    *out_objects = objects;
+    *out_count = unit_count;
+    return true;
+}
+
 static int compile_file(const char *filename, int extra_argc, char **extra_argv) {
     Project *project = project_create();
     
@@ -87,13 +249,62 @@ static int compile_file(const char *filename, int extra_argc, char **extra_argv)
     char *dot = strrchr(exe_name, '.');
     if (dot) *dot = '\0';
     
-    bool user_output_name = false;
+    bool show_stats = false;
+    bool use_cache = true;
+    bool jobs_given = false;
     const char *backend = "c"; // Default to C backend
     
     // Parse Virex-specific flags and check for -o
     for (int i = 0; i < extra_argc; i++) {
         if (strcmp(extra_argv[i], "--strict-unsafe") == 0) {
             project->strict_unsafe_mode = true;
+        } else if (strcmp(extra_argv[i], "--stats") == 0) {
+            show_stats = true;
+        } else if (strcmp(extra_argv[i], "--no-cache") == 0) {
+            use_cache = false;
+        } else if (strcmp(extra_argv[i], "--report-bce") == 0) {
+            project->report_bce = true;
+        } else if (strncmp(extra_argv[i], "-j", 2) == 0) {
+            jobs_given = true;
+            const char *count = extra_argv[i][2] ? extra_argv[i] + 2 : (i + 1 < extra_argc ? extra_argv[++i] : "");
+            if (!parse_jobs(count, &project->jobs)) {
+                fprintf(stderr, "Error: Invalid job count '%s' for -j\n", count);
+                project_free(project);
+                return 1;
+            }
+        } else if (strncmp(extra_argv[i], "--inline-threshold=", 19) == 0) {
+            char *end = NULL;
+            const char *value = extra_argv[i] + 19;
+            long threshold = strtol(value, &end, 10);
+            if (!*value || *end || threshold < 0) {
+                fprintf(stderr, "Error: Invalid inline threshold '%s'\n", value);
+                project_free(project);
+                return 1;
+            }
+            project->inline_threshold = (size_t)threshold;
+        } else if (strncmp(extra_argv[i], "-O", 2) == 0) {
+            // gcc still gets the flag; -Os and friends keep the default pipeline
+            const char *level = extra_argv[i] + 2;
+            if (!*level) {
+                project->opt_level = 1;
+            } else if (level[0] >= '0' && level[0] <= '9' && !level[1]) {
+                project->opt_level = level[0] - '0' > PASS_MAX_LEVEL ? PASS_MAX_LEVEL : level[0] - '0';
+            }
+        } else if (strncmp(extra_argv[i], "--passes=", 9) == 0) {
+            PassPipeline *pipeline = pass_pipeline_parse(extra_argv[i] + 9);
+            if (!pipeline) {
+                project_free(project);
+                return 1;
+            }
+            pass_pipeline_free(pipeline);
+            project->passes = extra_argv[i] + 9;
+        } else if (strncmp(extra_argv[i], "--print-after=", 14) == 0) {
+            project->print_after = extra_argv[i] + 14;
+            if (!pass_exists(project->print_after)) {
+                fprintf(stderr, "Error: Unknown pass '%s'\n", project->print_after);
+                project_free(project);
+                return 1;
+            }
         } else if (strncmp(extra_argv[i], "--backend=", 10) == 0) {
             backend = extra_argv[i] + 10;
             if (strcmp(backend, "c") != 0 && strcmp(backend, "llvm") != 0) {
@@ -103,7 +314,6 @@ static int compile_file(const char *filename, int extra_argc, char **extra_argv)
             }
         } else if (strcmp(extra_argv[i], "-o") == 0 && i + 1 < extra_argc) {
             strncpy(exe_name, extra_argv[i+1], 255);
-            user_output_name = true;
             
             // Extract dir and ensure it exists
             char *path_copy = strdup(exe_name);
@@ -123,11 +333,31 @@ static int compile_file(const char *filename, int extra_argc, char **extra_argv)
         project_free(project);
         return 1;
     }
+    size_t parse_bytes = project_arena_bytes(project);
 
-    if (!project_analyze(project)) {
+    // A cached object for this exact program means a previous build already
+    // analyzed, generated and compiled it successfully
+    // The report and IR dumps come out of code generation, which a cache hit skips
+    use_cache = use_cache && strcmp(backend, "c") == 0 && !project->report_bce && !project->print_after &&
+                cache_prepare();
+    uint64_t cache_key = use_cache ? build_cache_key(project, extra_argc, extra_argv) : 0;
+    size_t object_count = 0;
+    char **objects = use_cache ? cache_read_manifest(cache_key, &object_count) : NULL;
+    bool cache_hit = objects != NULL;
+
+    if (!cache_hit && !project_analyze(project)) {
         project_free(project);
         return 1;
     }
+    size_t analyze_bytes = project_arena_bytes(project) - parse_bytes;
+    
+    if (show_stats) {
+        printf("Arena usage (%zu modules):\n", project->module_count);
+        printf("  parse:    %zu bytes\n", parse_bytes);
+        printf("  analyze:  %zu bytes\n", analyze_bytes);
+        printf("  total:    %zu bytes\n", parse_bytes + analyze_bytes);
+        printf("Interned strings: %zu (%zu bytes)\n", intern_count(), intern_bytes());
+    }
     
     // Backend selection
     if (strcmp(backend, "llvm") == 0) {
@@ -162,63 +392,45 @@ static int compile_file(const char *filename, int extra_argc, char **extra_argv)
     // C backend (default)
     printf("✓ Using C backend\n");
     
-    char output_filename[256];
-    // Write C file to same dir as output exe or default
-    if (user_output_name) {
-         // Maintain directory structure for C file too? 
-         // Or just put it in a consistent place? 
-         // For now, keep it simple: virex_out.c in current dir.
-         snprintf(output_filename, sizeof(output_filename), "virex_out.c");
+    // gcc runs one process per unit; without -j it uses every core
+    size_t compile_jobs = jobs_given ? project->jobs : threadpool_cpu_count();
+    bool ok = true;
+    if (cache_hit) {
+        printf("✓ Reusing cached build: %zu objects\n", object_count);
     } else {
-         snprintf(output_filename, sizeof(output_filename), "virex_out.c");
+        ok = compile_units(project, show_stats, use_cache, compile_jobs, extra_argc, extra_argv, &objects, &object_count);
+        if (ok && use_cache) cache_write_manifest(cache_key, objects, object_count);
     }
 
-    FILE *output = fopen(output_filename, "w");
-    if (!output) {
-        fprintf(stderr, "Error: Could not open output file '%s'\n", output_filename);
-        project_free(project);
-        return 1;
-    }
-    CodeGenerator *codegen = codegen_create();
-    codegen_generate_c(codegen, project, output);
-    fclose(output);
-    
-    char compile_cmd[4096];
-    int offset = snprintf(compile_cmd, sizeof(compile_cmd), "gcc -O2 %s runtime/virex_runtime.o -lm", output_filename);
-    
-    // Add extra arguments (flags, objects, libs)
-    for (int i = 0; i < extra_argc; i++) {
-        // Skip Virex-specific flags
-        if (strcmp(extra_argv[i], "--strict-unsafe") == 0) continue;
-        if (strncmp(extra_argv[i], "--backend=", 10) == 0) continue;
-        
-        // Skip -o and its argument if we handled it
-        if (strcmp(extra_argv[i], "-o") == 0) {
-            i++; // skip next arg
-            continue;
+    // Link (flags, objects and libraries from the command line go here too)
+    if (ok) {
+        size_t link_size = 4096;
+        for (size_t i = 0; i < object_count; i++) link_size += strlen(objects[i]) + 1;
+        for (int i = 0; i < extra_argc; i++) link_size += strlen(extra_argv[i]) + 1;
+        char *link_cmd = malloc(link_size);
+        int offset = snprintf(link_cmd, link_size, "gcc -O2");
+        for (size_t i = 0; i < object_count; i++) {
+            offset += snprintf(link_cmd + offset, link_size - offset, " %s", objects[i]);
         }
-        
-        offset += snprintf(compile_cmd + offset, sizeof(compile_cmd) - offset, " %s", extra_argv[i]);
+        offset += snprintf(link_cmd + offset, link_size - offset, " runtime/virex_runtime.o -lm");
+        offset = append_gcc_args(link_cmd, link_size, offset, extra_argc, extra_argv, false);
+        snprintf(link_cmd + offset, link_size - offset, " -o %s 2>&1", exe_name);
+        ok = system(link_cmd) == 0;
+        free(link_cmd);
     }
-    
-    // Output file (explicit check to ensure we use our decided name)
-    snprintf(compile_cmd + offset, sizeof(compile_cmd) - offset, " -o %s 2>&1", exe_name);
-    
-    printf("✓ Generated C code: %s\n", output_filename);
-    printf("✓ Compiling with gcc...\n");
-    // printf("  %s\n", compile_cmd); // Debug info
-    
-    int result = system(compile_cmd);
-    if (result == 0) {
-        printf("✓ Build successful: %s\n", exe_name);
-    } else {
+
+    for (size_t i = 0; i < object_count; i++) {
+        if (!use_cache) remove(objects[i]);
+        free(objects[i]);
+    }
+    free(objects);
+    project_free(project);
+
+    if (!ok) {
         fprintf(stderr, "✗ Compilation failed\n");
-        codegen_free(codegen);
-        project_free(project);
         return 1;
     }
-    codegen_free(codegen);
-    project_free(project);
+    printf("✓ Build successful: %s\n", exe_name);
     return 0;
 }
 
@@ -6,6 +6,7 @@
 #include "../include/util.h"
 #include "../include/type.h"
 #include "../include/symtable.h"
+#include "../include/arena.h"
 
 MonomorphContext *monomorph_create(ASTProgram *program) {
     MonomorphContext *ctx = malloc(sizeof(MonomorphContext));
@@ -52,9 +53,9 @@ bool is_generic_type(ASTDecl *decl) {
 static ASTParam *clone_and_substitute_params(ASTParam *params, size_t param_count, char **type_params, size_t type_param_count, Type **concrete_types) {
     if (!params || param_count == 0) return NULL;
     
-    ASTParam *new_params = malloc(sizeof(ASTParam) * param_count);
+    ASTParam *new_params = arena_node_alloc(sizeof(ASTParam) * param_count);
     for (size_t i = 0; i < param_count; i++) {
-        new_params[i].name = strdup(params[i].name);
+        new_params[i].name = arena_node_strdup(params[i].name);
         new_params[i].param_type = type_substitute(params[i].param_type, type_params, concrete_types, type_param_count);
     }
     
@@ -66,7 +67,7 @@ ASTDecl *instantiate_generic_function(MonomorphContext *ctx, ASTDecl *generic_fu
     if (type_count != generic_func->data.function.type_param_count) return NULL;
     
     // Create mangled name
-    char *mangled_name = util_mangle_instantiation(
+    const char *mangled_name = util_mangle_instantiation(
         generic_func->data.function.name,
         concrete_types,
         type_count
@@ -74,8 +75,7 @@ ASTDecl *instantiate_generic_function(MonomorphContext *ctx, ASTDecl *generic_fu
     
     // Check if already instantiated
     for (size_t i = 0; i < ctx->instantiated_count; i++) {
-        if (strcmp(ctx->instantiated_functions[i]->data.function.name, mangled_name) == 0) {
-            free(mangled_name);
+        if (ctx->instantiated_functions[i]->data.function.name == mangled_name) {
             return ctx->instantiated_functions[i];
         }
     }
@@ -121,16 +121,15 @@ ASTDecl *instantiate_generic_function(MonomorphContext *ctx, ASTDecl *generic_fu
     }
     ctx->instantiated_functions[ctx->instantiated_count++] = instantiated;
     
-    free(mangled_name);
     return instantiated;
 }
 
 // Helper: Clone and substitute types in struct fields
 static ASTField *clone_and_substitute_fields(ASTField *fields, size_t field_count, char **type_params, size_t type_param_count, Type **concrete_types) {
     if (!fields || field_count == 0) return NULL;
-    ASTField *new_fields = malloc(sizeof(ASTField) * field_count);
+    ASTField *new_fields = arena_node_alloc(sizeof(ASTField) * field_count);
     for (size_t i = 0; i < field_count; i++) {
-        new_fields[i].name = strdup(fields[i].name);
+        new_fields[i].name = arena_node_strdup(fields[i].name);
         new_fields[i].field_type = type_substitute(fields[i].field_type, type_params, concrete_types, type_param_count);
     }
     return new_fields;
@@ -139,9 +138,9 @@ static ASTField *clone_and_substitute_fields(ASTField *fields, size_t field_coun
 // Helper: Clone and substitute types in enum variants
 static ASTEnumVariant *clone_and_substitute_variants(ASTEnumVariant *variants, size_t variant_count, char **type_params, size_t type_param_count, Type **concrete_types) {
     if (!variants || variant_count == 0) return NULL;
-    ASTEnumVariant *new_variants = malloc(sizeof(ASTEnumVariant) * variant_count);
+    ASTEnumVariant *new_variants = arena_node_alloc(sizeof(ASTEnumVariant) * variant_count);
     for (size_t i = 0; i < variant_count; i++) {
-        new_variants[i].name = strdup(variants[i].name);
+        new_variants[i].name = arena_node_strdup(variants[i].name);
         // Enums variants don't have associated data types yet in Virex
     }
     return new_variants;
@@ -151,13 +150,12 @@ ASTDecl *instantiate_generic_struct(MonomorphContext *ctx, ASTDecl *generic_stru
     if (!is_generic_type(generic_struct) || generic_struct->type != AST_STRUCT_DECL) return generic_struct;
     if (type_count != generic_struct->data.struct_decl.type_param_count) return NULL;
     
-    char *mangled_name = util_mangle_instantiation(generic_struct->data.struct_decl.name, concrete_types, type_count);
+    const char *mangled_name = util_mangle_instantiation(generic_struct->data.struct_decl.name, concrete_types, type_count);
     
     // Check if already instantiated
     for (size_t i = 0; i < ctx->instantiated_types_count; i++) {
         ASTDecl *inst = ctx->instantiated_types[i];
-        if (inst->type == AST_STRUCT_DECL && strcmp(inst->data.struct_decl.name, mangled_name) == 0) {
-            free(mangled_name);
+        if (inst->type == AST_STRUCT_DECL && inst->data.struct_decl.name == mangled_name) {
             return inst;
         }
     }
@@ -188,7 +186,6 @@ ASTDecl *instantiate_generic_struct(MonomorphContext *ctx, ASTDecl *generic_stru
     }
     ctx->instantiated_types[ctx->instantiated_types_count++] = instantiated;
     
-    free(mangled_name);
     return instantiated;
 }
 
@@ -196,13 +193,12 @@ ASTDecl *instantiate_generic_enum(MonomorphContext *ctx, ASTDecl *generic_enum,
     if (!is_generic_type(generic_enum) || generic_enum->type != AST_ENUM_DECL) return generic_enum;
     if (type_count != generic_enum->data.enum_decl.type_param_count) return NULL;
     
-    char *mangled_name = util_mangle_instantiation(generic_enum->data.enum_decl.name, concrete_types, type_count);
+    const char *mangled_name = util_mangle_instantiation(generic_enum->data.enum_decl.name, concrete_types, type_count);
     
     // Check if already instantiated
     for (size_t i = 0; i < ctx->instantiated_types_count; i++) {
         ASTDecl *inst = ctx->instantiated_types[i];
-        if (inst->type == AST_ENUM_DECL && strcmp(inst->data.enum_decl.name, mangled_name) == 0) {
-            free(mangled_name);
+        if (inst->type == AST_ENUM_DECL && inst->data.enum_decl.name == mangled_name) {
             return inst;
         }
     }
@@ -232,7 +228,6 @@ ASTDecl *instantiate_generic_enum(MonomorphContext *ctx, ASTDecl *generic_enum,
     }
     ctx->instantiated_types[ctx->instantiated_types_count++] = instantiated;
     
-    free(mangled_name);
     return instantiated;
 }
 
@@ -243,7 +238,7 @@ ASTProgram *monomorph_program(MonomorphContext *ctx) {
     size_t total_added = ctx->instantiated_count + ctx->instantiated_types_count;
     if (total_added > 0) {
         size_t new_count = ctx->program->decl_count + total_added;
-        ASTDecl **new_decls = malloc(sizeof(ASTDecl*) * new_count);
+        ASTDecl **new_decls = arena_node_alloc(sizeof(ASTDecl*) * new_count);
         
         // Copy original declarations
         for (size_t i = 0; i < ctx->program->decl_count; i++) {
@@ -260,7 +255,7 @@ ASTProgram *monomorph_program(MonomorphContext *ctx) {
             new_decls[ctx->program->decl_count + ctx->instantiated_count + i] = ctx->instantiated_types[i];
         }
         
-        free(ctx->program->declarations);
+        arena_node_free(ctx->program->declarations);
         ctx->program->declarations = new_decls;
         ctx->program->decl_count = new_count;
     }
@@ -4,6 +4,8 @@
 #include <string.h>
 #include "../include/parser.h"
 #include "../include/error.h"
+#include "../include/arena.h"
+#include "../include/intern.h"
 
 // Forward declarations
 static ASTExpr *parse_expression(Parser *p);
@@ -40,6 +42,9 @@ static Type *parse_type(Parser *p);
 
 // Helper functions
 static void advance(Parser *p);
+static Token *peek(Parser *p, size_t k);
+static void collect_type_names(Parser *p);
+static bool looks_like_generic_args(Parser *p);
 static bool check(Parser *p, TokenType type);
 static bool match(Parser *p, TokenType type);
 static Token *expect(Parser *p, TokenType type, const char *message);
@@ -49,10 +54,17 @@ static void synchronize(Parser *p);
 Parser *parser_init(Lexer *lexer) {
     Parser *p = malloc(sizeof(Parser));
     p->lexer = lexer;
+    p->tokens = lexer_tokenize(lexer, &p->token_count);
+    p->next = 0;
     p->current = NULL;
     p->previous = NULL;
     p->had_error = false;
     p->panic_mode = false;
+    p->type_names = NULL;
+    p->type_name_count = 0;
+    p->module_names = NULL;
+    p->module_name_count = 0;
+    collect_type_names(p);
     
     // Prime the parser with first token
     advance(p);
@@ -61,27 +73,159 @@ Parser *parser_init(Lexer *lexer) {
 }
 
 void parser_free(Parser *parser) {
-    if (parser->current) token_free(parser->current);
-    if (parser->previous) token_free(parser->previous);
+    // Owned lexemes (escaped strings, error messages) live in the arena
+    // when one is current; the AST keeps copies of any token it needs
+    if (!arena_current()) {
+        for (size_t i = 0; i < parser->token_count; i++) {
+            if (!parser->tokens[i].source) free((char *)parser->tokens[i].lexeme);
+        }
+    }
+    free(parser->tokens);
+    free(parser->type_names);
+    free(parser->module_names);
     free(parser);
 }
 
+static Token *next_token(Parser *p) {
+    Token *token = &p->tokens[p->next];
+    if (p->next + 1 < p->token_count) p->next++; // Stay on EOF
+    return token;
+}
+
 static void advance(Parser *p) {
-    if (p->previous) {
-        token_free(p->previous);
-    }
-    
     p->previous = p->current;
-    p->current = lexer_next_token(p->lexer);
+    p->current = next_token(p);
     
     // Skip error tokens
     while (p->current->type == TOKEN_ERROR) {
-        parser_error(p, p->current->lexeme);
-        token_free(p->current);
-        p->current = lexer_next_token(p->lexer);
+        parser_error(p, token_lexeme(p->current));
+        p->current = next_token(p);
+    }
+}
+
+// Token k positions after current (k >= 1), clamped to EOF
+static Token *peek(Parser *p, size_t k) {
+    size_t index = p->next + k - 1;
+    if (index >= p->token_count) index = p->token_count - 1;
+    return &p->tokens[index];
+}
+
+static void add_name(const char ***names, size_t *count, const char *name) {
+    *names = realloc(*names, sizeof(char*) * (*count + 1));
+    (*names)[(*count)++] = name;
+}
+
+static bool has_name(const char **names, size_t count, const char *name) {
+    for (size_t i = 0; i < count; i++) {
+        if (names[i] == name) return true;
+    }
+    return false;
+}
+
+// Scan the module's tokens once for the names a type can start with: the
+// structs, enums and aliases it declares, the generic parameters of its
+// declarations, and its import aliases (the module in module.Type). An
+// import without 'as' is known by its file name.
+static void collect_type_names(Parser *p) {
+    for (size_t i = 0; i + 1 < p->token_count; i++) {
+        TokenType type = p->tokens[i].type;
+        Token *name = &p->tokens[i + 1];
+        if (type == TOKEN_IMPORT && name->type == TOKEN_STRING) {
+            if (i + 3 < p->token_count && p->tokens[i + 2].type == TOKEN_AS && p->tokens[i + 3].type == TOKEN_IDENTIFIER) {
+                add_name(&p->module_names, &p->module_name_count, intern(token_lexeme(&p->tokens[i + 3])));
+                continue;
+            }
+            const char *path = token_lexeme(name);
+            const char *base = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+            const char *ext = strrchr(base, '.');
+            add_name(&p->module_names, &p->module_name_count, intern_n(base, ext ? (size_t)(ext - base) : strlen(base)));
+            continue;
+        }
+        if (name->type != TOKEN_IDENTIFIER) continue;
+        if (type != TOKEN_STRUCT && type != TOKEN_ENUM && type != TOKEN_TYPEDEF && type != TOKEN_FUNC) continue;
+        if (type != TOKEN_FUNC) add_name(&p->type_names, &p->type_name_count, intern(token_lexeme(name)));
+        
+        // Generic parameters: name<T, U>
+        if (i + 2 < p->token_count && p->tokens[i + 2].type == TOKEN_LT) {
+            for (size_t k = i + 3; k < p->token_count && p->tokens[k].type != TOKEN_GT; k++) {
+                if (p->tokens[k].type == TOKEN_IDENTIFIER) {
+                    add_name(&p->type_names, &p->type_name_count, intern(token_lexeme(&p->tokens[k])));
+                } else if (p->tokens[k].type != TOKEN_COMMA) {
+                    break;
+                }
+            }
+        }
     }
 }
 
+// Whether the tokens from peek(p, *k) on spell a type made of primitives
+// and known names, following parse_type's grammar; moves *k past it
+static bool scan_type(Parser *p, size_t *k) {
+    Token *token = peek(p, *k);
+    if (token->type == TOKEN_LBRACKET) {
+        (*k)++;
+        if (peek(p, *k)->type == TOKEN_INTEGER) (*k)++;
+        if (peek(p, *k)->type != TOKEN_RBRACKET) return false;
+        (*k)++;
+        return scan_type(p, k);
+    }
+    
+    if (token->type == TOKEN_RESULT) {
+        if (peek(p, ++*k)->type != TOKEN_LT) return false;
+        (*k)++;
+        if (!scan_type(p, k) || peek(p, *k)->type != TOKEN_COMMA) return false;
+        (*k)++;
+        if (!scan_type(p, k) || peek(p, *k)->type != TOKEN_GT) return false;
+        (*k)++;
+    } else if (token->type >= TOKEN_I8 && token->type <= TOKEN_VOID) {
+        (*k)++;
+    } else if (token->type == TOKEN_IDENTIFIER) {
+        const char *name = intern(token_lexeme(token));
+        (*k)++;
+        if (peek(p, *k)->type == TOKEN_DOT) {
+            // module.Type
+            if (!has_name(p->module_names, p->module_name_count, name)) return false;
+            while (peek(p, *k)->type == TOKEN_DOT && peek(p, *k + 1)->type == TOKEN_IDENTIFIER) *k += 2;
+        } else if (!has_name(p->type_names, p->type_name_count, name)) {
+            return false;
+        }
+        if (peek(p, *k)->type == TOKEN_LT) {
+            do {
+                (*k)++;
+                if (!scan_type(p, k)) return false;
+            } while (peek(p, *k)->type == TOKEN_COMMA);
+            if (peek(p, *k)->type != TOKEN_GT) return false;
+            (*k)++;
+        }
+    } else {
+        return false;
+    }
+    
+    while (true) {
+        if (peek(p, *k)->type == TOKEN_LBRACKET && peek(p, *k + 1)->type == TOKEN_INTEGER &&
+            peek(p, *k + 2)->type == TOKEN_RBRACKET) {
+            *k += 3;
+        } else if (peek(p, *k)->type == TOKEN_STAR) {
+            (*k)++;
+            if (peek(p, *k)->type == TOKEN_BANG) (*k)++;
+        } else {
+            return true;
+        }
+    }
+}
+
+// With current at '<', decide whether it opens generic arguments of a call
+// rather than a comparison: a comma-separated list of types built from
+// primitives and names known to be types, closed by '>' and immediately
+// followed by '('. In g(a < b, c > (d)), b is not a type, so it compares.
+static bool looks_like_generic_args(Parser *p) {
+    size_t k = 1;
+    do {
+        if (!scan_type(p, &k)) return false;
+    } while (peek(p, k++)->type == TOKEN_COMMA);
+    return peek(p, k - 1)->type == TOKEN_GT && peek(p, k)->type == TOKEN_LPAREN;
+}
+
 static bool check(Parser *p, TokenType type) {
     return p->current->type == type;
 }
@@ -174,7 +318,7 @@ static Type *parse_type(Parser *p) {
         expect(p, TOKEN_GT, "expected '>' after type parameter");
         
         // Placeholder types are just struct types with the parameter name
-        type = type_create_struct(type_param ? type_param->lexeme : "T", NULL, 0);
+        type = type_create_struct(type_param ? token_lexeme(type_param) : "T", NULL, 0);
     }
     // Check for function type: func(T1, T2) -> T3
     else if (match(p, TOKEN_FUNC)) {
@@ -201,6 +345,7 @@ static Type *parse_type(Parser *p) {
             return_type = type_create_primitive(TOKEN_VOID);
         }
         
+        param_types = arena_node_adopt(param_types, sizeof(Type*) * param_count);
         type = type_create_function(return_type, param_types, param_count);
     }
     // Check for result type: result<T, E>
@@ -225,15 +370,15 @@ static Type *parse_type(Parser *p) {
     else if (p->current->type == TOKEN_IDENTIFIER) {
         Token *name_tok = expect(p, TOKEN_IDENTIFIER, "expected type name");
         char full_name[512] = "";
-        if (name_tok && name_tok->lexeme) {
-            strncpy(full_name, name_tok->lexeme, 511);
+        if (name_tok) {
+            strncpy(full_name, token_lexeme(name_tok), 511);
         }
         
         while (match(p, TOKEN_DOT)) {
             strncat(full_name, ".", 511 - strlen(full_name));
             Token *member = expect(p, TOKEN_IDENTIFIER, "expected member name after '.'");
-            if (member && member->lexeme) {
-                strncat(full_name, member->lexeme, 511 - strlen(full_name));
+            if (member) {
+                strncat(full_name, token_lexeme(member), 511 - strlen(full_name));
             }
         }
         
@@ -251,6 +396,7 @@ static Type *parse_type(Parser *p) {
             expect(p, TOKEN_GT, "expected '>' after generic arguments");
         }
         
+        args = arena_node_adopt(args, sizeof(Type*) * arg_count);
         type = type_create_struct(name, args, arg_count);
         free(name);
     }
@@ -425,6 +571,8 @@ static ASTExpr *parse_postfix(Parser *p) {
             expect(p, TOKEN_RPAREN, "expected ')' after arguments");
             
             // Create call with any pending generic args
+            args = arena_node_adopt(args, sizeof(ASTExpr*) * arg_count);
+            generic_args = arena_node_adopt(generic_args, sizeof(Type*) * generic_count);
             expr = ast_create_call(expr, args, arg_count, generic_args, generic_count, line, column);
             
             // Reset generics as they are consumed
@@ -432,35 +580,8 @@ static ASTExpr *parse_postfix(Parser *p) {
             generic_count = 0;
         }
         else if (check(p, TOKEN_LT)) {
-            // Check for potential generics: <Type, ...>
-            // We use a heuristic: if next token is a primitive type (e.g. i32), we assume generics.
-            // Safe for generics.vx which uses max<i32>.
-            // Conservative: Only <PRIMITIVE_TYPE... supported for now.
-            
-            // Save lexer state
-            size_t pos = p->lexer->pos;
-            size_t line = p->lexer->line;
-            size_t column = p->lexer->column;
-            char current_char = p->lexer->current;
-            
-            // We need to skip the current token '<' which is already in p->current?
-            // No, p->current is the Lookahead (LT). 
-            // We need to see what comes AFTER p->current.
-            // The lexer->pos is actually usually at p->current end + whitespace + lookahead?
-            // It depends on implementation of advance(p).
-            // But manually scanning via lexer_next_token() moves forward from WHEREVER lexer is.
-            // Since p->current is <, lexer might be after <.
-            // Let's assume lexer is ready to read NEXT token.
-            
-            Token *peek = lexer_next_token(p->lexer);
-            bool is_generics = (peek->type >= TOKEN_I8 && peek->type <= TOKEN_VOID);
-            
-            // Restore lexer state
-            p->lexer->pos = pos;
-            p->lexer->line = line;
-            p->lexer->column = column;
-            p->lexer->current = current_char;
-            token_free(peek);
+            // Explicit generic arguments: name<Type, ...>(args)
+            bool is_generics = looks_like_generic_args(p);
             
             if (is_generics) {
                 match(p, TOKEN_LT); // Consume <
@@ -515,7 +636,7 @@ static ASTExpr *parse_postfix(Parser *p) {
             size_t column = p->previous->column;
             Token *member = expect(p, TOKEN_IDENTIFIER, "expected member name");
             if (member) {
-                expr = ast_create_member(expr, member->lexeme, false, line, column);
+                expr = ast_create_member(expr, token_lexeme(member), false, line, column);
             }
         }
         else if (match(p, TOKEN_ARROW)) {
@@ -524,7 +645,7 @@ static ASTExpr *parse_postfix(Parser *p) {
             size_t column = p->previous->column;
             Token *member = expect(p, TOKEN_IDENTIFIER, "expected member name");
             if (member) {
-                expr = ast_create_member(expr, member->lexeme, true, line, column);
+                expr = ast_create_member(expr, token_lexeme(member), true, line, column);
             }
         }
         else {
@@ -552,7 +673,7 @@ static ASTExpr *parse_primary(Parser *p) {
         p->current->type == TOKEN_STRING || p->current->type == TOKEN_TRUE ||
         p->current->type == TOKEN_FALSE || p->current->type == TOKEN_NULL) {
         // Create a copy of the token for the AST
-        Token *token_copy = token_create(p->current->type, p->current->lexeme, 
+        Token *token_copy = token_create(p->current->type, token_lexeme(p->current), 
                                          p->current->line, p->current->column);
         token_copy->value = p->current->value;
         advance(p);
@@ -561,7 +682,7 @@ static ASTExpr *parse_primary(Parser *p) {
     
     // Identifiers
     if (p->current->type == TOKEN_IDENTIFIER) {
-        char *name = p->current->lexeme;
+        const char *name = token_lexeme(p->current);
         size_t line = p->current->line;
         size_t column = p->current->column;
         advance(p);
@@ -582,7 +703,7 @@ static ASTExpr *parse_primary(Parser *p) {
         
         char func_name[64];
         if (ctor) {
-            snprintf(func_name, sizeof(func_name), "result::%s", ctor->lexeme);
+            snprintf(func_name, sizeof(func_name), "result::%s", token_lexeme(ctor));
             // Verify name? For now assume semantic analysis checks valid members
         }
         
@@ -602,6 +723,7 @@ static ASTExpr *parse_primary(Parser *p) {
         
         // Treat as a function call "result::ok" or "result::err"
         ASTExpr *callee = ast_create_variable(func_name, p->previous->line, p->previous->column);
+        args = arena_node_adopt(args, sizeof(ASTExpr*) * arg_count);
         return ast_create_call(callee, args, arg_count, 
                                NULL, 0, // No generic args for now, inferred?
                                p->previous->line, p->previous->column);
@@ -683,8 +805,8 @@ static ASTStmt *parse_var_decl(Parser *p) {
     
     // Copy the name to a local buffer immediately before the token gets freed
     char var_name[256] = "";
-    if (name_token && name_token->lexeme) {
-        strncpy(var_name, name_token->lexeme, sizeof(var_name) - 1);
+    if (name_token) {
+        strncpy(var_name, token_lexeme(name_token), sizeof(var_name) - 1);
         var_name[sizeof(var_name) - 1] = '\0';
     }
     
@@ -707,8 +829,8 @@ static ASTDecl *parse_global_var_decl(Parser *p, bool is_public) {
     Token *name_token = expect(p, TOKEN_IDENTIFIER, "expected variable name");
     
     char var_name[256] = "";
-    if (name_token && name_token->lexeme) {
-        strncpy(var_name, name_token->lexeme, sizeof(var_name) - 1);
+    if (name_token) {
+        strncpy(var_name, token_lexeme(name_token), sizeof(var_name) - 1);
         var_name[sizeof(var_name) - 1] = '\0';
     }
     
@@ -755,7 +877,7 @@ static ASTStmt *parse_while_stmt(Parser *p) {
 
 
 static ASTStmt *desugar_for_in(Type *elem_type, const char *elem_name, ASTExpr *collection, ASTStmt *user_body, size_t line, size_t column) {
-    ASTStmt **stmts = malloc(sizeof(ASTStmt*) * 2);
+    ASTStmt **stmts = arena_node_alloc(sizeof(ASTStmt*) * 2);
     
     // 1. var __slice = collection[..];
     // Create [..] slice expression
@@ -789,7 +911,7 @@ static ASTStmt *desugar_for_in(Type *elem_type, const char *elem_name, ASTExpr *
     ASTExpr *inc = ast_create_binary(TOKEN_EQ, i_var2, add, line, column);
     
     // Body: { var elem = __slice[__i]; user_body }
-    ASTStmt **body_stmts = malloc(sizeof(ASTStmt*) * 2);
+    ASTStmt **body_stmts = arena_node_alloc(sizeof(ASTStmt*) * 2);
     // var elem = __slice[__i]
     ASTExpr *slice_var_body = ast_create_variable("__slice", line, column);
     ASTExpr *idx_var = ast_create_variable("__i", line, column);
@@ -823,8 +945,8 @@ static ASTStmt *parse_for_stmt(Parser *p) {
         // Variable Name
         Token *name_tok = expect(p, TOKEN_IDENTIFIER, "expected variable name");
         char var_name[256] = "";
-        if (name_tok && name_tok->lexeme) {
-            strncpy(var_name, name_tok->lexeme, 255);
+        if (name_tok) {
+            strncpy(var_name, token_lexeme(name_tok), 255);
         }
         
         // Check for 'in' (For-In Loop)
@@ -883,7 +1005,7 @@ static ASTStmt *parse_match_stmt(Parser *p) {
         Token *tag_token = expect(p, TOKEN_IDENTIFIER, "expected pattern tag");
         char *tag = NULL;
         if (tag_token) {
-            tag = strdup(tag_token->lexeme);
+            tag = arena_node_strdup(token_lexeme(tag_token));
         }
         
         // Optional capture: (var)
@@ -891,7 +1013,7 @@ static ASTStmt *parse_match_stmt(Parser *p) {
         if (match(p, TOKEN_LPAREN)) {
             Token *cap_token = expect(p, TOKEN_IDENTIFIER, "expected capture variable name");
             if (cap_token) {
-                capture = strdup(cap_token->lexeme);
+                capture = arena_node_strdup(token_lexeme(cap_token));
             }
             expect(p, TOKEN_RPAREN, "expected ')'");
         }
@@ -913,6 +1035,7 @@ static ASTStmt *parse_match_stmt(Parser *p) {
     
     expect(p, TOKEN_RBRACE, "expected '}' after match cases");
     
+    cases = arena_node_adopt(cases, sizeof(ASTMatchCase) * case_count);
     return ast_create_match(expr, cases, case_count, line, column);
 }
 
@@ -967,6 +1090,7 @@ static ASTStmt *parse_block(Parser *p) {
     
     expect(p, TOKEN_RBRACE, "expected '}' after block");
     
+    statements = arena_node_adopt(statements, sizeof(ASTStmt*) * count);
     return ast_create_block(statements, count, line, column);
 }
 
@@ -979,7 +1103,7 @@ static ASTDecl *parse_module(Parser *p) {
     if (!path_token) return NULL;
     
     char path[256];
-    strncpy(path, path_token->lexeme, sizeof(path) - 1);
+    strncpy(path, token_lexeme(path_token), sizeof(path) - 1);
     path[sizeof(path) - 1] = '\0';
     
     expect(p, TOKEN_SEMICOLON, "expected ';' after module declaration");
@@ -995,7 +1119,7 @@ static ASTDecl *parse_import(Parser *p) {
     if (!path_token) return NULL;
     
     char path[256];
-    strncpy(path, path_token->lexeme, sizeof(path) - 1);
+    strncpy(path, token_lexeme(path_token), sizeof(path) - 1);
     path[sizeof(path) - 1] = '\0';
     
     char alias_buf[256];
@@ -1005,7 +1129,7 @@ static ASTDecl *parse_import(Parser *p) {
     if (match(p, TOKEN_AS)) {
         Token *alias_token = expect(p, TOKEN_IDENTIFIER, "expected alias name after 'as'");
         if (alias_token) {
-            strncpy(alias_buf, alias_token->lexeme, sizeof(alias_buf) - 1);
+            strncpy(alias_buf, token_lexeme(alias_token), sizeof(alias_buf) - 1);
             alias_buf[sizeof(alias_buf) - 1] = '\0';
             alias = alias_buf;
         }
@@ -1079,7 +1203,7 @@ static ASTDecl *parse_function(Parser *p, bool is_public, bool is_unsafe) {
     size_t column = p->previous->column;
     
     Token *name_token = expect(p, TOKEN_IDENTIFIER, "expected function name");
-    char *func_name = name_token ? strdup(name_token->lexeme) : strdup("");
+    char *func_name = name_token ? strdup(token_lexeme(name_token)) : strdup("");
     
     // Generic type parameters
     char **type_params = NULL;
@@ -1090,7 +1214,7 @@ static ASTDecl *parse_function(Parser *p, bool is_public, bool is_unsafe) {
             Token *param_token = expect(p, TOKEN_IDENTIFIER, "expected type parameter name");
             if (param_token) {
                 type_params = realloc(type_params, sizeof(char*) * (type_param_count + 1));
-                type_params[type_param_count++] = strdup(param_token->lexeme);
+                type_params[type_param_count++] = arena_node_strdup(token_lexeme(param_token));
             }
         } while (match(p, TOKEN_COMMA));
         expect(p, TOKEN_GT, "expected '>' after type parameters");
@@ -1109,7 +1233,7 @@ static ASTDecl *parse_function(Parser *p, bool is_public, bool is_unsafe) {
             
             params = realloc(params, sizeof(ASTParam) * (param_count + 1));
             params[param_count].param_type = param_type;
-            params[param_count].name = param_name ? strdup(param_name->lexeme) : strdup("");
+            params[param_count].name = arena_node_strdup(param_name ? token_lexeme(param_name) : "");
             param_count++;
         } while (match(p, TOKEN_COMMA));
     }
@@ -1128,6 +1252,8 @@ static ASTDecl *parse_function(Parser *p, bool is_public, bool is_unsafe) {
     expect(p, TOKEN_LBRACE, "expected '{' before function body");
     ASTStmt *body = parse_block(p);
     
+    type_params = arena_node_adopt(type_params, sizeof(char*) * type_param_count);
+    params = arena_node_adopt(params, sizeof(ASTParam) * param_count);
     return ast_create_function(func_name, type_params, type_param_count, params, param_count, return_type, body, is_public, false, false, is_unsafe, line, column);
 }
 
@@ -1137,7 +1263,7 @@ static ASTDecl *parse_extern(Parser *p, bool is_public) {
     
     expect(p, TOKEN_FUNC, "expected 'func' after 'extern'");
     Token *name_token = expect(p, TOKEN_IDENTIFIER, "expected function name");
-    char *func_name = name_token ? strdup(name_token->lexeme) : strdup("");
+    char *func_name = name_token ? strdup(token_lexeme(name_token)) : strdup("");
     
     // Generic type parameters
     char **type_params = NULL;
@@ -1148,7 +1274,7 @@ static ASTDecl *parse_extern(Parser *p, bool is_public) {
             Token *param_token = expect(p, TOKEN_IDENTIFIER, "expected type parameter name");
             if (param_token) {
                 type_params = realloc(type_params, sizeof(char*) * (type_param_count + 1));
-                type_params[type_param_count++] = strdup(param_token->lexeme);
+                type_params[type_param_count++] = arena_node_strdup(token_lexeme(param_token));
             }
         } while (match(p, TOKEN_COMMA));
         expect(p, TOKEN_GT, "expected '>' after type parameters");
@@ -1176,7 +1302,7 @@ static ASTDecl *parse_extern(Parser *p, bool is_public) {
             
             params = realloc(params, sizeof(ASTParam) * (param_count + 1));
             params[param_count].param_type = type;
-            params[param_count].name = name_tok ? strdup(name_tok->lexeme) : strdup("");
+            params[param_count].name = arena_node_strdup(name_tok ? token_lexeme(name_tok) : "");
             params[param_count].line = p_line;
             params[param_count].column = p_column;
             param_count++;
@@ -1194,6 +1320,8 @@ static ASTDecl *parse_extern(Parser *p, bool is_public) {
     
     expect(p, TOKEN_SEMICOLON, "expected ';' after extern declaration");
     
+    type_params = arena_node_adopt(type_params, sizeof(char*) * type_param_count);
+    params = arena_node_adopt(params, sizeof(ASTParam) * param_count);
     return ast_create_function(func_name, type_params, type_param_count, params, param_count, return_type, NULL, is_public, true, is_variadic, false, line, column);
 }
 
@@ -1202,7 +1330,7 @@ static ASTDecl *parse_struct(Parser *p, bool is_public, bool is_packed) {
     size_t column = p->previous->column;
     
     Token *name_token = expect(p, TOKEN_IDENTIFIER, "expected struct name");
-    char *struct_name = name_token ? strdup(name_token->lexeme) : strdup("");
+    char *struct_name = name_token ? strdup(token_lexeme(name_token)) : strdup("");
     
     // Generic type parameters
     char **type_params = NULL;
@@ -1213,7 +1341,7 @@ static ASTDecl *parse_struct(Parser *p, bool is_public, bool is_packed) {
             Token *param_token = expect(p, TOKEN_IDENTIFIER, "expected type parameter name");
             if (param_token) {
                 type_params = realloc(type_params, sizeof(char*) * (type_param_count + 1));
-                type_params[type_param_count++] = strdup(param_token->lexeme);
+                type_params[type_param_count++] = arena_node_strdup(token_lexeme(param_token));
             }
         } while (match(p, TOKEN_COMMA));
         expect(p, TOKEN_GT, "expected '>' after type parameters");
@@ -1228,7 +1356,7 @@ static ASTDecl *parse_struct(Parser *p, bool is_public, bool is_packed) {
     while (!check(p, TOKEN_RBRACE) && !check(p, TOKEN_EOF)) {
         Type *field_type = parse_type(p);
         Token *field_name = expect(p, TOKEN_IDENTIFIER, "expected field name");
-        char *name_copy = field_name ? strdup(field_name->lexeme) : strdup("");
+        char *name_copy = arena_node_strdup(field_name ? token_lexeme(field_name) : "");
         
         expect(p, TOKEN_SEMICOLON, "expected ';' after field");
         
@@ -1241,6 +1369,8 @@ static ASTDecl *parse_struct(Parser *p, bool is_public, bool is_packed) {
     expect(p, TOKEN_RBRACE, "expected '}' after struct fields");
     expect(p, TOKEN_SEMICOLON, "expected ';' after struct declaration");
     
+    type_params = arena_node_adopt(type_params, sizeof(char*) * type_param_count);
+    fields = arena_node_adopt(fields, sizeof(ASTField) * field_count);
     return ast_create_struct(struct_name, type_params, type_param_count, fields, field_count, is_public, is_packed, line, column);
 }
 
@@ -1249,7 +1379,7 @@ static ASTDecl *parse_enum(Parser *p, bool is_public) {
     size_t column = p->previous->column;
     
     Token *name_token = expect(p, TOKEN_IDENTIFIER, "expected enum name");
-    char *enum_name = name_token ? strdup(name_token->lexeme) : strdup("");
+    char *enum_name = name_token ? strdup(token_lexeme(name_token)) : strdup("");
     
     // Generic type parameters
     char **type_params = NULL;
@@ -1260,7 +1390,7 @@ static ASTDecl *parse_enum(Parser *p, bool is_public) {
             Token *param_token = expect(p, TOKEN_IDENTIFIER, "expected type parameter name");
             if (param_token) {
                 type_params = realloc(type_params, sizeof(char*) * (type_param_count + 1));
-                type_params[type_param_count++] = strdup(param_token->lexeme);
+                type_params[type_param_count++] = arena_node_strdup(token_lexeme(param_token));
             }
         } while (match(p, TOKEN_COMMA));
         expect(p, TOKEN_GT, "expected '>' after type parameters");
@@ -1277,7 +1407,7 @@ static ASTDecl *parse_enum(Parser *p, bool is_public) {
             Token *variant_name = expect(p, TOKEN_IDENTIFIER, "expected variant name");
             
             variants = realloc(variants, sizeof(ASTEnumVariant) * (variant_count + 1));
-            variants[variant_count].name = variant_name ? strdup(variant_name->lexeme) : strdup("");
+            variants[variant_count].name = arena_node_strdup(variant_name ? token_lexeme(variant_name) : "");
             variant_count++;
         } while (match(p, TOKEN_COMMA));
     }
@@ -1285,6 +1415,8 @@ static ASTDecl *parse_enum(Parser *p, bool is_public) {
     expect(p, TOKEN_RBRACE, "expected '}' after enum variants");
     expect(p, TOKEN_SEMICOLON, "expected ';' after enum declaration");
     
+    type_params = arena_node_adopt(type_params, sizeof(char*) * type_param_count);
+    variants = arena_node_adopt(variants, sizeof(ASTEnumVariant) * variant_count);
     return ast_create_enum(enum_name, type_params, type_param_count, variants, variant_count, is_public, line, column);
 }
 
@@ -1293,7 +1425,7 @@ static ASTDecl *parse_type_alias(Parser *p, bool is_public) {
     size_t column = p->previous->column;
 
     Token *name_token = expect(p, TOKEN_IDENTIFIER, "expected type alias name");
-    char *name = name_token ? strdup(name_token->lexeme) : strdup("");
+    char *name = name_token ? strdup(token_lexeme(name_token)) : strdup("");
 
     expect(p, TOKEN_EQ, "expected '=' after type alias name");
 
@@ -1329,9 +1461,9 @@ ASTProgram *parser_parse(Parser *p) {
                 parser_error(p, "import statements must precede other declarations");
             }
             imports = realloc(imports, sizeof(ASTImportDecl*) * (import_count + 1));
-            ASTImportDecl *import = malloc(sizeof(ASTImportDecl));
-            import->import_path = strdup(decl->data.import_decl.import_path);
-            import->alias = decl->data.import_decl.alias ? strdup(decl->data.import_decl.alias) : NULL;
+            ASTImportDecl *import = arena_node_alloc(sizeof(ASTImportDecl));
+            import->import_path = arena_node_strdup(decl->data.import_decl.import_path);
+            import->alias = arena_node_strdup(decl->data.import_decl.alias);
             imports[import_count++] = import;
             ast_free_decl(decl);
         } else {
@@ -1345,9 +1477,9 @@ ASTProgram *parser_parse(Parser *p) {
         // Free everything on error
         if (module_name) free(module_name);
         for (size_t i = 0; i < import_count; i++) {
-            free(imports[i]->import_path);
-            if (imports[i]->alias) free(imports[i]->alias);
-            free(imports[i]);
+            arena_node_free(imports[i]->import_path);
+            arena_node_free(imports[i]->alias);
+            arena_node_free(imports[i]);
         }
         free(imports);
         for (size_t i = 0; i < decl_count; i++) {
@@ -1357,5 +1489,7 @@ ASTProgram *parser_parse(Parser *p) {
         return NULL;
     }
     
+    imports = arena_node_adopt(imports, sizeof(ASTImportDecl*) * import_count);
+    declarations = arena_node_adopt(declarations, sizeof(ASTDecl*) * decl_count);
     return ast_create_program(module_name, imports, import_count, declarations, decl_count);
 }
@@ -0,0 +1,294 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../include/passes.h"
+#include "../include/iropt.h"
+#include "../include/ssa.h"
+#include "../include/bce.h"
+#include "../include/inliner.h"
+#include "../include/cache.h"
+
+typedef struct {
+    const char *name;
+    bool ssa;       // Runs on SSA form
+    void (*run)(IRModule **modules, size_t module_count, const PassOptions *options);
+} Pass;
+
+#define NO_GROUP ((size_t)-1)
+
+struct PassPipeline {
+    const Pass **passes;
+    size_t *groups;         // Bracket group of each pass, NO_GROUP outside brackets
+    size_t count;
+};
+
+static const char *level_pipelines[PASS_MAX_LEVEL + 1] = {
+    "",
+    "sccp,copyprop,dve,dce",
+    "inline,sccp,copyprop,gvn,dve,bce,strength,licm,copyprop,dve,iv,dce",
+    "inline,[sccp,copyprop,gvn,dve],bce,strength,licm,copyprop,dve,iv,[sccp,copyprop,gvn,dve],dce",
+};
+
+static void for_each_function(IRModule **modules, size_t module_count, void (*run)(IRFunction *func)) {
+    for (size_t m = 0; m < module_count; m++) {
+        for (size_t f = 0; f < modules[m]->function_count; f++) {
+            run(modules[m]->functions[f]);
+        }
+    }
+}
+
+static void for_each_module(IRModule **modules, size_t module_count, void (*run)(IRModule *module)) {
+    for (size_t m = 0; m < module_count; m++) {
+        run(modules[m]);
+    }
+}
+
+static void run_inline(IRModule **modules, size_t module_count, const PassOptions *options) {
+    inliner_run(modules, module_count, options->inline_threshold);
+}
+
+static void run_sccp(IRModule **modules, size_t module_count, const PassOptions *options) {
+    (void)options;
+    for_each_function(modules, module_count, iropt_sccp);
+}
+
+static void run_copyprop(IRModule **modules, size_t module_count, const PassOptions *options) {
+    (void)options;
+    for_each_function(modules, module_count, iropt_copy_propagation);
+}
+
+static void run_gvn(IRModule **modules, size_t module_count, const PassOptions *options) {
+    (void)options;
+    for_each_function(modules, module_count, iropt_global_value_numbering);
+}
+
+static void run_dve(IRModule **modules, size_t module_count, const PassOptions *options) {
+    (void)options;
+    for_each_function(modules, module_count, iropt_dead_value_elimination);
+}
+
+static void run_bce(IRModule **modules, size_t module_count, const PassOptions *options) {
+    for (size_t m = 0; m < module_count; m++) {
+        for (size_t f = 0; f < modules[m]->function_count; f++) {
+            bce_run(modules[m]->functions[f], options->report_bce);
+        }
+    }
+}
+
+static void run_strength(IRModule **modules, size_t module_count, const PassOptions *options) {
+    (void)options;
+    for_each_module(modules, module_count, iropt_strength_reduction);
+}
+
+static void run_licm(IRModule **modules, size_t module_count, const PassOptions *options) {
+    (void)options;
+    for_each_module(modules, module_count, iropt_loop_invariant_code_motion);
+}
+
+static void run_iv(IRModule **modules, size_t module_count, const PassOptions *options) {
+    (void)options;
+    for_each_function(modules, module_count, iropt_induction_variables);
+}
+
+static void run_dce(IRModule **modules, size_t module_count, const PassOptions *options) {
+    (void)options;
+    for_each_module(modules, module_count, iropt_dead_code_elimination);
+}
+
+static const Pass passes[] = {
+    {"inline", false, run_inline},
+    {"sccp", true, run_sccp},
+    {"copyprop", true, run_copyprop},
+    {"gvn", true, run_gvn},
+    {"dve", true, run_dve},
+    {"bce", false, run_bce},
+    {"strength", false, run_strength},
+    {"licm", false, run_licm},
+    {"iv", true, run_iv},
+    {"dce", false, run_dce},
+};
+
+static const Pass *find_pass(const char *name, size_t length) {
+    for (size_t i = 0; i < sizeof(passes) / sizeof(passes[0]); i++) {
+        if (strlen(passes[i].name) == length && strncmp(passes[i].name, name, length) == 0) {
+            return &passes[i];
+        }
+    }
+    return NULL;
+}
+
+bool pass_exists(const char *name) {
+    return find_pass(name, strlen(name)) != NULL;
+}
+
+const char *pass_pipeline_for_level(int level) {
+    if (level < 0) level = 0;
+    if (level > PASS_MAX_LEVEL) level = PASS_MAX_LEVEL;
+    return level_pipelines[level];
+}
+
+PassPipeline *pass_pipeline_parse(const char *spec) {
+    PassPipeline *pipeline = malloc(sizeof(PassPipeline));
+    size_t capacity = strlen(spec) / 2 + 1;
+    pipeline->passes = malloc(capacity * sizeof(Pass *));
+    pipeline->groups = malloc(capacity * sizeof(size_t));
+    pipeline->count = 0;
+
+    size_t group = NO_GROUP;
+    size_t group_count = 0;
+    size_t group_start = 0;
+    const char *p = spec;
+    while (*p) {
+        if (*p == '[') {
+            if (group != NO_GROUP) {
+                fprintf(stderr, "Error: Nested '[' in pass list '%s'\n", spec);
+                pass_pipeline_free(pipeline);
+                return NULL;
+            }
+            group = group_count++;
+            group_start = pipeline->count;
+            p++;
+            continue;
+        }
+        if (*p == ']') {
+            if (group == NO_GROUP || pipeline->count == group_start) {
+                fprintf(stderr, "Error: Unexpected ']' in pass list '%s'\n", spec);
+                pass_pipeline_free(pipeline);
+                return NULL;
+            }
+            group = NO_GROUP;
+            p++;
+            continue;
+        }
+        if (*p == ',') {
+            p++;
+            continue;
+        }
+
+        size_t length = strcspn(p, ",[]");
+        const Pass *pass = find_pass(p, length);
+        if (!pass) {
+            fprintf(stderr, "Error: Unknown pass '%.*s'\n", (int)length, p);
+            pass_pipeline_free(pipeline);
+            return NULL;
+        }
+        pipeline->passes[pipeline->count] = pass;
+        pipeline->groups[pipeline->count] = group;
+        pipeline->count++;
+        p += length;
+    }
+
+    if (group != NO_GROUP) {
+        fprintf(stderr, "Error: Missing ']' in pass list '%s'\n", spec);
+        pass_pipeline_free(pipeline);
+        return NULL;
+    }
+    return pipeline;
+}
+
+void pass_pipeline_free(PassPipeline *pipeline) {
+    if (!pipeline) return;
+    free(pipeline->passes);
+    free(pipeline->groups);
+    free(pipeline);
+}
+
+static uint64_t hash_operand(const IROperand *op, uint64_t hash) {
+    if (!op) return cache_hash_u64(UINT64_MAX, hash);
+    hash = cache_hash_u64((uint64_t)op->kind, hash);
+    switch (op->kind) {
+        case IR_OP_TEMP:
+            return cache_hash_u64((uint64_t)op->data.temp_id, hash);
+        case IR_OP_CONST:
+            return cache_hash_u64((uint64_t)op->data.const_value, hash);
+        case IR_OP_FLOAT:
+            return cache_hash_bytes(&op->data.float_value, sizeof(double), hash);
+        case IR_OP_VAR:
+            return cache_hash_string(op->data.var_name, hash);
+        case IR_OP_LABEL:
+            return cache_hash_string(op->data.label_name, hash);
+        case IR_OP_STRING:
+            return cache_hash_string(op->data.string_value, hash);
+    }
+    return hash;
+}
+
+// Fingerprint of every instruction in the program, to tell whether a
+// round of a group changed anything
+static uint64_t hash_program(IRModule **modules, size_t module_count) {
+    uint64_t hash = 0;
+    for (size_t m = 0; m < module_count; m++) {
+        IRModule *module = modules[m];
+        for (size_t f = 0; f < module->function_count; f++) {
+            IRFunction *func = module->functions[f];
+            hash = cache_hash_u64(func->instruction_count, hash);
+            for (size_t i = 0; i < func->instruction_count; i++) {
+                IRInstruction *instr = func->instructions[i];
+                hash = cache_hash_u64((uint64_t)instr->opcode, hash);
+                hash = hash_operand(instr->dest, hash);
+                hash = hash_operand(instr->src1, hash);
+                hash = hash_operand(instr->src2, hash);
+                for (size_t a = 0; a < instr->arg_count; a++) {
+                    hash = hash_operand(instr->args[a], hash);
+                }
+            }
+        }
+    }
+    return hash;
+}
+
+typedef struct {
+    IRModule **modules;
+    size_t module_count;
+    const PassOptions *options;
+    bool in_ssa;
+} PassRun;
+
+static void run_pass(PassRun *run, const Pass *pass) {
+    if (pass->ssa != run->in_ssa) {
+        for_each_function(run->modules, run->module_count, pass->ssa ? ssa_construct : ssa_destruct);
+        run->in_ssa = pass->ssa;
+    }
+    pass->run(run->modules, run->module_count, run->options);
+
+    const char *print_after = run->options->print_after;
+    if (print_after && strcmp(print_after, pass->name) == 0) {
+        printf("*** IR after %s ***\n", pass->name);
+        for (size_t m = 0; m < run->module_count; m++) {
+            ir_module_print(run->modules[m]);
+        }
+    }
+}
+
+void pass_pipeline_run(const PassPipeline *pipeline, IRModule **modules, size_t module_count, const PassOptions *options) {
+    PassRun run = {modules, module_count, options, false};
+
+    size_t i = 0;
+    while (i < pipeline->count) {
+        size_t group = pipeline->groups[i];
+        if (group == NO_GROUP) {
+            run_pass(&run, pipeline->passes[i]);
+            i++;
+            continue;
+        }
+
+        size_t end = i;
+        while (end < pipeline->count && pipeline->groups[end] == group) end++;
+        uint64_t before = hash_program(modules, module_count);
+        for (size_t round = 0; round < PASS_MAX_ROUNDS; round++) {
+            for (size_t k = i; k < end; k++) {
+                run_pass(&run, pipeline->passes[k]);
+            }
+            uint64_t after = hash_program(modules, module_count);
+            if (after == before) break;
+            before = after;
+        }
+        i = end;
+    }
+
+    if (run.in_ssa) {
+        for_each_function(modules, module_count, ssa_destruct);
+    }
+}
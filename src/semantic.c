@@ -6,6 +6,8 @@
 #include "../include/error.h"
 #include "../include/util.h"
 #include "../include/monomorph.h"
+#include "../include/arena.h"
+#include "../include/intern.h"
 
 // Forward declarations
 static void analyze_stmt(SemanticAnalyzer *sa, ASTStmt *stmt);
@@ -50,8 +52,6 @@ void semantic_free(SemanticAnalyzer *sa) {
     if (sa->instantiation_registry) {
         for (size_t i = 0; i < sa->instantiation_registry->count; i++) {
             GenericInstantiation *inst = &sa->instantiation_registry->instantiations[i];
-            free(inst->base_name);
-            free(inst->mangled_name);
             for (size_t j = 0; j < inst->type_arg_count; j++) {
                 type_free(inst->type_args[j]);
             }
@@ -519,7 +519,7 @@ static Type *analyze_expr_internal(SemanticAnalyzer *sa, ASTExpr *expr) {
                     if (mod_sym && mod_sym->kind == SYMBOL_MODULE) {
                         func_name = expr->data.call.callee->data.member.member;
                         module_name = mod_sym->name;
-                        func_symbol = symtable_lookup(mod_sym->module_table, func_name);
+                        func_symbol = symtable_lookup_global(mod_sym->module_table, func_name);
                         
                         if (func_symbol && !func_symbol->is_public) {
                             char error_msg[256];
@@ -613,7 +613,7 @@ static Type *analyze_expr_internal(SemanticAnalyzer *sa, ASTExpr *expr) {
             if (func_symbol->type_param_count > 0) {
                 if (expr->data.call.generic_count == 0) {
                     // Attempt inference
-                    Type **inferred = calloc(func_symbol->type_param_count, sizeof(Type*));
+                    Type **inferred = arena_node_calloc(sizeof(Type*) * func_symbol->type_param_count);
                     bool success = true;
                     
                     for (size_t i = 0; i < func_symbol->param_count && i < expr->data.call.arg_count; i++) {
@@ -646,7 +646,7 @@ static Type *analyze_expr_internal(SemanticAnalyzer *sa, ASTExpr *expr) {
                     } else {
                         // Cleanup
                         for(size_t k=0; k<func_symbol->type_param_count; k++) type_free(inferred[k]);
-                        free(inferred);
+                        arena_node_free(inferred);
                         
                         semantic_error(sa, expr->line, expr->column, "cannot infer generic type arguments");
                         return NULL;
@@ -753,7 +753,7 @@ static Type *analyze_expr_internal(SemanticAnalyzer *sa, ASTExpr *expr) {
             if (expr->data.member.object->type == AST_VARIABLE_EXPR && !expr->data.member.is_arrow) {
                 Symbol *sym = symtable_lookup(sa->symtable, expr->data.member.object->data.variable.name);
                 if (sym && sym->kind == SYMBOL_MODULE) {
-                    Symbol *member_sym = symtable_lookup(sym->module_table, expr->data.member.member);
+                    Symbol *member_sym = symtable_lookup_global(sym->module_table, expr->data.member.member);
                     if (!member_sym) {
                         char error_msg[256];
                         snprintf(error_msg, sizeof(error_msg), "module '%s' has no member '%s'", sym->name, expr->data.member.member);
@@ -1190,12 +1190,12 @@ static bool infer_type(SemanticAnalyzer *sa, Type *param_type, Type *arg_type, c
 }
 
 
-// Check if a generic instantiation already exists
+// Check if a generic instantiation already exists (base_name must be interned)
 static GenericInstantiation *find_instantiation(InstantiationRegistry *registry, const char *base_name, 
                                                  Type **type_args, size_t type_arg_count) {
     for (size_t i = 0; i < registry->count; i++) {
         GenericInstantiation *inst = &registry->instantiations[i];
-        if (strcmp(inst->base_name, base_name) != 0) continue;
+        if (inst->base_name != base_name) continue;
         if (inst->type_arg_count != type_arg_count) continue;
         
         bool match = true;
@@ -1217,6 +1217,7 @@ static GenericInstantiation *register_instantiation(SemanticAnalyzer *sa, const
                                                      Type **type_args, size_t type_arg_count,
                                                      Symbol *original_symbol) {
     InstantiationRegistry *registry = sa->instantiation_registry;
+    base_name = intern(base_name);
     
     // Check if already exists
     GenericInstantiation *existing = find_instantiation(registry, base_name, type_args, type_arg_count);
@@ -1231,7 +1232,7 @@ static GenericInstantiation *register_instantiation(SemanticAnalyzer *sa, const
     
     // Create new instantiation
     GenericInstantiation *inst = &registry->instantiations[registry->count++];
-    inst->base_name = strdup(base_name);
+    inst->base_name = base_name;
     inst->type_arg_count = type_arg_count;
     inst->type_args = malloc(sizeof(Type*) * type_arg_count);
     for (size_t i = 0; i < type_arg_count; i++) {
@@ -1262,14 +1263,14 @@ static void resolve_type_alias(SemanticAnalyzer *sa, Type *type, Symbol **out_sy
 
                 *type = *target;
                 
-                free(old_name);
+                arena_node_free(old_name);
                 if (old_args) {
                     for (size_t i = 0; i < old_arg_count; i++) {
                         type_free(old_args[i]);
                     }
-                    free(old_args);
+                    arena_node_free(old_args);
                 }
-                free(target);
+                arena_node_free(target);
 
                 if (type->kind != TYPE_STRUCT && type->kind != TYPE_ENUM) {
                     *out_sym = NULL;
@@ -1282,8 +1283,8 @@ static void resolve_type_alias(SemanticAnalyzer *sa, Type *type, Symbol **out_sy
             // Update name for normalization/mangling if needed
             if (sym->type->data.struct_enum.name && 
                 strcmp(type->data.struct_enum.name, sym->type->data.struct_enum.name) != 0) {
-                free(type->data.struct_enum.name);
-                type->data.struct_enum.name = strdup(sym->type->data.struct_enum.name);
+                arena_node_free(type->data.struct_enum.name);
+                type->data.struct_enum.name = arena_node_strdup(sym->type->data.struct_enum.name);
             }
             
             if (sym->type->kind == TYPE_ENUM && type->kind == TYPE_STRUCT) {
@@ -1343,15 +1344,15 @@ static void resolve_generic_instantiation(SemanticAnalyzer *sa, Type *type, Symb
     }
     
     // Update type name to use mangled name
-    free(type->data.struct_enum.name);
-    type->data.struct_enum.name = strdup(inst->mangled_name);
+    arena_node_free(type->data.struct_enum.name);
+    type->data.struct_enum.name = arena_node_strdup(inst->mangled_name);
     
     // Clear type arguments as they are now baked into the monomorphized type
     if (type->data.struct_enum.type_args) {
         for (size_t i = 0; i < type->data.struct_enum.type_arg_count; i++) {
             type_free(type->data.struct_enum.type_args[i]);
         }
-        free(type->data.struct_enum.type_args);
+        arena_node_free(type->data.struct_enum.type_args);
         type->data.struct_enum.type_args = NULL;
     }
     type->data.struct_enum.type_arg_count = 0;
@@ -1378,6 +1379,12 @@ static void resolve_type(SemanticAnalyzer *sa, Type *type) {
             Symbol *sym = NULL;
             resolve_type_alias(sa, type, &sym);
             
+            // An alias may have turned this into a slice, pointer, ...
+            if (type->kind != TYPE_STRUCT && type->kind != TYPE_ENUM) {
+                resolve_type(sa, type);
+                break;
+            }
+            
             // Resolve generic arguments if any
             for (size_t i = 0; i < type->data.struct_enum.type_arg_count; i++) {
                 resolve_type(sa, type->data.struct_enum.type_args[i]);
@@ -1468,7 +1475,7 @@ bool semantic_analyze_declarations(SemanticAnalyzer *sa, ASTProgram *program) {
         ASTDecl *decl = program->declarations[i];
         
         if (decl->type == AST_STRUCT_DECL) {
-            char *mangled_name = util_mangle_name(sa->symtable->name, decl->data.struct_decl.name);
+            const char *mangled_name = util_mangle_name(sa->symtable->name, decl->data.struct_decl.name);
             
             Symbol *struct_symbol = symbol_create(decl->data.struct_decl.name, SYMBOL_TYPE,
                                                  type_create_struct(mangled_name, NULL, 0),
@@ -1480,11 +1487,10 @@ bool semantic_analyze_declarations(SemanticAnalyzer *sa, ASTProgram *program) {
                 char error_msg[256];
                 snprintf(error_msg, sizeof(error_msg), "duplicate declaration of struct '%s'", decl->data.struct_decl.name);
                 semantic_error(sa, decl->line, decl->column, error_msg);
-                free(mangled_name);
                 continue;
             }
             
-            if (strcmp(decl->data.struct_decl.name, mangled_name) != 0) {
+            if (decl->data.struct_decl.name != mangled_name) {
                 Symbol *mangled_symbol = symbol_create(mangled_name, SYMBOL_TYPE,
                                                      type_create_struct(mangled_name, NULL, 0),
                                                      decl->line, decl->column);
@@ -1492,10 +1498,9 @@ bool semantic_analyze_declarations(SemanticAnalyzer *sa, ASTProgram *program) {
                 mangled_symbol->is_packed = decl->data.struct_decl.is_packed;
                 symtable_insert(sa->symtable, mangled_symbol);
             }
-            free(mangled_name);
         } 
         else if (decl->type == AST_ENUM_DECL) {
-            char *mangled_name = util_mangle_name(sa->symtable->name, decl->data.enum_decl.name);
+            const char *mangled_name = util_mangle_name(sa->symtable->name, decl->data.enum_decl.name);
             
             Symbol *enum_symbol = symbol_create(decl->data.enum_decl.name, SYMBOL_TYPE,
                                                type_create_enum(mangled_name, NULL, 0),
@@ -1506,18 +1511,16 @@ bool semantic_analyze_declarations(SemanticAnalyzer *sa, ASTProgram *program) {
                 char error_msg[256];
                 snprintf(error_msg, sizeof(error_msg), "duplicate declaration of enum '%s'", decl->data.enum_decl.name);
                 semantic_error(sa, decl->line, decl->column, error_msg);
-                free(mangled_name);
                 continue;
             }
             
-            if (strcmp(decl->data.enum_decl.name, mangled_name) != 0) {
+            if (decl->data.enum_decl.name != mangled_name) {
                 Symbol *mangled_symbol = symbol_create(mangled_name, SYMBOL_TYPE,
                                                      type_create_enum(mangled_name, NULL, 0),
                                                      decl->line, decl->column);
                 mangled_symbol->is_public = decl->data.enum_decl.is_public;
                 symtable_insert(sa->symtable, mangled_symbol);
             }
-            free(mangled_name);
         }
         else if (decl->type == AST_TYPE_ALIAS_DECL) {
             // Type alias: type MyInt = i32;
@@ -1562,8 +1565,8 @@ bool semantic_analyze_declarations(SemanticAnalyzer *sa, ASTProgram *program) {
             }
             
             // Sync with mangled symbol if exists
-            char *mangled_name = util_mangle_name(sa->symtable->name, decl->data.struct_decl.name);
-            if (strcmp(decl->data.struct_decl.name, mangled_name) != 0) {
+            const char *mangled_name = util_mangle_name(sa->symtable->name, decl->data.struct_decl.name);
+            if (decl->data.struct_decl.name != mangled_name) {
                 Symbol *mangled_symbol = symtable_lookup_current(sa->symtable, mangled_name);
                 if (mangled_symbol) {
                     mangled_symbol->field_count = struct_symbol->field_count;
@@ -1574,7 +1577,6 @@ bool semantic_analyze_declarations(SemanticAnalyzer *sa, ASTProgram *program) {
                     }
                 }
             }
-            free(mangled_name);
         } 
         else if (decl->type == AST_ENUM_DECL) {
             Symbol *enum_symbol = symtable_lookup_current(sa->symtable, decl->data.enum_decl.name);
@@ -1601,8 +1603,8 @@ bool semantic_analyze_declarations(SemanticAnalyzer *sa, ASTProgram *program) {
             }
             
             // Sync with mangled symbol
-            char *mangled_name = util_mangle_name(sa->symtable->name, decl->data.enum_decl.name);
-            if (strcmp(decl->data.enum_decl.name, mangled_name) != 0) {
+            const char *mangled_name = util_mangle_name(sa->symtable->name, decl->data.enum_decl.name);
+            if (decl->data.enum_decl.name != mangled_name) {
                 Symbol *mangled_symbol = symtable_lookup_current(sa->symtable, mangled_name);
                 if (mangled_symbol) {
                     mangled_symbol->variant_count = enum_symbol->variant_count;
@@ -1612,7 +1614,6 @@ bool semantic_analyze_declarations(SemanticAnalyzer *sa, ASTProgram *program) {
                     }
                 }
             }
-            free(mangled_name);
         }
     }
     
@@ -1634,7 +1635,7 @@ bool semantic_analyze_declarations(SemanticAnalyzer *sa, ASTProgram *program) {
                 resolve_type(sa, decl->data.function.params[k].param_type);
             }
             
-            Type **param_types = malloc(sizeof(Type*) * decl->data.function.param_count);
+            Type **param_types = arena_node_alloc(sizeof(Type*) * decl->data.function.param_count);
             for (size_t k = 0; k < decl->data.function.param_count; k++) {
                 param_types[k] = type_clone(decl->data.function.params[k].param_type);
             }
@@ -1761,7 +1762,7 @@ static Symbol *find_type_symbol(SemanticAnalyzer *sa, const char *name) {
             
             Symbol *mod_sym = symtable_lookup(sa->symtable, module_name);
             if (mod_sym && mod_sym->kind == SYMBOL_MODULE && mod_sym->module_table) {
-                Symbol *found = symtable_lookup(mod_sym->module_table, type_name);
+                Symbol *found = symtable_lookup_global(mod_sym->module_table, type_name);
                 if (found && found->kind == SYMBOL_TYPE) return found;
             }
         }
@@ -1778,7 +1779,7 @@ static Symbol *find_type_symbol(SemanticAnalyzer *sa, const char *name) {
     for (size_t i = 0; i < global_scope->symbol_count; i++) {
         Symbol *s = global_scope->symbols[i];
         if (s->kind == SYMBOL_MODULE && s->module_table) {
-            Symbol *found = symtable_lookup(s->module_table, name);
+            Symbol *found = symtable_lookup_global(s->module_table, name);
             if (found && found->kind == SYMBOL_TYPE) {
                 return found;
             }
@@ -0,0 +1,972 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <limits.h>
+#include "../include/ssa.h"
+
+#define NO_CAND ((size_t)-1)
+
+// Open-addressing map from local names to their index in func->local_vars
+// (parameters follow the locals)
+typedef struct {
+    const char **names;
+    size_t *values;
+    size_t capacity;
+} NameMap;
+
+static uint64_t name_hash(const char *name, size_t len) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void name_map_init(NameMap *map, size_t count) {
+    map->capacity = 16;
+    while (map->capacity < count * 2) map->capacity *= 2;
+    map->names = calloc(map->capacity, sizeof(char*));
+    map->values = calloc(map->capacity, sizeof(size_t));
+}
+
+static void name_map_free(NameMap *map) {
+    free(map->names);
+    free(map->values);
+}
+
+static void name_map_put(NameMap *map, const char *name, size_t value) {
+    size_t len = strlen(name);
+    size_t mask = map->capacity - 1;
+    size_t slot = name_hash(name, len) & mask;
+    while (map->names[slot]) {
+        if (strcmp(map->names[slot], name) == 0) return;
+        slot = (slot + 1) & mask;
+    }
+    map->names[slot] = name;
+    map->values[slot] = value;
+}
+
+// Lookup by (name, len) so identifiers inside expressions need no copy
+static size_t name_map_get(const NameMap *map, const char *name, size_t len) {
+    size_t mask = map->capacity - 1;
+    size_t slot = name_hash(name, len) & mask;
+    while (map->names[slot]) {
+        if (strncmp(map->names[slot], name, len) == 0 && map->names[slot][len] == '\0') {
+            return map->values[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NO_CAND;
+}
+
+const IRType *ssa_temp_type(const IRFunction *func, int temp) {
+    if (temp >= 0 && (size_t)temp < func->temp_count && func->temp_types && func->temp_types[temp]) {
+        return func->temp_types[temp];
+    }
+    return ir_type_long();
+}
+
+bool ssa_const_fits(const IRType *type, long value) {
+    if (!type || type->kind != IR_TYPE_INT || type->is_const) return false;
+    switch (type->size) {
+        case 8: return true;
+        case 4: return value >= INT32_MIN && value <= INT32_MAX;
+        case 2: return value >= INT16_MIN && value <= INT16_MAX;
+        case 1: return value >= INT8_MIN && value <= INT8_MAX;
+        default: return false;
+    }
+}
+
+// Scalars a C local of this type can be replaced by temps of the same type
+static bool is_promotable_type(const IRType *type) {
+    if (!type) return true;  // Declared as long
+    if (type->is_const) return false;
+    return type->kind == IR_TYPE_INT || type->kind == IR_TYPE_UINT ||
+           type->kind == IR_TYPE_FLOAT || type->kind == IR_TYPE_POINTER;
+}
+
+static bool is_terminator(IROpcode opcode) {
+    return opcode == IR_JUMP || opcode == IR_BRANCH || opcode == IR_SWITCH ||
+           opcode == IR_RETURN || opcode == IR_FAIL;
+}
+
+static size_t temp_limit_of(IRFunction *func) {
+    size_t limit = func->temp_count;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IROperand *dest = func->instructions[i]->dest;
+        if (dest && dest->kind == IR_OP_TEMP && dest->data.temp_id >= 0 &&
+            (size_t)dest->data.temp_id >= limit) {
+            limit = (size_t)dest->data.temp_id + 1;
+        }
+    }
+    return limit;
+}
+
+typedef struct {
+    const NameMap *locals;
+    bool *local_blocked;    // Local can't be promoted
+    bool *temp_pinned;
+    size_t temp_limit;
+} PinScan;
+
+static void pin_identifier(const char *ident, size_t len, void *ctx) {
+    PinScan *scan = ctx;
+    int temp = ir_temp_identifier(ident, len);
+    if (temp >= 0 && (size_t)temp < scan->temp_limit) scan->temp_pinned[temp] = true;
+    if (scan->locals) {
+        size_t local = name_map_get(scan->locals, ident, len);
+        if (local != NO_CAND) scan->local_blocked[local] = true;
+    }
+}
+
+static void pin_operand(PinScan *scan, IROperand *op, bool is_addr_operand) {
+    if (!op) return;
+    if (op->kind == IR_OP_TEMP) {
+        if (is_addr_operand && op->data.temp_id >= 0 && (size_t)op->data.temp_id < scan->temp_limit) {
+            scan->temp_pinned[op->data.temp_id] = true;
+        }
+        return;
+    }
+    if (op->kind != IR_OP_VAR) return;
+    if (scan->locals) {
+        size_t local = name_map_get(scan->locals, op->data.var_name, strlen(op->data.var_name));
+        if (local != NO_CAND) {
+            if (is_addr_operand) scan->local_blocked[local] = true;
+            return;
+        }
+    }
+    ir_scan_identifiers(op->data.var_name, pin_identifier, scan);
+}
+
+static void pin_instruction(PinScan *scan, IRInstruction *instr) {
+    bool addr = instr->opcode == IR_ADDR;
+    pin_operand(scan, instr->dest, false);
+    pin_operand(scan, instr->src1, addr);
+    pin_operand(scan, instr->src2, false);
+    for (size_t a = 0; a < instr->arg_count; a++) {
+        pin_operand(scan, instr->args[a], false);
+    }
+}
+
+// Whether the use at instruction use_idx sees the definition at def_idx
+static bool def_dominates_use(const CFG *cfg, size_t def_idx, size_t use_idx, IRInstruction *use) {
+    size_t def_block = cfg->block_of[def_idx];
+    size_t use_block = cfg->block_of[use_idx];
+    if (!cfg_reachable(cfg, use_block)) return true;
+    if (use->opcode == IR_PHI) return true;  // Checked per edge by construction
+    if (def_block == use_block) return def_idx < use_idx;
+    return cfg_dominates(cfg, def_block, use_block);
+}
+
+SSAInfo *ssa_info_build(IRFunction *func, const CFG *cfg) {
+    SSAInfo *info = malloc(sizeof(SSAInfo));
+    size_t limit = temp_limit_of(func);
+    info->temp_limit = limit;
+    info->def = malloc((limit + 1) * sizeof(size_t));
+    info->pinned = calloc(limit + 1, sizeof(bool));
+    size_t *def_count = calloc(limit + 1, sizeof(size_t));
+
+    PinScan scan = { NULL, NULL, info->pinned, limit };
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        pin_instruction(&scan, instr);
+        IROperand *dest = instr->dest;
+        if (dest && dest->kind == IR_OP_TEMP && dest->data.temp_id >= 0) {
+            def_count[dest->data.temp_id]++;
+            info->def[dest->data.temp_id] = i;
+        }
+    }
+    for (size_t t = 0; t < limit; t++) {
+        if (def_count[t] != 1) info->def[t] = CFG_NONE;
+    }
+
+    // Drop temps read somewhere their definition doesn't reach
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        IROperand **slot;
+        for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+            IROperand *op = *slot;
+            if (!op || op->kind != IR_OP_TEMP || op->data.temp_id < 0) continue;
+            size_t t = (size_t)op->data.temp_id;
+            if (t >= limit || info->def[t] == CFG_NONE) continue;
+            if (!def_dominates_use(cfg, info->def[t], i, instr)) info->def[t] = CFG_NONE;
+        }
+        if (instr->opcode == IR_ADDR && instr->src1 && instr->src1->kind == IR_OP_TEMP &&
+            instr->src1->data.temp_id >= 0 && (size_t)instr->src1->data.temp_id < limit) {
+            info->def[instr->src1->data.temp_id] = CFG_NONE;
+        }
+    }
+
+    free(def_count);
+    return info;
+}
+
+void ssa_info_free(SSAInfo *info) {
+    if (!info) return;
+    free(info->def);
+    free(info->pinned);
+    free(info);
+}
+
+bool ssa_is_value(const SSAInfo *info, const IROperand *op) {
+    if (!op) return false;
+    if (op->kind == IR_OP_CONST) return true;
+    if (op->kind != IR_OP_TEMP || op->data.temp_id < 0) return false;
+    size_t t = (size_t)op->data.temp_id;
+    return t < info->temp_limit && info->def[t] != CFG_NONE;
+}
+
+// ---------------------------------------------------------------------
+// Construction
+// ---------------------------------------------------------------------
+
+// Something SSA renaming tracks: a promoted local or parameter, or a
+// reassigned temp
+typedef struct {
+    const IRType *type;
+    const char *param;      // Parameter name, read into entry_temp on entry
+    int entry_temp;
+    bool entry_used;
+    size_t *def_blocks;
+    size_t def_block_count;
+    size_t def_block_capacity;
+    bool is_global;         // Read in some block before being written there
+    int *stack;             // Current SSA temp on the renaming path
+    size_t stack_count;
+    size_t stack_capacity;
+} Candidate;
+
+typedef struct {
+    IRFunction *func;
+    CFG *cfg;
+    Candidate *cands;
+    size_t cand_count;
+    NameMap locals;
+    size_t *local_cand;     // local_vars/params index -> candidate
+    size_t *temp_cand;      // temp id -> candidate
+    size_t temp_limit;
+} SSABuilder;
+
+static size_t operand_candidate(SSABuilder *b, IROperand *op) {
+    if (!op) return NO_CAND;
+    if (op->kind == IR_OP_TEMP) {
+        if (op->data.temp_id < 0 || (size_t)op->data.temp_id >= b->temp_limit) return NO_CAND;
+        return b->temp_cand[op->data.temp_id];
+    }
+    if (op->kind == IR_OP_VAR && b->func->local_var_count > 0) {
+        size_t local = name_map_get(&b->locals, op->data.var_name, strlen(op->data.var_name));
+        return local == NO_CAND ? NO_CAND : b->local_cand[local];
+    }
+    return NO_CAND;
+}
+
+// Operand the instruction assigns, if it is a candidate
+static IROperand **def_slot(SSABuilder *b, IRInstruction *instr, size_t *cand) {
+    if (instr->opcode == IR_STORE) {
+        *cand = operand_candidate(b, instr->src1);
+        return *cand == NO_CAND ? NULL : &instr->src1;
+    }
+    *cand = operand_candidate(b, instr->dest);
+    return *cand == NO_CAND ? NULL : &instr->dest;
+}
+
+static void candidate_add_def_block(Candidate *c, size_t block) {
+    if (c->def_block_count > 0 && c->def_blocks[c->def_block_count - 1] == block) return;
+    if (c->def_block_count == c->def_block_capacity) {
+        c->def_block_capacity = c->def_block_capacity ? c->def_block_capacity * 2 : 4;
+        c->def_blocks = realloc(c->def_blocks, c->def_block_capacity * sizeof(size_t));
+    }
+    c->def_blocks[c->def_block_count++] = block;
+}
+
+static void candidate_push(Candidate *c, int temp) {
+    if (c->stack_count == c->stack_capacity) {
+        c->stack_capacity = c->stack_capacity ? c->stack_capacity * 2 : 8;
+        c->stack = realloc(c->stack, c->stack_capacity * sizeof(int));
+    }
+    c->stack[c->stack_count++] = temp;
+}
+
+static IROperand *candidate_current(Candidate *c) {
+    if (c->stack_count == 0) {
+        // A parameter still holds the argument; anything else is an
+        // uninitialized C local, and any value will do
+        if (!c->param) return ir_operand_const(0);
+        c->entry_used = true;
+        return ir_operand_temp(c->entry_temp);
+    }
+    return ir_operand_temp(c->stack[c->stack_count - 1]);
+}
+
+// Pick what gets renamed: promotable locals and parameters, and temps
+// that are assigned more than once or read where their one definition
+// doesn't reach
+static void find_candidates(SSABuilder *b) {
+    IRFunction *func = b->func;
+    size_t local_count = func->local_var_count + func->param_count;
+    bool *local_blocked = calloc(local_count + 1, sizeof(bool));
+    bool *temp_pinned = calloc(b->temp_limit + 1, sizeof(bool));
+
+    name_map_init(&b->locals, local_count);
+    for (size_t i = 0; i < local_count; i++) {
+        const IRType *type;
+        if (i < func->local_var_count) {
+            name_map_put(&b->locals, func->local_vars[i], i);
+            type = func->local_var_types ? func->local_var_types[i] : NULL;
+        } else {
+            name_map_put(&b->locals, func->params[i - func->local_var_count], i);
+            type = func->param_types ? func->param_types[i - func->local_var_count] : NULL;
+        }
+        if (!is_promotable_type(type)) local_blocked[i] = true;
+    }
+
+    PinScan scan = { &b->locals, local_blocked, temp_pinned, b->temp_limit };
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        pin_instruction(&scan, func->instructions[i]);
+    }
+
+    SSAInfo *info = ssa_info_build(func, b->cfg);
+
+    b->cands = calloc(local_count + b->temp_limit + 1, sizeof(Candidate));
+    b->local_cand = malloc((local_count + 1) * sizeof(size_t));
+    b->temp_cand = malloc((b->temp_limit + 1) * sizeof(size_t));
+    for (size_t i = 0; i < local_count; i++) {
+        b->local_cand[i] = NO_CAND;
+        if (local_blocked[i]) continue;
+        b->local_cand[i] = b->cand_count;
+        Candidate *c = &b->cands[b->cand_count++];
+        if (i < func->local_var_count) {
+            c->type = (func->local_var_types && func->local_var_types[i]) ? func->local_var_types[i] : ir_type_long();
+        } else {
+            size_t p = i - func->local_var_count;
+            c->type = func->param_types[p];
+            c->param = func->params[p];
+        }
+    }
+
+    bool *defined = calloc(b->temp_limit + 1, sizeof(bool));
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IROperand *dest = func->instructions[i]->dest;
+        if (dest && dest->kind == IR_OP_TEMP && dest->data.temp_id >= 0) defined[dest->data.temp_id] = true;
+    }
+    for (size_t t = 0; t < b->temp_limit; t++) {
+        b->temp_cand[t] = NO_CAND;
+        if (!defined[t] || temp_pinned[t] || info->def[t] != CFG_NONE) continue;
+        b->temp_cand[t] = b->cand_count;
+        b->cands[b->cand_count++].type = ssa_temp_type(func, (int)t);
+    }
+
+    for (size_t c = 0; c < b->cand_count; c++) {
+        if (b->cands[c].param) b->cands[c].entry_temp = ir_function_new_temp(func, b->cands[c].type);
+    }
+
+    ssa_info_free(info);
+    free(defined);
+    free(local_blocked);
+    free(temp_pinned);
+}
+
+static IRInstruction **rebuild_begin(IRFunction *func, size_t extra) {
+    return malloc((func->instruction_count + extra + 1) * sizeof(IRInstruction*));
+}
+
+static void rebuild_finish(IRFunction *func, IRInstruction **instructions, size_t count) {
+    free(func->instructions);
+    func->instructions = instructions;
+    func->instruction_count = count;
+    func->instruction_capacity = func->instruction_count + 1;
+}
+
+static bool block_has_label(const CFG *cfg, size_t block) {
+    const BasicBlock *bb = &cfg->blocks[block];
+    return bb->end > bb->start && cfg->func->instructions[bb->start]->opcode == IR_LABEL;
+}
+
+// Phi operands name their predecessors by label, so give every block
+// that feeds a merge point one
+static bool label_merge_predecessors(SSABuilder *b) {
+    CFG *cfg = b->cfg;
+    bool *needs = calloc(cfg->block_count, sizeof(bool));
+    size_t count = 0;
+    for (size_t i = 0; i < cfg->rpo_count; i++) {
+        BasicBlock *block = &cfg->blocks[cfg->rpo[i]];
+        if (block->pred_count < 2) continue;
+        for (size_t p = 0; p < block->pred_count; p++) {
+            size_t pred = block->preds[p];
+            if (!needs[pred] && !block_has_label(cfg, pred)) {
+                needs[pred] = true;
+                count++;
+            }
+        }
+    }
+    if (count == 0) {
+        free(needs);
+        return false;
+    }
+
+    IRFunction *func = b->func;
+    IRInstruction **out = rebuild_begin(func, count);
+    size_t n = 0;
+    for (size_t blk = 0; blk < cfg->block_count; blk++) {
+        BasicBlock *block = &cfg->blocks[blk];
+        if (needs[blk]) {
+            char *label = ir_function_new_label(func, "Lssa");
+            out[n++] = ir_instruction_create(IR_LABEL, NULL, ir_operand_label(label), NULL);
+            free(label);
+        }
+        for (size_t i = block->start; i < block->end; i++) out[n++] = func->instructions[i];
+    }
+    rebuild_finish(func, out, n);
+    free(needs);
+    return true;
+}
+
+// Record definition blocks and find candidates live across blocks
+// (semi-pruned SSA: the others never need a phi)
+static void collect_definitions(SSABuilder *b) {
+    CFG *cfg = b->cfg;
+    size_t *defined_in = malloc((b->cand_count + 1) * sizeof(size_t));
+    for (size_t c = 0; c < b->cand_count; c++) defined_in[c] = CFG_NONE;
+
+    for (size_t r = 0; r < cfg->rpo_count; r++) {
+        size_t blk = cfg->rpo[r];
+        BasicBlock *block = &cfg->blocks[blk];
+        for (size_t i = block->start; i < block->end; i++) {
+            IRInstruction *instr = b->func->instructions[i];
+            IROperand **slot;
+            for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+                size_t c = operand_candidate(b, *slot);
+                if (c != NO_CAND && defined_in[c] != blk) b->cands[c].is_global = true;
+            }
+            size_t c;
+            if (def_slot(b, instr, &c)) {
+                defined_in[c] = blk;
+                candidate_add_def_block(&b->cands[c], blk);
+            }
+        }
+    }
+    free(defined_in);
+}
+
+typedef struct {
+    size_t *items;
+    size_t count;
+    size_t capacity;
+} BlockList;
+
+static void block_list_push(BlockList *list, size_t value) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4;
+        list->items = realloc(list->items, list->capacity * sizeof(size_t));
+    }
+    list->items[list->count++] = value;
+}
+
+// Dominance frontiers (Cooper, Harvey & Kennedy)
+static BlockList *dominance_frontiers(const CFG *cfg) {
+    BlockList *df = calloc(cfg->block_count, sizeof(BlockList));
+    for (size_t blk = 0; blk < cfg->block_count; blk++) {
+        const BasicBlock *block = &cfg->blocks[blk];
+        if (block->pred_count < 2 || !cfg_reachable(cfg, blk)) continue;
+        for (size_t p = 0; p < block->pred_count; p++) {
+            size_t runner = block->preds[p];
+            if (!cfg_reachable(cfg, runner)) continue;
+            while (runner != block->idom) {
+                if (df[runner].count == 0 || df[runner].items[df[runner].count - 1] != blk) {
+                    block_list_push(&df[runner], blk);
+                }
+                if (runner == 0) break;
+                runner = cfg->blocks[runner].idom;
+            }
+        }
+    }
+    return df;
+}
+
+// Candidates needing a phi at the top of each block
+static BlockList *place_phis(SSABuilder *b) {
+    CFG *cfg = b->cfg;
+    BlockList *df = dominance_frontiers(cfg);
+    BlockList *phis = calloc(cfg->block_count, sizeof(BlockList));
+    size_t *has_phi = malloc(cfg->block_count * sizeof(size_t));
+    size_t *queued = malloc(cfg->block_count * sizeof(size_t));
+    size_t *worklist = malloc(cfg->block_count * sizeof(size_t));
+    for (size_t blk = 0; blk < cfg->block_count; blk++) has_phi[blk] = queued[blk] = NO_CAND;
+
+    for (size_t c = 0; c < b->cand_count; c++) {
+        Candidate *cand = &b->cands[c];
+        if (!cand->is_global) continue;
+        size_t top = 0;
+        for (size_t d = 0; d < cand->def_block_count; d++) {
+            size_t blk = cand->def_blocks[d];
+            if (queued[blk] == c) continue;
+            queued[blk] = c;
+            worklist[top++] = blk;
+        }
+        while (top > 0) {
+            size_t x = worklist[--top];
+            for (size_t k = 0; k < df[x].count; k++) {
+                size_t y = df[x].items[k];
+                if (has_phi[y] == c) continue;
+                has_phi[y] = c;
+                block_list_push(&phis[y], c);
+                if (queued[y] != c) {
+                    queued[y] = c;
+                    worklist[top++] = y;
+                }
+            }
+        }
+    }
+
+    for (size_t blk = 0; blk < cfg->block_count; blk++) free(df[blk].items);
+    free(df);
+    free(has_phi);
+    free(queued);
+    free(worklist);
+    return phis;
+}
+
+static const char *block_label(const CFG *cfg, size_t block) {
+    return cfg->func->instructions[cfg->blocks[block].start]->src1->data.label_name;
+}
+
+// Insert the phis after each block's label. Their candidate is kept in
+// a side table, parallel to the new instruction array, until renaming
+// gives them a destination.
+static size_t *insert_phis(SSABuilder *b, BlockList *phis) {
+    CFG *cfg = b->cfg;
+    IRFunction *func = b->func;
+    size_t extra = 0;
+    for (size_t blk = 0; blk < cfg->block_count; blk++) extra += phis[blk].count;
+
+    IRInstruction **out = rebuild_begin(func, extra);
+    size_t *phi_cand = malloc((func->instruction_count + extra + 1) * sizeof(size_t));
+    size_t n = 0;
+    for (size_t blk = 0; blk < cfg->block_count; blk++) {
+        BasicBlock *block = &cfg->blocks[blk];
+        size_t i = block->start;
+        if (phis[blk].count > 0) {
+            phi_cand[n] = NO_CAND;
+            out[n++] = func->instructions[i++];  // The label
+            for (size_t k = 0; k < phis[blk].count; k++) {
+                IRInstruction *phi = ir_instruction_create(IR_PHI, NULL, NULL, NULL);
+                phi->arg_count = block->pred_count * 2;
+                phi->args = malloc(phi->arg_count * sizeof(IROperand*));
+                for (size_t p = 0; p < block->pred_count; p++) {
+                    phi->args[p * 2] = ir_operand_label(block_label(cfg, block->preds[p]));
+                    phi->args[p * 2 + 1] = NULL;
+                }
+                phi_cand[n] = phis[blk].items[k];
+                out[n++] = phi;
+            }
+        }
+        for (; i < block->end; i++) {
+            phi_cand[n] = NO_CAND;
+            out[n++] = func->instructions[i];
+        }
+    }
+    rebuild_finish(func, out, n);
+    return phi_cand;
+}
+
+static void replace_operand(IROperand **slot, IROperand *value) {
+    ir_operand_free(*slot);
+    *slot = value;
+}
+
+static int new_version(SSABuilder *b, size_t c) {
+    int temp = ir_function_new_temp(b->func, b->cands[c].type);
+    candidate_push(&b->cands[c], temp);
+    return temp;
+}
+
+// Rename one block; returns how many versions it pushed, in push order
+// recorded through pushed[]
+static void rename_block(SSABuilder *b, size_t blk, size_t *phi_cand, size_t **pushed, size_t *pushed_count, size_t *pushed_capacity) {
+    CFG *cfg = b->cfg;
+    IRFunction *func = b->func;
+    BasicBlock *block = &cfg->blocks[blk];
+
+    #define RECORD_PUSH(cand) do { \
+        if (*pushed_count == *pushed_capacity) { \
+            *pushed_capacity = *pushed_capacity ? *pushed_capacity * 2 : 64; \
+            *pushed = realloc(*pushed, *pushed_capacity * sizeof(size_t)); \
+        } \
+        (*pushed)[(*pushed_count)++] = (cand); \
+    } while (0)
+
+    for (size_t i = block->start; i < block->end; i++) {
+        IRInstruction *instr = func->instructions[i];
+        if (instr->opcode == IR_PHI) {
+            size_t c = phi_cand[i];
+            instr->dest = ir_operand_temp(new_version(b, c));
+            RECORD_PUSH(c);
+            continue;
+        }
+
+        IROperand **slot;
+        for (size_t u = 0; (slot = ir_instruction_use(instr, u)); u++) {
+            size_t c = operand_candidate(b, *slot);
+            if (c != NO_CAND) replace_operand(slot, candidate_current(&b->cands[c]));
+        }
+
+        size_t c;
+        IROperand **def = def_slot(b, instr, &c);
+        if (!def) continue;
+        int temp = new_version(b, c);
+        RECORD_PUSH(c);
+        if (instr->opcode == IR_STORE) {
+            // x = v  becomes  tN = v
+            ir_operand_free(instr->src1);
+            instr->opcode = IR_MOVE;
+            instr->dest = ir_operand_temp(temp);
+            instr->src1 = instr->src2;
+            instr->src2 = NULL;
+        } else {
+            replace_operand(def, ir_operand_temp(temp));
+        }
+    }
+
+    for (size_t s = 0; s < block->succ_count; s++) {
+        BasicBlock *succ = &cfg->blocks[block->succs[s]];
+        size_t pred_index = 0;
+        while (pred_index < succ->pred_count && succ->preds[pred_index] != blk) pred_index++;
+        for (size_t i = succ->start; i < succ->end; i++) {
+            IRInstruction *phi = func->instructions[i];
+            if (phi->opcode == IR_LABEL) continue;
+            if (phi->opcode != IR_PHI) break;
+            Candidate *cand = &b->cands[phi_cand[i]];
+            replace_operand(&phi->args[pred_index * 2 + 1], candidate_current(cand));
+        }
+    }
+    #undef RECORD_PUSH
+}
+
+// Walk the dominator tree, keeping each candidate's current version on
+// its stack
+static void rename_all(SSABuilder *b, size_t *phi_cand) {
+    CFG *cfg = b->cfg;
+    size_t count = cfg->block_count;
+
+    size_t *child_start = calloc(count + 1, sizeof(size_t));
+    size_t *children = malloc((count + 1) * sizeof(size_t));
+    for (size_t i = 1; i < cfg->rpo_count; i++) child_start[cfg->blocks[cfg->rpo[i]].idom + 1]++;
+    for (size_t blk = 0; blk < count; blk++) child_start[blk + 1] += child_start[blk];
+    size_t *fill = malloc((count + 1) * sizeof(size_t));
+    memcpy(fill, child_start, count * sizeof(size_t));
+    for (size_t i = 1; i < cfg->rpo_count; i++) {
+        size_t blk = cfg->rpo[i];
+        children[fill[cfg->blocks[blk].idom]++] = blk;
+    }
+
+    size_t *pushed = NULL;
+    size_t pushed_count = 0, pushed_capacity = 0;
+    size_t *stack = malloc((count + 1) * sizeof(size_t));
+    size_t *next_child = calloc(count + 1, sizeof(size_t));
+    size_t *pushed_mark = malloc((count + 1) * sizeof(size_t));
+    size_t depth = 0;
+
+    stack[depth++] = 0;
+    pushed_mark[0] = pushed_count;
+    rename_block(b, 0, phi_cand, &pushed, &pushed_count, &pushed_capacity);
+    while (depth > 0) {
+        size_t blk = stack[depth - 1];
+        size_t c = child_start[blk] + next_child[blk];
+        if (c < child_start[blk + 1]) {
+            next_child[blk]++;
+            size_t child = children[c];
+            pushed_mark[child] = pushed_count;
+            rename_block(b, child, phi_cand, &pushed, &pushed_count, &pushed_capacity);
+            stack[depth++] = child;
+        } else {
+            while (pushed_count > pushed_mark[blk]) {
+                b->cands[pushed[--pushed_count]].stack_count--;
+            }
+            depth--;
+        }
+    }
+
+    free(pushed);
+    free(stack);
+    free(next_child);
+    free(pushed_mark);
+    free(child_start);
+    free(children);
+    free(fill);
+}
+
+void ssa_construct(IRFunction *func) {
+    if (!func || func->instruction_count == 0) return;
+
+    SSABuilder b = {0};
+    b.func = func;
+    b.temp_limit = temp_limit_of(func);
+    b.cfg = cfg_build(func);
+    if (b.cfg->blocks[0].pred_count > 0) {
+        // Jumps back to the first instruction: give the function an entry
+        // block of its own so the loop header can hold phis
+        IRInstruction **out = rebuild_begin(func, 1);
+        out[0] = ir_instruction_create(IR_NOP, NULL, NULL, NULL);
+        memcpy(out + 1, func->instructions, func->instruction_count * sizeof(IRInstruction*));
+        rebuild_finish(func, out, func->instruction_count + 1);
+        cfg_free(b.cfg);
+        b.cfg = cfg_build(func);
+    }
+    find_candidates(&b);
+
+    if (b.cand_count > 0) {
+        if (label_merge_predecessors(&b)) {
+            cfg_free(b.cfg);
+            b.cfg = cfg_build(func);
+        }
+        collect_definitions(&b);
+        BlockList *phis = place_phis(&b);
+        size_t *phi_cand = insert_phis(&b, phis);
+        for (size_t blk = 0; blk < b.cfg->block_count; blk++) free(phis[blk].items);
+        free(phis);
+
+        // Phis aren't leaders, so only instruction indices moved
+        cfg_free(b.cfg);
+        b.cfg = cfg_build(func);
+        rename_all(&b, phi_cand);
+        free(phi_cand);
+
+        // Parameters are read once, on entry
+        size_t entry_reads = 0;
+        for (size_t c = 0; c < b.cand_count; c++) {
+            if (b.cands[c].entry_used) entry_reads++;
+        }
+        if (entry_reads > 0) {
+            IRInstruction **out = rebuild_begin(func, entry_reads);
+            size_t n = 0;
+            for (size_t c = 0; c < b.cand_count; c++) {
+                if (!b.cands[c].entry_used) continue;
+                out[n++] = ir_instruction_create(IR_MOVE, ir_operand_temp(b.cands[c].entry_temp),
+                                                 ir_operand_var(b.cands[c].param), NULL);
+            }
+            memcpy(out + n, func->instructions, func->instruction_count * sizeof(IRInstruction*));
+            rebuild_finish(func, out, func->instruction_count + n);
+        }
+
+        // Phis in unreachable blocks were never given a destination
+        for (size_t i = 0; i < func->instruction_count; i++) {
+            IRInstruction *instr = func->instructions[i];
+            if (instr->opcode != IR_PHI || instr->dest) continue;
+            ir_instruction_free(instr);
+            func->instructions[i] = ir_instruction_create(IR_NOP, NULL, NULL, NULL);
+        }
+    }
+
+    for (size_t c = 0; c < b.cand_count; c++) {
+        free(b.cands[c].def_blocks);
+        free(b.cands[c].stack);
+    }
+    free(b.cands);
+    free(b.local_cand);
+    free(b.temp_cand);
+    name_map_free(&b.locals);
+    cfg_free(b.cfg);
+}
+
+// ---------------------------------------------------------------------
+// Destruction
+// ---------------------------------------------------------------------
+
+typedef struct {
+    IRInstruction **items;
+    size_t count;
+    size_t capacity;
+} InstrList;
+
+static void instr_list_push(InstrList *list, IRInstruction *instr) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4;
+        list->items = realloc(list->items, list->capacity * sizeof(IRInstruction*));
+    }
+    list->items[list->count++] = instr;
+}
+
+// A critical edge from a branch to its target gets its own block
+typedef struct {
+    size_t pred;
+    size_t succ;
+    char *label;
+    InstrList copies;
+} EdgeSplit;
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+// Drop NOPs and the labels construction added that no jump targets
+static void destruct_cleanup(IRFunction *func) {
+    size_t ref_count = 0;
+    size_t ref_capacity = func->instruction_count + 1;
+    const char **refs = malloc(ref_capacity * sizeof(char*));
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        IROperand **target;
+        for (size_t t = 0; (target = ir_instruction_target(instr, t)); t++) {
+            if (!*target || (*target)->kind != IR_OP_LABEL) continue;
+            if (ref_count == ref_capacity) {
+                ref_capacity *= 2;
+                refs = realloc(refs, ref_capacity * sizeof(char*));
+            }
+            refs[ref_count++] = (*target)->data.label_name;
+        }
+    }
+    qsort(refs, ref_count, sizeof(char*), compare_names);
+
+    size_t n = 0;
+    for (size_t i = 0; i < func->instruction_count; i++) {
+        IRInstruction *instr = func->instructions[i];
+        bool drop = instr->opcode == IR_NOP;
+        if (instr->opcode == IR_LABEL && instr->src1 && strncmp(instr->src1->data.label_name, "Lssa", 4) == 0) {
+            const char *name = instr->src1->data.label_name;
+            drop = !bsearch(&name, refs, ref_count, sizeof(char*), compare_names);
+        }
+        if (drop) ir_instruction_free(instr);
+        else func->instructions[n++] = instr;
+    }
+    func->instruction_count = n;
+    free(refs);
+}
+
+void ssa_destruct(IRFunction *func) {
+    if (!func || func->instruction_count == 0) return;
+
+    CFG *cfg = cfg_build(func);
+    size_t blocks = cfg->block_count;
+    InstrList *before_term = calloc(blocks, sizeof(InstrList));   // Copies for a lone successor
+    InstrList *after = calloc(blocks, sizeof(InstrList));         // Copies for the fall-through edge
+    EdgeSplit *splits = NULL;
+    size_t split_count = 0, split_capacity = 0;
+    bool any_phi = false;
+
+    for (size_t blk = 0; blk < blocks; blk++) {
+        BasicBlock *block = &cfg->blocks[blk];
+        for (size_t i = block->start; i < block->end; i++) {
+            IRInstruction *phi = func->instructions[i];
+            if (phi->opcode != IR_PHI) continue;
+            any_phi = true;
+
+            // Each phi gets a private copy temp, so copies on one edge
+            // never clobber a value another phi still reads
+            int dest = phi->dest->data.temp_id;
+            int copy = ir_function_new_temp(func, ssa_temp_type(func, dest));
+
+            for (size_t a = 0; a + 1 < phi->arg_count; a += 2) {
+                size_t pred = cfg_label_block(cfg, phi->args[a]->data.label_name);
+                if (pred == CFG_NONE || !cfg_reachable(cfg, pred)) continue;
+                BasicBlock *pb = &cfg->blocks[pred];
+                bool is_pred = false;
+                for (size_t s = 0; s < pb->succ_count; s++) is_pred |= (pb->succs[s] == blk);
+                if (!is_pred) continue;
+
+                IRInstruction *move = ir_instruction_create(IR_MOVE, ir_operand_temp(copy),
+                                                            ir_operand_clone(phi->args[a + 1]), NULL);
+                if (pb->succ_count == 1) {
+                    instr_list_push(&before_term[pred], move);
+                    continue;
+                }
+                // A switch has no fall-through, so each of its edges is split
+                IRInstruction *branch = func->instructions[pb->end - 1];
+                size_t target = cfg_label_block(cfg, branch->src2->data.label_name);
+                if (branch->opcode == IR_BRANCH && target != blk) {
+                    instr_list_push(&after[pred], move);
+                    continue;
+                }
+                EdgeSplit *split = NULL;
+                for (size_t s = 0; s < split_count; s++) {
+                    if (splits[s].pred == pred && splits[s].succ == blk) split = &splits[s];
+                }
+                if (!split) {
+                    if (split_count == split_capacity) {
+                        split_capacity = split_capacity ? split_capacity * 2 : 4;
+                        splits = realloc(splits, split_capacity * sizeof(EdgeSplit));
+                    }
+                    split = &splits[split_count++];
+                    memset(split, 0, sizeof(EdgeSplit));
+                    split->pred = pred;
+                    split->succ = blk;
+                    split->label = ir_function_new_label(func, "Lsplit");
+                }
+                instr_list_push(&split->copies, move);
+            }
+
+            // t = phi(...)  becomes  t = copy
+            for (size_t a = 0; a < phi->arg_count; a++) ir_operand_free(phi->args[a]);
+            free(phi->args);
+            phi->args = NULL;
+            phi->arg_count = 0;
+            phi->opcode = IR_MOVE;
+            phi->src1 = ir_operand_temp(copy);
+        }
+    }
+
+    if (any_phi) {
+        size_t extra = 2;
+        for (size_t blk = 0; blk < blocks; blk++) extra += before_term[blk].count + after[blk].count;
+        for (size_t s = 0; s < split_count; s++) extra += splits[s].copies.count + 2;
+
+        IRInstruction **out = rebuild_begin(func, extra);
+        size_t n = 0;
+        for (size_t blk = 0; blk < blocks; blk++) {
+            BasicBlock *block = &cfg->blocks[blk];
+            size_t end = block->end;
+            bool has_term = end > block->start && is_terminator(func->instructions[end - 1]->opcode);
+            for (size_t i = block->start; i < (has_term ? end - 1 : end); i++) out[n++] = func->instructions[i];
+            for (size_t k = 0; k < before_term[blk].count; k++) out[n++] = before_term[blk].items[k];
+            if (has_term) out[n++] = func->instructions[end - 1];
+            for (size_t k = 0; k < after[blk].count; k++) out[n++] = after[blk].items[k];
+        }
+
+        if (split_count > 0) {
+            // Split blocks go after the body; don't fall into them
+            char *resume = NULL;
+            if (n > 0 && out[n - 1]->opcode != IR_JUMP && out[n - 1]->opcode != IR_RETURN &&
+                out[n - 1]->opcode != IR_FAIL) {
+                resume = ir_function_new_label(func, "Lssa");
+                out[n++] = ir_instruction_create(IR_JUMP, NULL, ir_operand_label(resume), NULL);
+            }
+            for (size_t s = 0; s < split_count; s++) {
+                EdgeSplit *split = &splits[s];
+                IRInstruction *branch = func->instructions[cfg->blocks[split->pred].end - 1];
+                const char *succ_label = block_label(cfg, split->succ);
+                out[n++] = ir_instruction_create(IR_LABEL, NULL, ir_operand_label(split->label), NULL);
+                for (size_t k = 0; k < split->copies.count; k++) out[n++] = split->copies.items[k];
+                out[n++] = ir_instruction_create(IR_JUMP, NULL, ir_operand_label(succ_label), NULL);
+                IROperand **slot;
+                for (size_t t = 0; (slot = ir_instruction_target(branch, t)); t++) {
+                    if (cfg_label_block(cfg, (*slot)->data.label_name) == split->succ) {
+                        replace_operand(slot, ir_operand_label(split->label));
+                    }
+                }
+            }
+            if (resume) {
+                out[n++] = ir_instruction_create(IR_LABEL, NULL, ir_operand_label(resume), NULL);
+                free(resume);
+            }
+        }
+        rebuild_finish(func, out, n);
+    }
+
+    for (size_t blk = 0; blk < blocks; blk++) {
+        free(before_term[blk].items);
+        free(after[blk].items);
+    }
+    for (size_t s = 0; s < split_count; s++) {
+        free(splits[s].label);
+        free(splits[s].copies.items);
+    }
+    free(before_term);
+    free(after);
+    free(splits);
+    cfg_free(cfg);
+
+    destruct_cleanup(func);
+}
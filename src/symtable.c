@@ -2,12 +2,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include "../include/symtable.h"
+#include "../include/intern.h"
 
 // Symbol functions
 Symbol *symbol_create(const char *name, SymbolKind kind, Type *type, size_t line, size_t column) {
     Symbol *symbol = malloc(sizeof(Symbol));
-    symbol->name = strdup(name);
+    symbol->name = intern(name);
     symbol->kind = kind;
     symbol->type = type;
     symbol->is_const = false;
@@ -32,7 +34,6 @@ Symbol *symbol_create(const char *name, SymbolKind kind, Type *type, size_t line
 
 void symbol_free(Symbol *symbol) {
     if (!symbol) return;
-    free(symbol->name);
     if (symbol->type_params) {
         for (size_t i = 0; i < symbol->type_param_count; i++) {
             free(symbol->type_params[i]);
@@ -51,6 +52,9 @@ void symbol_free(Symbol *symbol) {
     free(symbol);
 }
 
+// Scopes up to this size are searched linearly; most block scopes stay below it
+#define SCOPE_INDEX_THRESHOLD 16
+
 // Scope functions
 static Scope *scope_create(Scope *parent) {
     Scope *scope = malloc(sizeof(Scope));
@@ -58,9 +62,33 @@ static Scope *scope_create(Scope *parent) {
     scope->symbols = NULL;
     scope->symbol_count = 0;
     scope->symbol_capacity = 0;
+    scope->index = NULL;
+    scope->index_capacity = 0;
     return scope;
 }
 
+static size_t scope_hash(const char *key) {
+    // Interned names are unique pointers, so hash the address (Fibonacci hashing)
+    uint64_t h = (uint64_t)(uintptr_t)key * 0x9E3779B97F4A7C15ull;
+    return (size_t)(h >> 32);
+}
+
+static void scope_index_put(Symbol **index, size_t capacity, Symbol *symbol) {
+    size_t mask = capacity - 1;
+    size_t i = scope_hash(symbol->name) & mask;
+    while (index[i]) i = (i + 1) & mask;
+    index[i] = symbol;
+}
+
+static void scope_reindex(Scope *scope, size_t capacity) {
+    free(scope->index);
+    scope->index = calloc(capacity, sizeof(Symbol*));
+    scope->index_capacity = capacity;
+    for (size_t i = 0; i < scope->symbol_count; i++) {
+        scope_index_put(scope->index, capacity, scope->symbols[i]);
+    }
+}
+
 static void scope_free(Scope *scope) {
     if (!scope) return;
     
@@ -68,18 +96,37 @@ static void scope_free(Scope *scope) {
         symbol_free(scope->symbols[i]);
     }
     free(scope->symbols);
+    free(scope->index);
     free(scope);
 }
 
-static bool scope_insert(Scope *scope, Symbol *symbol) {
-    if (!scope || !symbol) return false;
+// key must be an interned name
+static Symbol *scope_lookup(Scope *scope, const char *key) {
+    if (scope->index) {
+        size_t mask = scope->index_capacity - 1;
+        size_t i = scope_hash(key) & mask;
+        while (scope->index[i]) {
+            if (scope->index[i]->name == key) return scope->index[i];
+            i = (i + 1) & mask;
+        }
+        return NULL;
+    }
     
-    // Check for duplicate
     for (size_t i = 0; i < scope->symbol_count; i++) {
-        if (strcmp(scope->symbols[i]->name, symbol->name) == 0) {
-            return false;
+        if (scope->symbols[i]->name == key) {
+            return scope->symbols[i];
         }
     }
+    return NULL;
+}
+
+static bool scope_insert(Scope *scope, Symbol *symbol) {
+    if (!scope || !symbol) return false;
+    
+    // Check for duplicate (names are interned)
+    if (scope_lookup(scope, symbol->name)) {
+        return false;
+    }
     
     if (scope->symbol_count >= scope->symbol_capacity) {
         scope->symbol_capacity = scope->symbol_capacity == 0 ? 8 : scope->symbol_capacity * 2;
@@ -87,16 +134,15 @@ static bool scope_insert(Scope *scope, Symbol *symbol) {
     }
     
     scope->symbols[scope->symbol_count++] = symbol;
-    return true;
-}
-
-static Symbol *scope_lookup(Scope *scope, const char *name) {
-    for (size_t i = 0; i < scope->symbol_count; i++) {
-        if (strcmp(scope->symbols[i]->name, name) == 0) {
-            return scope->symbols[i];
-        }
+    
+    // Keep the index at most half full
+    if (scope->index && scope->symbol_count * 2 <= scope->index_capacity) {
+        scope_index_put(scope->index, scope->index_capacity, symbol);
+    } else if (scope->symbol_count > SCOPE_INDEX_THRESHOLD) {
+        size_t capacity = scope->index_capacity ? scope->index_capacity * 2 : SCOPE_INDEX_THRESHOLD * 4;
+        scope_reindex(scope, capacity);
     }
-    return NULL;
+    return true;
 }
 
 // Symbol table functions
@@ -105,6 +151,7 @@ SymbolTable *symtable_create(void) {
     table->name = NULL;
     table->global_scope = scope_create(NULL);
     table->current_scope = table->global_scope;
+    pthread_rwlock_init(&table->global_lock, NULL);
     return table;
 }
 
@@ -121,6 +168,7 @@ void symtable_free(SymbolTable *table) {
         scope = parent;
     }
     
+    pthread_rwlock_destroy(&table->global_lock);
     free(table);
 }
 
@@ -141,14 +189,24 @@ void symtable_exit_scope(SymbolTable *table) {
 }
 
 bool symtable_insert(SymbolTable *table, Symbol *symbol) {
-    return scope_insert(table->current_scope, symbol);
+    if (table->current_scope != table->global_scope) {
+        return scope_insert(table->current_scope, symbol);
+    }
+    pthread_rwlock_wrlock(&table->global_lock);
+    bool inserted = scope_insert(table->global_scope, symbol);
+    pthread_rwlock_unlock(&table->global_lock);
+    return inserted;
 }
 
 Symbol *symtable_lookup(SymbolTable *table, const char *name) {
+    // A name that was never interned cannot belong to any symbol
+    const char *key = intern_find(name);
+    if (!key) return NULL;
+
     // Search from current scope up to global
     Scope *scope = table->current_scope;
     while (scope) {
-        Symbol *symbol = scope_lookup(scope, name);
+        Symbol *symbol = scope_lookup(scope, key);
         if (symbol) {
             return symbol;
         }
@@ -158,5 +216,16 @@ Symbol *symtable_lookup(SymbolTable *table, const char *name) {
 }
 
 Symbol *symtable_lookup_current(SymbolTable *table, const char *name) {
-    return scope_lookup(table->current_scope, name);
+    const char *key = intern_find(name);
+    if (!key) return NULL;
+    return scope_lookup(table->current_scope, key);
+}
+
+Symbol *symtable_lookup_global(SymbolTable *table, const char *name) {
+    const char *key = intern_find(name);
+    if (!key) return NULL;
+    pthread_rwlock_rdlock(&table->global_lock);
+    Symbol *symbol = scope_lookup(table->global_scope, key);
+    pthread_rwlock_unlock(&table->global_lock);
+    return symbol;
 }
@@ -0,0 +1,213 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/threadpool.h"
+
+typedef struct {
+    ThreadPoolTask task;
+    void *arg;
+} PoolItem;
+
+// Growable ring buffer; the owner works at the bottom, thieves at the top
+typedef struct {
+    pthread_mutex_t lock;
+    PoolItem *items;
+    size_t top;
+    size_t count;
+    size_t capacity;
+} WorkDeque;
+
+typedef struct {
+    ThreadPool *pool;
+    size_t index;
+    pthread_t thread;
+} PoolWorker;
+
+struct ThreadPool {
+    PoolWorker *workers;
+    WorkDeque *deques;
+    size_t worker_count;
+
+    pthread_mutex_t lock;       // Guards the counters below
+    pthread_cond_t work_ready;  // Signalled when a task is queued or on shutdown
+    pthread_cond_t all_done;    // Signalled when pending drops to zero
+    size_t queued;              // Tasks in deques not yet claimed by a worker
+    size_t pending;             // Tasks submitted but not yet finished
+    size_t next_deque;          // Round-robin target for external submits
+    bool shutdown;
+};
+
+// Set on worker threads so submits from inside a task stay local
+static _Thread_local PoolWorker *current_worker = NULL;
+
+static void deque_push_bottom(WorkDeque *deque, PoolItem item) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count == deque->capacity) {
+        size_t capacity = deque->capacity ? deque->capacity * 2 : 16;
+        PoolItem *items = malloc(sizeof(PoolItem) * capacity);
+        for (size_t i = 0; i < deque->count; i++) {
+            items[i] = deque->items[(deque->top + i) % deque->capacity];
+        }
+        free(deque->items);
+        deque->items = items;
+        deque->top = 0;
+        deque->capacity = capacity;
+    }
+    deque->items[(deque->top + deque->count) % deque->capacity] = item;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+static bool deque_pop_bottom(WorkDeque *deque, PoolItem *out) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->count > 0;
+    if (found) {
+        deque->count--;
+        *out = deque->items[(deque->top + deque->count) % deque->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool deque_steal_top(WorkDeque *deque, PoolItem *out) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->count > 0;
+    if (found) {
+        *out = deque->items[deque->top];
+        deque->top = (deque->top + 1) % deque->capacity;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static void *worker_main(void *arg) {
+    PoolWorker *self = arg;
+    ThreadPool *pool = self->pool;
+    current_worker = self;
+
+    while (true) {
+        // Claim one queued task, or leave on shutdown
+        pthread_mutex_lock(&pool->lock);
+        while (pool->queued == 0 && !pool->shutdown) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->queued == 0) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        pool->queued--;
+        pthread_mutex_unlock(&pool->lock);
+
+        // The claimed task is in some deque: our own first, then steal
+        PoolItem item;
+        bool found = false;
+        while (!found) {
+            found = deque_pop_bottom(&pool->deques[self->index], &item);
+            for (size_t i = 1; !found && i < pool->worker_count; i++) {
+                found = deque_steal_top(&pool->deques[(self->index + i) % pool->worker_count], &item);
+            }
+        }
+
+        item.task(item.arg);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) pthread_cond_broadcast(&pool->all_done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+ThreadPool *threadpool_create(size_t thread_count) {
+    if (thread_count == 0) thread_count = 1;
+
+    ThreadPool *pool = malloc(sizeof(ThreadPool));
+    pool->worker_count = thread_count;
+    pool->workers = malloc(sizeof(PoolWorker) * thread_count);
+    pool->deques = malloc(sizeof(WorkDeque) * thread_count);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+    pool->queued = 0;
+    pool->pending = 0;
+    pool->next_deque = 0;
+    pool->shutdown = false;
+
+    for (size_t i = 0; i < thread_count; i++) {
+        WorkDeque *deque = &pool->deques[i];
+        pthread_mutex_init(&deque->lock, NULL);
+        deque->items = NULL;
+        deque->top = 0;
+        deque->count = 0;
+        deque->capacity = 0;
+    }
+
+    for (size_t i = 0; i < thread_count; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        if (pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]) != 0) {
+            fprintf(stderr, "Error: Failed to start worker thread\n");
+            exit(1);
+        }
+    }
+    return pool;
+}
+
+void threadpool_submit(ThreadPool *pool, ThreadPoolTask task, void *arg) {
+    size_t index;
+    if (current_worker && current_worker->pool == pool) {
+        index = current_worker->index;
+    } else {
+        pthread_mutex_lock(&pool->lock);
+        index = pool->next_deque++ % pool->worker_count;
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    PoolItem item = { task, arg };
+    deque_push_bottom(&pool->deques[index], item);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->queued++;
+    pool->pending++;
+    pthread_cond_signal(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void threadpool_wait(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void threadpool_free(ThreadPool *pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].items);
+    }
+    pthread_cond_destroy(&pool->all_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+}
+
+size_t threadpool_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+}
@@ -3,25 +3,64 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../include/token.h"
+#include "../include/arena.h"
+#include "../include/intern.h"
 
-Token *token_create(TokenType type, const char *lexeme, size_t line, size_t column) {
-    Token *token = malloc(sizeof(Token));
+static Token *token_alloc(void) {
+    Token *token = arena_node_alloc(sizeof(Token));
     if (!token) {
         fprintf(stderr, "Error: Failed to allocate memory for token\n");
         exit(1);
     }
-    
+    return token;
+}
+
+void token_init(Token *token, TokenType type, const char *lexeme, size_t line, size_t column) {
     token->type = type;
-    token->lexeme = strdup(lexeme);
+    token->source = NULL;
+    token->offset = 0;
+    token->length = strlen(lexeme);
+    token->lexeme = arena_node_strdup(lexeme);
     token->line = line;
     token->column = column;
-    
+    token->value.int_value = 0;
+}
+
+void token_init_view(Token *token, TokenType type, const char *source, size_t offset, size_t length, size_t line, size_t column) {
+    token->type = type;
+    token->source = source;
+    token->offset = offset;
+    token->length = length;
+    token->lexeme = NULL;
+    token->line = line;
+    token->column = column;
+    token->value.int_value = 0;
+}
+
+Token *token_create(TokenType type, const char *lexeme, size_t line, size_t column) {
+    Token *token = token_alloc();
+    token_init(token, type, lexeme, line, column);
+    return token;
+}
+
+Token *token_create_view(TokenType type, const char *source, size_t offset, size_t length, size_t line, size_t column) {
+    Token *token = token_alloc();
+    token_init_view(token, type, source, offset, length, line, column);
     return token;
 }
 
+const char *token_lexeme(Token *token) {
+    if (!token->lexeme) {
+        // Views are materialized through the interner, so repeated
+        // identifiers share one copy and the source can be released
+        token->lexeme = intern_n(token->source + token->offset, token->length);
+    }
+    return token->lexeme;
+}
+
 void token_free(Token *token) {
-    if (token) {
-        free(token->lexeme);
+    if (token && !arena_current()) {
+        if (!token->source) free((char *)token->lexeme);
         free(token);
     }
 }
@@ -118,9 +157,10 @@ const char *token_type_name(TokenType type) {
 }
 
 void token_print(const Token *token) {
-    printf("%-15s %-20s (%zu:%zu)", 
+    printf("%-15s %-20.*s (%zu:%zu)", 
            token_type_name(token->type),
-           token->lexeme,
+           (int)token->length,
+           token->lexeme ? token->lexeme : token->source + token->offset,
            token->line,
            token->column);
     
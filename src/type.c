@@ -3,16 +3,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../include/type.h"
+#include "../include/arena.h"
 
 Type *type_create_primitive(TokenType primitive) {
-    Type *type = malloc(sizeof(Type));
+    Type *type = arena_node_alloc(sizeof(Type));
     type->kind = TYPE_PRIMITIVE;
     type->data.primitive = primitive;
     return type;
 }
 
 Type *type_create_pointer(Type *base, bool non_null) {
-    Type *type = malloc(sizeof(Type));
+    Type *type = arena_node_alloc(sizeof(Type));
     type->kind = TYPE_POINTER;
     type->data.pointer.base = base;
     type->data.pointer.non_null = non_null;
@@ -20,7 +21,7 @@ Type *type_create_pointer(Type *base, bool non_null) {
 }
 
 Type *type_create_array(Type *element, size_t size) {
-    Type *type = malloc(sizeof(Type));
+    Type *type = arena_node_alloc(sizeof(Type));
     type->kind = TYPE_ARRAY;
     type->data.array.element = element;
     type->data.array.size = size;
@@ -28,14 +29,14 @@ Type *type_create_array(Type *element, size_t size) {
 }
 
 Type *type_create_slice(Type *element) {
-    Type *type = malloc(sizeof(Type));
+    Type *type = arena_node_alloc(sizeof(Type));
     type->kind = TYPE_SLICE;
     type->data.slice.element = element;
     return type;
 }
 
 Type *type_create_function(Type *return_type, Type **param_types, size_t param_count) {
-    Type *type = malloc(sizeof(Type));
+    Type *type = arena_node_alloc(sizeof(Type));
     type->kind = TYPE_FUNCTION;
     type->data.function.return_type = return_type;
     type->data.function.param_types = param_types;
@@ -44,25 +45,25 @@ Type *type_create_function(Type *return_type, Type **param_types, size_t param_c
 }
 
 Type *type_create_struct(const char *name, Type **type_args, size_t type_arg_count) {
-    Type *type = malloc(sizeof(Type));
+    Type *type = arena_node_alloc(sizeof(Type));
     type->kind = TYPE_STRUCT;
-    type->data.struct_enum.name = strdup(name);
+    type->data.struct_enum.name = arena_node_strdup(name);
     type->data.struct_enum.type_args = type_args;
     type->data.struct_enum.type_arg_count = type_arg_count;
     return type;
 }
 
 Type *type_create_enum(const char *name, Type **type_args, size_t type_arg_count) {
-    Type *type = malloc(sizeof(Type));
+    Type *type = arena_node_alloc(sizeof(Type));
     type->kind = TYPE_ENUM;
-    type->data.struct_enum.name = strdup(name);
+    type->data.struct_enum.name = arena_node_strdup(name);
     type->data.struct_enum.type_args = type_args;
     type->data.struct_enum.type_arg_count = type_arg_count;
     return type;
 }
 
 Type *type_create_result(Type *ok_type, Type *err_type) {
-    Type *type = malloc(sizeof(Type));
+    Type *type = arena_node_alloc(sizeof(Type));
     type->kind = TYPE_RESULT;
     type->data.result.ok_type = ok_type;
     type->data.result.err_type = err_type;
@@ -72,7 +73,7 @@ Type *type_create_result(Type *ok_type, Type *err_type) {
 Type *type_clone(const Type *type) {
     if (!type) return NULL;
     
-    Type *new_type = malloc(sizeof(Type));
+    Type *new_type = arena_node_alloc(sizeof(Type));
     new_type->kind = type->kind;
     
     switch (type->kind) {
@@ -93,17 +94,17 @@ Type *type_clone(const Type *type) {
         case TYPE_FUNCTION:
             new_type->data.function.return_type = type_clone(type->data.function.return_type);
             new_type->data.function.param_count = type->data.function.param_count;
-            new_type->data.function.param_types = malloc(sizeof(Type*) * type->data.function.param_count);
+            new_type->data.function.param_types = arena_node_alloc(sizeof(Type*) * type->data.function.param_count);
             for (size_t i = 0; i < type->data.function.param_count; i++) {
                 new_type->data.function.param_types[i] = type_clone(type->data.function.param_types[i]);
             }
             break;
         case TYPE_STRUCT:
         case TYPE_ENUM:
-            new_type->data.struct_enum.name = strdup(type->data.struct_enum.name);
+            new_type->data.struct_enum.name = arena_node_strdup(type->data.struct_enum.name);
             new_type->data.struct_enum.type_arg_count = type->data.struct_enum.type_arg_count;
             if (new_type->data.struct_enum.type_arg_count > 0) {
-                new_type->data.struct_enum.type_args = malloc(sizeof(Type*) * new_type->data.struct_enum.type_arg_count);
+                new_type->data.struct_enum.type_args = arena_node_alloc(sizeof(Type*) * new_type->data.struct_enum.type_arg_count);
                 for (size_t i = 0; i < new_type->data.struct_enum.type_arg_count; i++) {
                     new_type->data.struct_enum.type_args[i] = type_clone(type->data.struct_enum.type_args[i]);
                 }
@@ -121,7 +122,7 @@ Type *type_clone(const Type *type) {
 }
 
 void type_free(Type *type) {
-    if (!type) return;
+    if (!type || arena_current()) return; // Owned by the module arena
     
     switch (type->kind) {
         case TYPE_POINTER:
@@ -253,7 +254,7 @@ Type *type_substitute(const Type *type, char **params, Type **args, size_t count
     }
     
     // Otherwise, deep clone and recurse
-    Type *new_type = malloc(sizeof(Type));
+    Type *new_type = arena_node_alloc(sizeof(Type));
     new_type->kind = type->kind;
     
     switch (type->kind) {
@@ -278,7 +279,7 @@ Type *type_substitute(const Type *type, char **params, Type **args, size_t count
         case TYPE_FUNCTION:
             new_type->data.function.return_type = type_substitute(type->data.function.return_type, params, args, count);
             new_type->data.function.param_count = type->data.function.param_count;
-            new_type->data.function.param_types = malloc(sizeof(Type*) * type->data.function.param_count);
+            new_type->data.function.param_types = arena_node_alloc(sizeof(Type*) * type->data.function.param_count);
             for (size_t i = 0; i < type->data.function.param_count; i++) {
                 new_type->data.function.param_types[i] = type_substitute(type->data.function.param_types[i], params, args, count);
             }
@@ -286,10 +287,10 @@ Type *type_substitute(const Type *type, char **params, Type **args, size_t count
             
         case TYPE_STRUCT:
         case TYPE_ENUM:
-            new_type->data.struct_enum.name = strdup(type->data.struct_enum.name);
+            new_type->data.struct_enum.name = arena_node_strdup(type->data.struct_enum.name);
             new_type->data.struct_enum.type_arg_count = type->data.struct_enum.type_arg_count;
             if (new_type->data.struct_enum.type_arg_count > 0) {
-                new_type->data.struct_enum.type_args = malloc(sizeof(Type*) * new_type->data.struct_enum.type_arg_count);
+                new_type->data.struct_enum.type_args = arena_node_alloc(sizeof(Type*) * new_type->data.struct_enum.type_arg_count);
                 for (size_t i = 0; i < new_type->data.struct_enum.type_arg_count; i++) {
                     new_type->data.struct_enum.type_args[i] = type_substitute(type->data.struct_enum.type_args[i], params, args, count);
                 }
@@ -5,9 +5,15 @@
 #include <string.h>
 #include <libgen.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <spawn.h>
 #include <limits.h>
+#include <ctype.h>
 #include "../include/util.h"
+#include "../include/intern.h"
 
 char *resolve_module_path(const char *current_file, const char *import_path) {
     if (!current_file || !import_path) return NULL;
@@ -47,9 +53,56 @@ char *resolve_module_path(const char *current_file, const char *import_path) {
     return NULL;
 }
 
-char *util_mangle_name(const char *prefix, const char *name) {
+bool source_buffer_open(SourceBuffer *buffer, const char *path) {
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->mapped_size = 0;
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    
+    // Reserve the file size plus at least one zeroed byte, then map the file
+    // over the front. Bytes past EOF in the last file page read as zero and
+    // any whole page after it comes from the anonymous reservation.
+    size_t size = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t span = (size + page) & ~(page - 1);
+    
+    void *base = mmap(NULL, span, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    if (size > 0 && mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, span);
+        close(fd);
+        return false;
+    }
+    close(fd);
+    
+    buffer->data = base;
+    buffer->size = size;
+    buffer->mapped_size = span;
+    return true;
+}
+
+void source_buffer_close(SourceBuffer *buffer) {
+    if (!buffer->data) return;
+    munmap((void *)buffer->data, buffer->mapped_size);
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->mapped_size = 0;
+}
+
+const char *util_mangle_name(const char *prefix, const char *name) {
     if (!name) return NULL;
-    if (!prefix) return strdup(name);
+    if (!prefix) return intern(name);
     
     size_t prefix_len = strlen(prefix);
     char *mangled = malloc(prefix_len + strlen(name) + 3); // +2 for "__", +1 for null
@@ -60,12 +113,14 @@ char *util_mangle_name(const char *prefix, const char *name) {
         if (*p == '.' || *p == ':') *p = '_';
     }
     
-    return mangled;
+    const char *result = intern(mangled);
+    free(mangled);
+    return result;
 }
 
-char *util_mangle_instantiation(const char *base_name, Type **type_args, size_t type_arg_count) {
+const char *util_mangle_instantiation(const char *base_name, Type **type_args, size_t type_arg_count) {
     if (type_arg_count == 0 || !type_args) {
-        return strdup(base_name);
+        return intern(base_name);
     }
     
     // Calculate required buffer size
@@ -86,5 +141,146 @@ char *util_mangle_instantiation(const char *base_name, Type **type_args, size_t
         free(type_str);
     }
     
-    return mangled;
+    const char *result = intern(mangled);
+    free(mangled);
+    return result;
+}
+
+// Appends a C type as identifier characters: spaces and brackets become
+// '_', pointers 'p'
+static size_t append_c_type_name(char *out, const char *c_type) {
+    size_t n = 0;
+    for (const char *p = c_type; *p; p++) {
+        if (isalnum((unsigned char)*p) || *p == '_') out[n++] = *p;
+        else if (*p == '*') out[n++] = 'p';
+        else out[n++] = '_';
+    }
+    return n;
+}
+
+char *util_result_c_type(const char *ok_c_type, const char *err_c_type) {
+    char *name = malloc(strlen("struct Result_") + strlen(ok_c_type) + 2 + strlen(err_c_type) + 1);
+    size_t n = strlen(strcpy(name, "struct Result_"));
+    n += append_c_type_name(name + n, ok_c_type);
+    name[n++] = '_';
+    name[n++] = '_';
+    n += append_c_type_name(name + n, err_c_type);
+    name[n] = '\0';
+    return name;
+}
+
+char *util_type_to_c_string(const Type *type) {
+    if (!type) return strdup("void");
+    
+    switch (type->kind) {
+        case TYPE_PRIMITIVE:
+            switch (type->data.primitive) {
+                case TOKEN_I8: return strdup("int8_t");
+                case TOKEN_U8: return strdup("uint8_t");
+                case TOKEN_I16: return strdup("int16_t");
+                case TOKEN_U16: return strdup("uint16_t");
+                case TOKEN_I32: return strdup("int32_t");
+                case TOKEN_U32: return strdup("uint32_t");
+                case TOKEN_I64: return strdup("long long");
+                case TOKEN_U64: return strdup("uint64_t");
+                case TOKEN_F32: return strdup("float");
+                case TOKEN_F64: return strdup("double");
+                case TOKEN_BOOL: return strdup("int");
+                case TOKEN_VOID: return strdup("void");
+                default: return strdup("long");
+            }
+        case TYPE_POINTER: {
+            char *base = util_type_to_c_string(type->data.pointer.base);
+            char *result = malloc(strlen(base) + 2);
+            sprintf(result, "%s*", base);
+            free(base);
+            return result;
+        }
+        case TYPE_ARRAY: {
+            char *elem = util_type_to_c_string(type->data.array.element);
+            char buf[256];
+            snprintf(buf, 256, "%s[%zu]", elem, type->data.array.size);
+            free(elem);
+            return strdup(buf);
+        }
+        case TYPE_SLICE: {
+            // Generate slice struct name: Slice_ElementType
+            char *elem_str = util_type_to_c_string(type->data.slice.element);
+            // Remove spaces and special chars from element type for struct name
+            char *clean_elem = malloc(strlen(elem_str) + 1);
+            size_t j = 0;
+            for (size_t i = 0; elem_str[i]; i++) {
+                if (elem_str[i] != ' ' && elem_str[i] != '*') {
+                    clean_elem[j++] = elem_str[i];
+                }
+            }
+            clean_elem[j] = '\0';
+            
+            char buf[256];
+            snprintf(buf, 256, "struct Slice_%s", clean_elem);
+            free(elem_str);
+            free(clean_elem);
+            return strdup(buf);
+        }
+        case TYPE_STRUCT: {
+            // If it's a single uppercase letter, it's likely a type parameter
+            // and we don't have monomorphization yet, so treat as uint8_t
+            if (type->data.struct_enum.name && 
+                strlen(type->data.struct_enum.name) == 1 && 
+                type->data.struct_enum.name[0] >= 'A' && type->data.struct_enum.name[0] <= 'Z') {
+                return strdup("uint8_t");
+            }
+            char buf[256];
+            snprintf(buf, 256, "struct %s", type->data.struct_enum.name ? type->data.struct_enum.name : "unknown");
+            return strdup(buf);
+        }
+        case TYPE_ENUM: {
+            char buf[256];
+            snprintf(buf, 256, "enum %s", type->data.struct_enum.name ? type->data.struct_enum.name : "unknown");
+            return strdup(buf);
+        }
+        case TYPE_RESULT: {
+            char *ok = util_type_to_c_string(type->data.result.ok_type);
+            char *err = util_type_to_c_string(type->data.result.err_type);
+            char *result = util_result_c_type(ok, err);
+            free(ok);
+            free(err);
+            return result;
+        }
+        case TYPE_FUNCTION:
+            return strdup("void*");
+        default:
+            return strdup("long");
+    }
+}
+
+extern char **environ;
+
+bool run_commands(char **commands, size_t count, size_t jobs) {
+    if (jobs == 0) jobs = 1;
+    bool ok = true;
+    size_t next = 0;
+    size_t running = 0;
+
+    while (next < count || running > 0) {
+        // Keep up to jobs commands in flight; stop starting new ones after a failure
+        while (ok && next < count && running < jobs) {
+            char *argv[] = { "sh", "-c", commands[next], NULL };
+            pid_t pid;
+            if (posix_spawn(&pid, "/bin/sh", NULL, NULL, argv, environ) != 0) {
+                fprintf(stderr, "Error: Could not run '%s'\n", commands[next]);
+                ok = false;
+                break;
+            }
+            next++;
+            running++;
+        }
+        if (running == 0) break;
+
+        int status;
+        if (waitpid(-1, &status, 0) < 0) break;
+        running--;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    }
+    return ok;
 }
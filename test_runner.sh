@@ -63,6 +63,8 @@ EXPECTED_RUNTIME_FAILURES=(
     "unwrap_test.vx"
     "bounds_fail.vx"
     "slice_fail.vx"
+    "bounds_loop_fail.vx"
+    "bounds_narrow_fail.vx"
 )
 
 # Find all .vx files in tests/ (excluding helper files)
@@ -113,7 +115,7 @@ for test in $TEST_FILES; do
         PASSED=$((PASSED + 1))
     else
         # Check if it was supposed to fail at runtime
-        if [[ "$test_name" == "fail.vx" ]] || [[ "$test_name" == "unwrap_test.vx" ]] || [[ "$test_name" == "bounds_fail.vx" ]] || [[ "$test_name" == "slice_fail.vx" ]]; then
+        if [[ "$test_name" == "fail.vx" ]] || [[ "$test_name" == "unwrap_test.vx" ]] || [[ "$test_name" == "bounds_fail.vx" ]] || [[ "$test_name" == "slice_fail.vx" ]] || [[ "$test_name" == "bounds_loop_fail.vx" ]] || [[ "$test_name" == "bounds_narrow_fail.vx" ]]; then
              echo -e "${GREEN}PASSED${NC} (Expected runtime failure)"
              PASSED=$((PASSED + 1))
         else
@@ -0,0 +1,38 @@
+#!/bin/bash
+# tests/cli/test_iv.sh
+# iv must leave no multiply by a counter in the loops of iv_reduce.vx,
+# move the exit test of triples onto the scaled counter, and merge the
+# two counters of lockstep.
+
+mkdir -p tests/tmp
+
+echo "Testing induction variables..."
+ir=$(./virexc build tests/control_flow/iv_reduce.vx -o tests/tmp/app --no-cache --inline-threshold=0 --print-after=iv)
+
+# Instructions of one function from its loop header on
+in_loop() {
+    echo "$ir" | awk -v fn="Function: iv_reduce__$1" '
+        $0 == fn { inside = 1; next }
+        inside && /^Function:/ { exit }
+        inside && $0 == "  L0:" { loop = 1 }
+        inside && loop { print }'
+}
+
+rows=$(in_loop checksum | grep -c "MUL")
+triples=$(in_loop triples | grep -c "MUL\|PHI")
+counters=$(in_loop lockstep | grep -c "PHI")
+echo "checksum loop MULs: $rows, triples MULs and phis: $triples, lockstep phis: $counters"
+
+# checksum keeps the pixel product, triples its total and scaled counter,
+# lockstep its total and one counter
+if [ "$rows" == "1" ] && [ "$triples" == "2" ] && [ "$counters" == "2" ] && ./tests/tmp/app; then
+    echo "✓ Multiplies by counters reduced"
+else
+    echo "✗ Expected the counter multiplies and redundant counters to go"
+    rm -rf tests/tmp
+    exit 1
+fi
+
+# Cleanup
+rm -rf tests/tmp
+echo "Test passed!"
@@ -0,0 +1,35 @@
+#!/bin/bash
+# tests/cli/test_licm.sh
+# licm must move the pure call in licm_nest.vx out of the whole nest and
+# the row offsets out of the inner loop, and leave the loop that assigns
+# g.w reading it afresh.
+
+mkdir -p tests/tmp
+
+echo "Testing licm placement..."
+ir=$(./virexc build tests/control_flow/licm_nest.vx -o tests/tmp/app --no-cache --inline-threshold=0 --print-after=licm)
+
+# Instructions of one function ahead of its first occurrence of a label
+before_label() {
+    echo "$ir" | awk -v fn="Function: licm_nest__$1" -v label="  $2:" '
+        $0 == fn { inside = 1; next }
+        inside && (/^Function:/ || $0 == label) { exit }
+        inside { print }'
+}
+
+outer=$(before_label fill L0 | grep -c "CALL licm_nest__scale")
+inner=$(before_label fill L4 | grep -c "MUL")
+shrink=$(before_label shrink L0 | grep -c "g_v")
+echo "call before outer loop: $outer, MULs before inner loop: $inner, g reads before shrink loop: $shrink"
+
+if [ "$outer" == "1" ] && [ "$inner" == "3" ] && [ "$shrink" == "0" ] && ./tests/tmp/app; then
+    echo "✓ Invariants hoisted to their outermost loop"
+else
+    echo "✗ Expected the call and the three row MULs to leave the inner loop"
+    rm -rf tests/tmp
+    exit 1
+fi
+
+# Cleanup
+rm -rf tests/tmp
+echo "Test passed!"
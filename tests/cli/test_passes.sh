@@ -0,0 +1,41 @@
+#!/bin/bash
+# tests/cli/test_passes.sh
+# --passes must reject unknown passes and unbalanced brackets, and
+# --print-after must dump the IR once per run of the pass, including every
+# round of a bracketed group.
+
+mkdir -p tests/tmp
+
+echo "Testing --passes..."
+if ./virexc build tests/control_flow/match_switch.vx -o tests/tmp/app --passes=sccp,nope 2>&1 | grep -q "Unknown pass 'nope'"; then
+    echo "✓ Unknown pass rejected"
+else
+    echo "✗ Expected 'nope' to be rejected"
+    rm -rf tests/tmp
+    exit 1
+fi
+
+if ./virexc build tests/control_flow/match_switch.vx -o tests/tmp/app "--passes=[sccp,dve" 2>&1 | grep -q "Missing ']'"; then
+    echo "✓ Unbalanced group rejected"
+else
+    echo "✗ Expected the open group to be rejected"
+    rm -rf tests/tmp
+    exit 1
+fi
+
+echo "Testing --print-after..."
+dumps=$(./virexc build tests/control_flow/match_switch.vx -o tests/tmp/app --passes=inline,dce --print-after=dce | grep -c "^\*\*\* IR after dce \*\*\*")
+rounds=$(./virexc build tests/control_flow/match_switch.vx -o tests/tmp/app "--passes=inline,[sccp,copyprop,dve]" --print-after=sccp | grep -c "^\*\*\* IR after sccp \*\*\*")
+echo "dce dumps: $dumps, sccp rounds: $rounds"
+
+if [ "$dumps" == "1" ] && [ "$rounds" -ge 2 ] && ./tests/tmp/app; then
+    echo "✓ IR printed after each run"
+else
+    echo "✗ Expected one dump for dce and a repeated sccp group"
+    rm -rf tests/tmp
+    exit 1
+fi
+
+# Cleanup
+rm -rf tests/tmp
+echo "Test passed!"
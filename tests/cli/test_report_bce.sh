@@ -0,0 +1,33 @@
+#!/bin/bash
+# tests/cli/test_report_bce.sh
+# --report-bce must list the bounds checks left in a function, and the
+# in-bounds loop over s.len must not leave any.
+
+mkdir -p tests/tmp
+
+echo "Testing --report-bce..."
+report=$(./virexc build tests/slices/bounds_loop_fail.vx -o tests/tmp/app --report-bce --inline-threshold=0 | grep -A1 "^bce: bounds_loop_fail__sum_through:")
+echo "$report"
+
+if echo "$report" | grep -q "0 of 1 checks removed" && echo "$report" | grep -q "virex_slice_bounds_check(i_v2, s_v0.len)"; then
+    echo "✓ Kept check reported"
+else
+    echo "✗ Expected the check in sum_through to be reported"
+    rm -rf tests/tmp
+    exit 1
+fi
+
+report=$(./virexc build tests/slices/bounds_elim.vx -o tests/tmp/app --report-bce --inline-threshold=0 | grep "^bce: bounds_elim__sum:")
+echo "$report"
+
+if [ "$report" == "bce: bounds_elim__sum: 1 of 1 checks removed" ]; then
+    echo "✓ Loop check removed"
+else
+    echo "✗ Expected the check in sum to be removed"
+    rm -rf tests/tmp
+    exit 1
+fi
+
+# Cleanup
+rm -rf tests/tmp
+echo "Test passed!"
@@ -0,0 +1,24 @@
+#!/bin/bash
+# tests/cli/test_single_lowering.sh
+# The C backend must lower each module to IR exactly once.
+
+mkdir -p tests/tmp
+
+echo "Testing IR lowerings per module..."
+stats=$(./virexc build tests/generics/multi_file.vx -o tests/tmp/app --stats --no-cache | grep "^Backend:")
+echo "  $stats"
+
+modules=$(echo "$stats" | sed -E 's/^Backend: ([0-9]+) modules.*/\1/')
+lowerings=$(echo "$stats" | sed -E 's/.* ([0-9]+) IR lowerings.*/\1/')
+
+if [ -n "$modules" ] && [ "$modules" -gt 1 ] && [ "$modules" == "$lowerings" ]; then
+    echo "✓ One lowering per module"
+else
+    echo "✗ Expected one lowering per module, got '$stats'"
+    rm -rf tests/tmp
+    exit 1
+fi
+
+# Cleanup
+rm -rf tests/tmp
+echo "Test passed!"